@@ -693,6 +693,56 @@ function TEST_ec_recovery_unfound() {
     delete_erasure_coded_pool $poolname
 }
 
+# Recover objects larger than osd_recovery_max_chunk from a clay pool
+# with osd_ec_recovery_read_ahead, so that the reads of the next extent
+# overlap the pushes of the current one, while one of the helpers
+# fails its reads
+function TEST_ec_clay_recovery_read_ahead_eio() {
+    local dir=$1
+    local objname=myobject
+
+    ORIG_ARGS=$CEPH_ARGS
+    CEPH_ARGS+='--osd-ec-recovery-read-ahead=true '
+    CEPH_ARGS+='--osd-recovery-max-chunk=65536 '
+    setup_osds 7 || return 1
+    CEPH_ARGS=$ORIG_ARGS
+
+    local poolname=pool-clay
+    ceph osd erasure-code-profile set myprofile \
+        plugin=clay \
+        k=4 m=2 \
+        crush-failure-domain=osd || return 1
+    create_pool $poolname 1 1 erasure myprofile \
+        || return 1
+    wait_for_clean || return 1
+
+    dd if=/dev/urandom of=$dir/ORIGINAL bs=1024 count=1024 || return 1
+    for i in $(seq 1 4)
+    do
+        rados --pool $poolname put ${objname}$i $dir/ORIGINAL || return 1
+    done
+    inject_eio ec data $poolname ${objname}1 $dir 1 || return 1
+    inject_eio ec data $poolname ${objname}3 $dir 2 || return 1
+
+    local -a initial_osds=($(get_osds $poolname ${objname}1))
+    local last_osd=${initial_osds[-1]}
+    # Kill OSD
+    kill_daemons $dir TERM osd.${last_osd} >&2 < /dev/null || return 1
+    ceph osd down ${last_osd} || return 1
+    ceph osd out ${last_osd} || return 1
+
+    # Cluster should recover these objects
+    wait_for_clean || return 1
+
+    for i in $(seq 1 4)
+    do
+        rados_get $dir $poolname ${objname}$i || return 1
+    done
+
+    rm -f $dir/ORIGINAL
+    delete_erasure_coded_pool $poolname
+}
+
 main test-erasure-eio "$@"
 
 # Local Variables:
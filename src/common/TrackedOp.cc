@@ -23,6 +23,7 @@ using std::ostream;
 using std::pair;
 using std::set;
 using std::string;
+using std::vector;
 using std::stringstream;
 
 using ceph::Formatter;
@@ -464,15 +465,90 @@ void OpTracker::get_age_ms_histogram(pow2_hist_t *h)
 #undef dout_context
 #define dout_context tracker->cct
 
-void TrackedOp::mark_event(std::string_view event, utime_t stamp)
+void TrackedOp::add_event(utime_t stamp, std::string_view event)
 {
-  if (!state)
-    return;
+  unsigned i = num_events.fetch_add(1, std::memory_order_relaxed);
+  if (i < event_records.size() && event.size() < OPTRACKER_EVENT_LEN) {
+    EventRecord& r = event_records[i];
+    r.stamp = stamp;
+    memcpy(r.str, event.data(), event.size());
+    r.str[event.size()] = '\0';
+    r.ready.store(true, std::memory_order_release);
+  } else {
+    std::lock_guard l(lock);
+    spilled_events.emplace_back(i, Event(stamp, event));
+  }
+}
+
+bool TrackedOp::get_event(unsigned i, utime_t *stamp,
+			  std::string_view *str) const
+{
+  if (i < event_records.size() &&
+      event_records[i].ready.load(std::memory_order_acquire)) {
+    if (stamp)
+      *stamp = event_records[i].stamp;
+    *str = event_records[i].str;
+    return true;
+  }
+  std::lock_guard l(lock);
+  for (auto& [j, e] : spilled_events) {
+    if (j == i) {
+      if (stamp)
+	*stamp = e.stamp;
+      *str = e.str;
+      return true;
+    }
+  }
+  return false;
+}
 
+vector<TrackedOp::Event> TrackedOp::get_events() const
+{
+  vector<Event> evs;
+  unsigned n = std::min<unsigned>(num_events, event_records.size());
+  vector<pair<unsigned, Event>> spilled;
   {
     std::lock_guard l(lock);
-    events.emplace_back(stamp, event);
+    spilled = spilled_events;
+  }
+  // racing writers may have appended out of slot order
+  std::sort(spilled.begin(), spilled.end(),
+	    [](auto& a, auto& b) { return a.first < b.first; });
+  evs.reserve(n + spilled.size());
+  auto sp = spilled.begin();
+  for (unsigned i = 0; i < n; ++i) {
+    if (event_records[i].ready.load(std::memory_order_acquire)) {
+      evs.emplace_back(event_records[i].stamp, event_records[i].str);
+    } else if (sp != spilled.end() && sp->first == i) {
+      // too long for a record
+      evs.push_back(std::move(sp->second));
+      ++sp;
+    }
+    // else still being written; leave it for the next dump
+  }
+  for (; sp != spilled.end(); ++sp) {
+    evs.push_back(std::move(sp->second));
   }
+  return evs;
+}
+
+double TrackedOp::get_duration() const
+{
+  unsigned n = num_events;
+  utime_t stamp;
+  std::string_view str;
+  if (n && get_event(n - 1, &stamp, &str) && str == "done")
+    return stamp - get_initiated();
+  else
+    return ceph_clock_now() - get_initiated();
+}
+
+void TrackedOp::mark_event(std::string_view event, utime_t stamp)
+{
+  if (!state)
+    return;
+
+  add_event(stamp, event);
   dout(6) << " seq: " << seq
 	  << ", time: " << stamp
 	  << ", event: " << event
@@ -14,6 +14,7 @@
 #ifndef TRACKEDREQUEST_H_
 #define TRACKEDREQUEST_H_
 
+#include <array>
 #include <atomic>
 #include "common/ceph_mutex.h"
 #include "common/histogram.h"
@@ -23,6 +24,7 @@
 #include "msg/Message.h"
 
 #define OPTRACKER_PREALLOC_EVENTS 20
+#define OPTRACKER_EVENT_LEN 32
 
 class TrackedOp;
 class OpHistory;
@@ -246,8 +248,33 @@ protected:
     }
   };
 
-  std::vector<Event> events;    ///< std::list of events and their times
-  mutable ceph::mutex lock = ceph::make_mutex("TrackedOp::lock"); ///< to protect the events list
+private:
+  /*
+   * Events are recorded without locking or allocating: a writer takes
+   * the next slot with an atomic increment and copies the event name into
+   * that slot's fixed-size record, publishing it with the ready flag.
+   * Nothing is formatted until the events are dumped.  Events beyond the
+   * preallocated slots, or too long for a record, go to spilled_events
+   * under lock.
+   */
+  struct EventRecord {
+    utime_t stamp;
+    std::atomic<bool> ready = {false};
+    char str[OPTRACKER_EVENT_LEN];
+  };
+  std::array<EventRecord, OPTRACKER_PREALLOC_EVENTS> event_records;
+  std::atomic<unsigned> num_events = {0};
+  std::vector<std::pair<unsigned, Event>> spilled_events; ///< protected by lock
+
+  void add_event(utime_t stamp, std::string_view event);
+  /// event @i, if it has been recorded yet
+  bool get_event(unsigned i, utime_t *stamp, std::string_view *str) const;
+
+protected:
+  /// a copy of the events recorded so far, in the order they were marked
+  std::vector<Event> get_events() const;
+
+  mutable ceph::mutex lock = ceph::make_mutex("TrackedOp::lock"); ///< to protect spilled_events and desc_str
   uint64_t seq = 0;        ///< a unique value std::set by the OpTracker
 
   uint32_t warn_interval_multiplier = 1; //< limits output of a given op warning
@@ -266,9 +293,7 @@ protected:
   TrackedOp(OpTracker *_tracker, const utime_t& initiated) :
     tracker(_tracker),
     initiated_at(initiated)
-  {
-    events.reserve(OPTRACKER_PREALLOC_EVENTS);
-  }
+  {}
 
   /// output any type-specific data you want to get when dump() is called
   virtual void _dump(ceph::Formatter *f) const {}
@@ -351,13 +376,7 @@ public:
     return initiated_at;
   }
 
-  double get_duration() const {
-    std::lock_guard l(lock);
-    if (!events.empty() && events.rbegin()->compare("done") == 0)
-      return events.rbegin()->stamp - get_initiated();
-    else
-      return ceph_clock_now() - get_initiated();
-  }
+  double get_duration() const;
 
   void mark_event(std::string_view event, utime_t stamp=ceph_clock_now());
 
@@ -366,15 +385,19 @@ public:
   }
 
   virtual std::string_view state_string() const {
-    std::lock_guard l(lock);
-    return events.empty() ? std::string_view() : std::string_view(events.rbegin()->str);
+    unsigned n = num_events;
+    std::string_view str;
+    if (n) {
+      get_event(n - 1, nullptr, &str);
+    }
+    return str;
   }
 
   void dump(utime_t now, ceph::Formatter *f) const;
 
   void tracking_start() {
     if (tracker->register_inflight_op(this)) {
-      events.emplace_back(initiated_at, "initiated");
+      add_event(initiated_at, "initiated");
       state = STATE_LIVE;
     }
   }
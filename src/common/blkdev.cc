@@ -422,6 +422,41 @@ bool get_vdo_utilization(int fd, uint64_t *total, uint64_t *avail)
   return true;
 }
 
+int _parse_device_io_ticks(const std::string& stat, uint64_t *ms)
+{
+  // see Documentation/block/stat.rst for the layout of 'stat'
+  unsigned long long f[10];
+  if (sscanf(stat.c_str(), "%llu %llu %llu %llu %llu %llu %llu %llu %llu %llu",
+	     &f[0], &f[1], &f[2], &f[3], &f[4], &f[5], &f[6], &f[7], &f[8],
+	     &f[9]) != 10) {
+    return -EINVAL;
+  }
+  *ms = f[9];  // io_ticks
+  return 0;
+}
+
+int get_device_io_ticks(const std::string& devname, uint64_t *ms,
+			const char *sysfsdir)
+{
+  // <sysfs>/class/block covers partitions as well as whole disks
+  std::string fn = std::string(sysfsdir) + "/class/block/" + devname + "/stat";
+  int fd = ::open(fn.c_str(), O_RDONLY|O_CLOEXEC);
+  if (fd < 0) {
+    return -errno;
+  }
+  char buf[512];
+  int r = ::read(fd, buf, sizeof(buf) - 1);
+  if (r < 0) {
+    r = -errno;
+  }
+  TEMP_FAILURE_RETRY(::close(fd));
+  if (r < 0) {
+    return r;
+  }
+  buf[r] = 0;
+  return _parse_device_io_ticks(buf, ms);
+}
+
 std::string _decode_model_enc(const std::string& in)
 {
   auto v = boost::replace_all_copy(in, "\\x20", " ");
@@ -913,6 +948,17 @@ bool get_vdo_utilization(int fd, uint64_t *total, uint64_t *avail)
   return false;
 }
 
+int _parse_device_io_ticks(const std::string& stat, uint64_t *ms)
+{
+  return -EOPNOTSUPP;
+}
+
+int get_device_io_ticks(const std::string& devname, uint64_t *ms,
+			const char *sysfsdir)
+{
+  return -EOPNOTSUPP;
+}
+
 std::string get_device_id(const std::string& devname,
 			  std::string *err)
 {
@@ -1083,6 +1129,17 @@ bool get_vdo_utilization(int fd, uint64_t *total, uint64_t *avail)
   return false;
 }
 
+int _parse_device_io_ticks(const std::string& stat, uint64_t *ms)
+{
+  return -EOPNOTSUPP;
+}
+
+int get_device_io_ticks(const std::string& devname, uint64_t *ms,
+			const char *sysfsdir)
+{
+  return -EOPNOTSUPP;
+}
+
 std::string get_device_id(const std::string& devname,
 			  std::string *err)
 {
@@ -1237,6 +1294,17 @@ bool get_vdo_utilization(int fd, uint64_t *total, uint64_t *avail)
   return false;
 }
 
+int _parse_device_io_ticks(const std::string& stat, uint64_t *ms)
+{
+  return -EOPNOTSUPP;
+}
+
+int get_device_io_ticks(const std::string& devname, uint64_t *ms,
+			const char *sysfsdir)
+{
+  return -EOPNOTSUPP;
+}
+
 std::string get_device_id(const std::string& devname,
 			  std::string *err)
 {
@@ -19,26 +19,26 @@
 		c = c - a;  c = c - b;  c = c ^ (b >> 15);	\
 	} while (0)
 
-unsigned ceph_str_hash_rjenkins(const char *str, unsigned length)
-{
-	const unsigned char *k = (const unsigned char *)str;
-	__u32 a, b, c;  /* the internal state */
-	__u32 len;      /* how many key bytes still need mixing */
+#define RJENKINS_INIT  0x9e3779b9  /* the golden ratio; an arbitrary value */
 
-	/* Set up the internal state */
-	len = length;
-	a = 0x9e3779b9;      /* the golden ratio; an arbitrary value */
-	b = a;
-	c = 0;               /* variable initialization of internal state */
+static inline __u32 rjenkins_word(const unsigned char *k)
+{
+	return k[0] + ((__u32)k[1] << 8) + ((__u32)k[2] << 16) +
+		((__u32)k[3] << 24);
+}
 
+/*
+ * hash what is left of a key, k[0..len), given the state after its
+ * first length - len bytes
+ */
+static unsigned rjenkins_finish(const unsigned char *k, __u32 len,
+				__u32 length, __u32 a, __u32 b, __u32 c)
+{
 	/* handle most of the key */
 	while (len >= 12) {
-		a = a + (k[0] + ((__u32)k[1] << 8) + ((__u32)k[2] << 16) +
-			 ((__u32)k[3] << 24));
-		b = b + (k[4] + ((__u32)k[5] << 8) + ((__u32)k[6] << 16) +
-			 ((__u32)k[7] << 24));
-		c = c + (k[8] + ((__u32)k[9] << 8) + ((__u32)k[10] << 16) +
-			 ((__u32)k[11] << 24));
+		a = a + rjenkins_word(k);
+		b = b + rjenkins_word(k + 4);
+		c = c + rjenkins_word(k + 8);
 		mix(a, b, c);
 		k = k + 12;
 		len = len - 12;
@@ -77,6 +77,56 @@ unsigned ceph_str_hash_rjenkins(const char *str, unsigned length)
 	return c;
 }
 
+unsigned ceph_str_hash_rjenkins(const char *str, unsigned length)
+{
+	/* Set up the internal state */
+	return rjenkins_finish((const unsigned char *)str, length, length,
+			       RJENKINS_INIT, RJENKINS_INIT, 0);
+}
+
+/*
+ * Hash keys RJENKINS_LANES at a time.  The lanes consume their 12-byte
+ * blocks in lock-step for as long as every key in the group has one, so
+ * the compiler can mix the independent states with vector instructions;
+ * each key's remaining blocks and tail are then finished on their own.
+ */
+#define RJENKINS_LANES 8
+
+static void ceph_str_hash_rjenkins_multi(const char * const *strs,
+					 const unsigned *lens, unsigned n,
+					 unsigned *hashes)
+{
+	unsigned i = 0;
+	for (; i + RJENKINS_LANES <= n; i += RJENKINS_LANES) {
+		__u32 a[RJENKINS_LANES], b[RJENKINS_LANES], c[RJENKINS_LANES];
+		unsigned blocks = lens[i] / 12;
+		for (int l = 0; l < RJENKINS_LANES; l++) {
+			a[l] = b[l] = RJENKINS_INIT;
+			c[l] = 0;
+			if (lens[i + l] / 12 < blocks)
+				blocks = lens[i + l] / 12;
+		}
+		for (unsigned off = 0; off < blocks * 12; off += 12) {
+			for (int l = 0; l < RJENKINS_LANES; l++) {
+				const unsigned char *k =
+					(const unsigned char *)strs[i + l] + off;
+				a[l] += rjenkins_word(k);
+				b[l] += rjenkins_word(k + 4);
+				c[l] += rjenkins_word(k + 8);
+			}
+			for (int l = 0; l < RJENKINS_LANES; l++)
+				mix(a[l], b[l], c[l]);
+		}
+		for (int l = 0; l < RJENKINS_LANES; l++)
+			hashes[i + l] = rjenkins_finish(
+				(const unsigned char *)strs[i + l] + blocks * 12,
+				lens[i + l] - blocks * 12, lens[i + l],
+				a[l], b[l], c[l]);
+	}
+	for (; i < n; i++)
+		hashes[i] = ceph_str_hash_rjenkins(strs[i], lens[i]);
+}
+
 /*
  * linux dcache hash
  */
@@ -104,6 +154,19 @@ unsigned ceph_str_hash(int type, const char *s, unsigned len)
 	}
 }
 
+void ceph_str_hash_multi(int type, const char * const *strs,
+			 const unsigned *lens, unsigned n, unsigned *hashes)
+{
+	switch (type) {
+	case CEPH_STR_HASH_RJENKINS:
+		ceph_str_hash_rjenkins_multi(strs, lens, n, hashes);
+		break;
+	default:
+		for (unsigned i = 0; i < n; i++)
+			hashes[i] = ceph_str_hash(type, strs[i], lens[i]);
+	}
+}
+
 const char *ceph_str_hash_name(int type)
 {
 	switch (type) {
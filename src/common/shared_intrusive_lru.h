@@ -0,0 +1,305 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <boost/container/small_vector.hpp>
+#include <boost/intrusive/list.hpp>
+#include <boost/intrusive/set.hpp>
+#include "common/ceph_mutex.h"
+#include "common/ceph_context.h"
+#include "common/dout.h"
+
+/**
+ * SharedIntrusiveLRU: a thread-safe SharedLRU with embedded hooks
+ *
+ * Behaves like SharedLRU<K, V> (common/shared_cache.hpp): values are
+ * handed out as std::shared_ptr<V>, the most recently used max_size
+ * values are kept alive by the cache, and any value that is still
+ * referenced elsewhere can be found again.  Unlike SharedLRU, the index
+ * and lru hooks live in the value itself (V must derive from
+ * SharedIntrusiveLRUItem<K, V>), values are created with a single
+ * make_shared, and the cache is split into independently locked shards
+ * by key hash.  A lookup hit does not allocate.
+ */
+
+template <class K, class V>
+class SharedIntrusiveLRU;
+
+template <class K, class V>
+class SharedIntrusiveLRUItem : public std::enable_shared_from_this<V> {
+  friend class SharedIntrusiveLRU<K, V>;
+
+  boost::intrusive::set_member_hook<> set_hook;
+  boost::intrusive::list_member_hook<> lru_hook;
+  K lru_key;
+  std::shared_ptr<V> lru_ref;   ///< held while on the cache's lru
+  SharedIntrusiveLRU<K, V> *lru_cache = nullptr; ///< null if not indexed
+
+protected:
+  ~SharedIntrusiveLRUItem() {
+    if (lru_cache) {
+      lru_cache->remove(this);
+    }
+  }
+};
+
+template <class K, class V>
+class SharedIntrusiveLRU {
+  using VPtr = std::shared_ptr<V>;
+  using item_t = SharedIntrusiveLRUItem<K, V>;
+  friend item_t;
+  using release_t = boost::container::small_vector<VPtr, 4>;
+
+  struct key_of_item {
+    using type = K;
+    const K& operator()(const item_t& i) const {
+      return i.lru_key;
+    }
+  };
+  using set_t = boost::intrusive::set<
+    item_t,
+    boost::intrusive::member_hook<
+      item_t, boost::intrusive::set_member_hook<>, &item_t::set_hook>,
+    boost::intrusive::key_of_value<key_of_item>>;
+  using list_t = boost::intrusive::list<
+    item_t,
+    boost::intrusive::member_hook<
+      item_t, boost::intrusive::list_member_hook<>, &item_t::lru_hook>>;
+
+  struct Shard {
+    ceph::mutex lock = ceph::make_mutex("SharedIntrusiveLRU::Shard::lock");
+    ceph::condition_variable cond;
+    size_t max_size = 0;
+    set_t refs;   ///< every live value, referenced or not
+    list_t lru;   ///< values pinned by the cache, most recent first
+
+    void lru_remove(item_t& i, release_t *to_release) {
+      lru.erase(lru.iterator_to(i));
+      to_release->push_back(std::move(i.lru_ref));
+    }
+
+    void lru_add(item_t& i, const VPtr& val, release_t *to_release) {
+      if (i.lru_hook.is_linked()) {
+	lru.splice(lru.begin(), lru, lru.iterator_to(i));
+	return;
+      }
+      i.lru_ref = val;
+      lru.push_front(i);
+      trim(to_release);
+    }
+
+    void trim(release_t *to_release) {
+      while (lru.size() > max_size) {
+	lru_remove(lru.back(), to_release);
+      }
+    }
+
+    /// return a strong ref for key if it is alive, waiting out any
+    /// value for key that is being destroyed
+    template <class Lock>
+    VPtr find(Lock& l, const K& key) {
+      VPtr val;
+      cond.wait(l, [this, &key, &val] {
+	auto i = refs.find(key);
+	if (i == refs.end()) {
+	  return true;
+	}
+	val = i->weak_from_this().lock();
+	return bool(val);
+      });
+      return val;
+    }
+  };
+
+  CephContext *cct;
+  const size_t num_shards;
+  std::unique_ptr<Shard[]> shards;
+
+  Shard& get_shard(const K& key) {
+    return shards[std::hash<K>()(key) % num_shards];
+  }
+
+  size_t shard_max_size(size_t max_size) const {
+    return (max_size + num_shards - 1) / num_shards;
+  }
+
+  /// called as the last reference to i goes away
+  void remove(item_t *i) {
+    auto& shard = get_shard(i->lru_key);
+    std::lock_guard l{shard.lock};
+    shard.refs.erase(shard.refs.iterator_to(*i));
+    i->lru_cache = nullptr;
+    shard.cond.notify_all();
+  }
+
+public:
+  SharedIntrusiveLRU(CephContext *cct, size_t max_size, size_t num_shards = 1)
+    : cct(cct),
+      num_shards(std::max<size_t>(num_shards, 1)),
+      shards(new Shard[this->num_shards]) {
+    set_size(max_size);
+  }
+
+  ~SharedIntrusiveLRU() {
+    clear();
+    bool leaked = false;
+    for (size_t s = 0; s < num_shards; ++s) {
+      std::lock_guard l{shards[s].lock};
+      if (shards[s].refs.empty()) {
+	continue;
+      }
+      if (!leaked) {
+	lderr(cct) << "leaked refs:\n";
+	dump_weak_refs(*_dout);
+	*_dout << dendl;
+	leaked = true;
+      }
+      // don't let the survivors call back into a dead cache
+      shards[s].refs.clear_and_dispose([](item_t *i) {
+	i->lru_cache = nullptr;
+      });
+    }
+    if (leaked && cct->_conf.get_val<bool>("debug_asserts_on_shutdown")) {
+      ceph_abort_msg("SharedIntrusiveLRU leaked refs");
+    }
+  }
+
+  int get_count() {
+    int count = 0;
+    for (size_t s = 0; s < num_shards; ++s) {
+      std::lock_guard l{shards[s].lock};
+      count += shards[s].lru.size();
+    }
+    return count;
+  }
+
+  void dump_weak_refs(std::ostream& out) {
+    for (size_t s = 0; s < num_shards; ++s) {
+      for (auto& i : shards[s].refs) {
+	out << __func__ << " " << this << " weak_refs: "
+	    << i.lru_key << " = " << static_cast<const V*>(&i)
+	    << " with " << i.weak_from_this().use_count() << " refs"
+	    << std::endl;
+      }
+    }
+  }
+
+  /// drop every strong reference held by the cache
+  void clear() {
+    for (size_t s = 0; s < num_shards; ++s) {
+      release_t to_release; // release refs after we drop the lock
+      std::lock_guard l{shards[s].lock};
+      while (!shards[s].lru.empty()) {
+	shards[s].lru_remove(shards[s].lru.back(), &to_release);
+      }
+    }
+  }
+
+  /// drop the cache's references in [from, to] -- to is inclusive
+  void clear_range(const K& from, const K& to) {
+    for (size_t s = 0; s < num_shards; ++s) {
+      release_t to_release;
+      std::lock_guard l{shards[s].lock};
+      auto& shard = shards[s];
+      for (auto i = shard.refs.lower_bound(from);
+	   i != shard.refs.end() && !(to < i->lru_key);
+	   ++i) {
+	if (i->lru_hook.is_linked()) {
+	  shard.lru_remove(*i, &to_release);
+	}
+      }
+    }
+  }
+
+  void set_size(size_t new_size) {
+    for (size_t s = 0; s < num_shards; ++s) {
+      release_t to_release;
+      std::lock_guard l{shards[s].lock};
+      shards[s].max_size = shard_max_size(new_size);
+      shards[s].trim(&to_release);
+    }
+  }
+
+  /**
+   * get_next
+   *
+   * Find the live value with the smallest key greater than key.
+   */
+  bool get_next(const K& key, std::pair<K, VPtr> *next) {
+    std::pair<K, VPtr> r;
+    for (size_t s = 0; s < num_shards; ++s) {
+      VPtr prev; // may be the last ref; drop it after we drop the lock
+      std::lock_guard l{shards[s].lock};
+      auto& refs = shards[s].refs;
+      for (auto i = refs.upper_bound(key); i != refs.end(); ++i) {
+	if (r.second && !(i->lru_key < r.first)) {
+	  break;
+	}
+	if (auto val = i->weak_from_this().lock(); val) {
+	  prev = std::move(r.second);
+	  r = std::make_pair(i->lru_key, std::move(val));
+	  break;
+	}
+      }
+    }
+    if (!r.second) {
+      return false;
+    }
+    if (next) {
+      *next = std::move(r);
+    }
+    return true;
+  }
+
+  VPtr lookup(const K& key) {
+    VPtr val;
+    release_t to_release;
+    auto& shard = get_shard(key);
+    {
+      std::unique_lock l{shard.lock};
+      val = shard.find(l, key);
+      if (val) {
+	shard.lru_add(*val, val, &to_release);
+      }
+    }
+    return val;
+  }
+
+  VPtr lookup_or_create(const K& key) {
+    VPtr val;
+    release_t to_release;
+    auto& shard = get_shard(key);
+    {
+      std::unique_lock l{shard.lock};
+      val = shard.find(l, key);
+      if (!val) {
+	val = std::make_shared<V>();
+	item_t& i = *val;
+	i.lru_key = key;
+	i.lru_cache = this;
+	shard.refs.insert(i);
+      }
+      shard.lru_add(*val, val, &to_release);
+    }
+    return val;
+  }
+
+  /**
+   * empty()
+   *
+   * Returns true iff there are no live references left to anything that has been
+   * in the cache.
+   */
+  bool empty() {
+    for (size_t s = 0; s < num_shards; ++s) {
+      std::lock_guard l{shards[s].lock};
+      if (!shards[s].refs.empty()) {
+	return false;
+      }
+    }
+    return true;
+  }
+};
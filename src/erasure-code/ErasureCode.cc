@@ -58,6 +58,10 @@ int ErasureCode::init(
   if (err)
     return err;
   _profile = profile;
+  profile_signature.clear();
+  for (const auto &[name, value] : _profile) {
+    profile_signature += name + "=" + value + " ";
+  }
   return 0;
 }
 
@@ -159,6 +163,10 @@ int ErasureCode::encode_prepare(const bufferlist &raw,
   for (unsigned int i = 0; i < k - padded_chunks; i++) {
     bufferlist &chunk = encoded[chunk_index(i)];
     chunk.substr_of(prepared, i * blocksize, blocksize);
+    // buffers received from the messenger are usually aligned already:
+    // encode them where they are if the plugin can
+    if (!chunk.is_contiguous() && can_segment(chunk))
+      continue;
     chunk.rebuild_aligned_size_and_memory(blocksize, SIMD_ALIGN);
     ceph_assert(chunk.is_contiguous());
   }
@@ -225,6 +233,9 @@ int ErasureCode::_decode(const set<int> &want_to_read,
   unsigned int k = get_data_chunk_count();
   unsigned int m = get_chunk_count() - k;
   unsigned blocksize = (*chunks.begin()).second.length();
+  bool segmented = std::all_of(
+    chunks.begin(), chunks.end(),
+    [this](const auto &p) { return can_segment(p.second); });
   for (unsigned int i =  0; i < k + m; i++) {
     if (chunks.find(i) == chunks.end()) {
       bufferlist tmp;
@@ -234,12 +245,111 @@ int ErasureCode::_decode(const set<int> &want_to_read,
       (*decoded)[i].swap(tmp);
     } else {
       (*decoded)[i] = chunks.find(i)->second;
-      (*decoded)[i].rebuild_aligned(SIMD_ALIGN);
+      if (!segmented)
+	(*decoded)[i].rebuild_aligned(SIMD_ALIGN);
     }
   }
   return decode_chunks(want_to_read, chunks, decoded);
 }
 
+int ErasureCode::encode_segment(char **data, char **coding, unsigned len)
+{
+  return -EOPNOTSUPP;
+}
+
+int ErasureCode::decode_segment(int *erasures, char **data, char **coding,
+				unsigned len)
+{
+  return -EOPNOTSUPP;
+}
+
+bool ErasureCode::can_segment(const bufferlist &chunk) const
+{
+  unsigned alignment = get_segment_alignment();
+  if (!alignment || chunk.length() % alignment)
+    return false;
+  for (const auto &p : chunk.buffers()) {
+    if (p.length() % alignment ||
+	reinterpret_cast<uintptr_t>(p.c_str()) % SIMD_ALIGN)
+      return false;
+  }
+  return true;
+}
+
+bool ErasureCode::is_segmented(const map<int, bufferlist> &chunks) const
+{
+  bool contiguous = true;
+  for (const auto &p : chunks) {
+    if (!can_segment(p.second))
+      return false;
+    contiguous &= p.second.is_contiguous();
+  }
+  return !contiguous;
+}
+
+/*
+ * Call f(ptrs, len) for each run of bytes over which none of the
+ * chunks crosses from one buffer to the next, with ptrs[i] pointing to
+ * where the run starts in chunks[i].
+ */
+template <typename F>
+static void for_each_segment(const vector<bufferlist*> &chunks, F &&f)
+{
+  unsigned n = chunks.size();
+  unsigned length = chunks[0]->length();
+  vector<bufferlist::buffers_t::const_iterator> bufs;
+  vector<unsigned> offsets(n, 0);
+  vector<char*> ptrs(n);
+  for (auto chunk : chunks) {
+    ceph_assert(chunk->length() == length);
+    bufs.push_back(chunk->buffers().begin());
+  }
+  for (unsigned pos = 0; pos < length; ) {
+    unsigned len = length - pos;
+    for (unsigned i = 0; i < n; i++) {
+      while (offsets[i] == bufs[i]->length()) {
+	++bufs[i];
+	offsets[i] = 0;
+      }
+      len = std::min(len, bufs[i]->length() - offsets[i]);
+      ptrs[i] = const_cast<char*>(bufs[i]->c_str()) + offsets[i];
+    }
+    f(ptrs.data(), len);
+    for (unsigned i = 0; i < n; i++)
+      offsets[i] += len;
+    pos += len;
+  }
+}
+
+int ErasureCode::encode_segments(map<int, bufferlist> *encoded)
+{
+  unsigned int k = get_data_chunk_count();
+  vector<bufferlist*> chunks;
+  for (unsigned int i = 0; i < get_chunk_count(); i++)
+    chunks.push_back(&(*encoded)[i]);
+  int r = 0;
+  for_each_segment(chunks, [&](char **ptrs, unsigned len) {
+    if (r == 0)
+      r = encode_segment(ptrs, ptrs + k, len);
+  });
+  return r;
+}
+
+int ErasureCode::decode_segments(int *erasures,
+				 map<int, bufferlist> *decoded)
+{
+  unsigned int k = get_data_chunk_count();
+  vector<bufferlist*> chunks;
+  for (unsigned int i = 0; i < get_chunk_count(); i++)
+    chunks.push_back(&(*decoded)[i]);
+  int r = 0;
+  for_each_segment(chunks, [&](char **ptrs, unsigned len) {
+    if (r == 0)
+      r = decode_segment(erasures, ptrs, ptrs + k, len);
+  });
+  return r;
+}
+
 int ErasureCode::decode(const set<int> &want_to_read,
                         const map<int, bufferlist> &chunks,
                         map<int, bufferlist> *decoded, int chunk_size)
@@ -328,6 +438,156 @@ int ErasureCode::to_string(const std::string &name,
   return 0;
 }
 
+int ErasureCode::encode_delta(const bufferlist &old_data,
+                              const bufferlist &new_data,
+                              bufferlist *delta)
+{
+  // every code we ship is linear over GF(2^w), where the difference
+  // between two chunks is their xor
+  unsigned len = old_data.length();
+  if (new_data.length() != len)
+    return -EINVAL;
+  bufferptr buf(buffer::create_aligned(len, SIMD_ALIGN));
+  old_data.begin().copy(len, buf.c_str());
+  bufferlist in = new_data;
+  const char *src = in.c_str();
+  char *dst = buf.c_str();
+  for (unsigned i = 0; i < len; i++) {
+    dst[i] ^= src[i];
+  }
+  delta->clear();
+  delta->push_back(std::move(buf));
+  return 0;
+}
+
+int ErasureCode::apply_delta(int data_chunk,
+                             const bufferlist &delta,
+                             map<int, bufferlist> *coding)
+{
+  return -EOPNOTSUPP;
+}
+
+bool ErasureCode::can_batch_stripes(unsigned chunk_size) const
+{
+  // the plugins that work on segments code every byte, or every
+  // packet, independently of the others: encoding or decoding the
+  // concatenation of the chunks of several stripes is the same as
+  // doing it stripe by stripe
+  unsigned alignment = get_segment_alignment();
+  return alignment && chunk_size % alignment == 0;
+}
+
+string ErasureCode::decode_signature(const char *plan,
+				    const set<int> &erasures) const
+{
+  string signature = profile_signature + plan;
+  for (int i : erasures) {
+    signature += " " + std::to_string(i);
+  }
+  return signature;
+}
+
+int ErasureCode::encode_stripes(const set<int> &want_to_encode,
+				const bufferlist &in,
+				unsigned chunk_size,
+				map<int, bufferlist> *encoded)
+{
+  unsigned int k = get_data_chunk_count();
+  unsigned int n = get_chunk_count();
+  unsigned stripe_width = k * chunk_size;
+  if (chunk_size == 0 || in.length() % stripe_width ||
+      get_chunk_size(stripe_width) != chunk_size)
+    return -EINVAL;
+  unsigned stripes = in.length() / stripe_width;
+  if (stripes == 0)
+    return 0;
+
+  if (!can_batch_stripes(chunk_size)) {
+    for (unsigned s = 0; s < stripes; s++) {
+      bufferlist stripe;
+      stripe.substr_of(in, s * stripe_width, stripe_width);
+      map<int, bufferlist> chunks;
+      int r = encode(want_to_encode, stripe, &chunks);
+      if (r)
+	return r;
+      for (auto &[i, chunk] : chunks)
+	(*encoded)[i].claim_append(chunk);
+    }
+    return 0;
+  }
+
+  // line the data chunks of every stripe up, without copying them when
+  // they are suitably aligned, and encode them all in one go
+  map<int, bufferlist> chunks;
+  for (unsigned s = 0; s < stripes; s++) {
+    for (unsigned int i = 0; i < k; i++) {
+      bufferlist chunk;
+      chunk.substr_of(in, s * stripe_width + i * chunk_size, chunk_size);
+      chunks[chunk_index(i)].claim_append(chunk);
+    }
+  }
+  for (unsigned int i = 0; i < k; i++) {
+    bufferlist &chunk = chunks[chunk_index(i)];
+    if (!can_segment(chunk))
+      chunk.rebuild_aligned_size_and_memory(stripes * chunk_size, SIMD_ALIGN);
+  }
+  for (unsigned int i = k; i < n; i++) {
+    chunks[chunk_index(i)].push_back(
+      buffer::create_aligned(stripes * chunk_size, SIMD_ALIGN));
+  }
+  int r = encode_chunks(want_to_encode, &chunks);
+  if (r)
+    return r;
+  for (auto &[i, chunk] : chunks) {
+    if (want_to_encode.count(i))
+      (*encoded)[i].claim_append(chunk);
+  }
+  return 0;
+}
+
+int ErasureCode::decode_stripes(const set<int> &want_to_read,
+				const map<int, bufferlist> &chunks,
+				unsigned chunk_size,
+				map<int, bufferlist> *decoded)
+{
+  if (chunks.empty())
+    return -EINVAL;
+  unsigned int k = get_data_chunk_count();
+  unsigned length = chunks.begin()->second.length();
+  if (chunk_size == 0 || length % chunk_size ||
+      get_chunk_size(k * chunk_size) != chunk_size)
+    return -EINVAL;
+  for (auto &p : chunks) {
+    if (p.second.length() != length)
+      return -EINVAL;
+  }
+  if (length == 0)
+    return 0;
+
+  if (can_batch_stripes(chunk_size)) {
+    map<int, bufferlist> out;
+    int r = decode(want_to_read, chunks, &out, length);
+    if (r)
+      return r;
+    for (int i : want_to_read)
+      (*decoded)[i].claim_append(out[i]);
+    return 0;
+  }
+
+  for (unsigned off = 0; off < length; off += chunk_size) {
+    map<int, bufferlist> stripe;
+    for (auto &[i, chunk] : chunks)
+      stripe[i].substr_of(chunk, off, chunk_size);
+    map<int, bufferlist> out;
+    int r = decode(want_to_read, stripe, &out, chunk_size);
+    if (r)
+      return r;
+    for (int i : want_to_read)
+      (*decoded)[i].claim_append(out[i]);
+  }
+  return 0;
+}
+
 int ErasureCode::decode_concat(const map<int, bufferlist> &chunks,
 			       bufferlist *decoded)
 {
@@ -75,6 +75,32 @@ namespace ceph {
     int encode_prepare(const bufferlist &raw,
                        std::map<int, bufferlist> &encoded) const;
 
+    /**
+     * Return the granularity, in bytes, at which encode_segment() and
+     * decode_segment() can work on part of a chunk, or 0 if the plugin
+     * needs every chunk in a single buffer. When it is not 0, a chunk
+     * made of SIMD_ALIGN'ed buffers whose lengths are multiples of it is
+     * handed to encode_chunks() and decode_chunks() as is, instead of
+     * being copied into a single buffer first.
+     */
+    virtual unsigned get_segment_alignment() const {
+      return 0;
+    }
+
+    /**
+     * Same as encode_chunks() for **len** bytes starting at **data**
+     * and **coding**, which point to k and m buffers respectively.
+     */
+    virtual int encode_segment(char **data, char **coding, unsigned len);
+
+    /**
+     * Same as decode_chunks() for **len** bytes starting at **data**
+     * and **coding**. **erasures** lists the missing chunks and ends
+     * with -1.
+     */
+    virtual int decode_segment(int *erasures, char **data, char **coding,
+                               unsigned len);
+
     int encode(const std::set<int> &want_to_encode,
                        const bufferlist &in,
                        std::map<int, bufferlist> *encoded) override;
@@ -113,12 +139,50 @@ namespace ceph {
     int decode_concat(const std::map<int, bufferlist> &chunks,
 			      bufferlist *decoded) override;
 
+    uint64_t get_supported_optimizations() const override {
+      return 0;
+    }
+
+    int encode_delta(const bufferlist &old_data,
+                     const bufferlist &new_data,
+                     bufferlist *delta) override;
+
+    int apply_delta(int data_chunk,
+                    const bufferlist &delta,
+                    std::map<int, bufferlist> *coding) override;
+
+    int encode_stripes(const std::set<int> &want_to_encode,
+                       const bufferlist &in,
+                       unsigned chunk_size,
+                       std::map<int, bufferlist> *encoded) override;
+
+    int decode_stripes(const std::set<int> &want_to_read,
+                       const std::map<int, bufferlist> &chunks,
+                       unsigned chunk_size,
+                       std::map<int, bufferlist> *decoded) override;
+
   protected:
     int parse(const ErasureCodeProfile &profile,
 	      std::ostream *ss);
 
+    bool can_segment(const bufferlist &chunk) const;
+    bool is_segmented(const std::map<int, bufferlist> &chunks) const;
+    bool can_batch_stripes(unsigned chunk_size) const;
+
+    /**
+     * Return the ErasureCodeDecodeCache key of the **plan** computed to
+     * decode with the chunks in **erasures** missing. Instances with
+     * the same profile share their plans.
+     */
+    std::string decode_signature(const char *plan,
+				 const std::set<int> &erasures) const;
+    int encode_segments(std::map<int, bufferlist> *encoded);
+    int decode_segments(int *erasures, std::map<int, bufferlist> *decoded);
+
   private:
     int chunk_index(unsigned int i) const;
+
+    std::string profile_signature;
   };
 }
 
@@ -0,0 +1,64 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph distributed storage system
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#include "ErasureCodeDecodeCache.h"
+
+namespace ceph {
+
+ErasureCodeDecodeCache &ErasureCodeDecodeCache::instance()
+{
+  static ErasureCodeDecodeCache cache;
+  return cache;
+}
+
+ErasureCodeDecodeCache::PlanRef
+ErasureCodeDecodeCache::get(const std::string &signature)
+{
+  std::lock_guard l{lock};
+  auto p = plans.find(signature);
+  if (p == plans.end())
+    return nullptr;
+  lru.splice(lru.begin(), lru, p->second.first);
+  return p->second.second;
+}
+
+void ErasureCodeDecodeCache::put(const std::string &signature, PlanRef plan)
+{
+  std::lock_guard l{lock};
+  auto p = plans.find(signature);
+  if (p != plans.end()) {
+    // computed concurrently by someone else: keep theirs
+    lru.splice(lru.begin(), lru, p->second.first);
+    return;
+  }
+  while (!lru.empty() && plans.size() >= max_size) {
+    plans.erase(lru.back());
+    lru.pop_back();
+  }
+  lru.push_front(signature);
+  plans.emplace(signature, std::make_pair(lru.begin(), std::move(plan)));
+}
+
+size_t ErasureCodeDecodeCache::size() const
+{
+  std::lock_guard l{lock};
+  return plans.size();
+}
+
+void ErasureCodeDecodeCache::clear()
+{
+  std::lock_guard l{lock};
+  plans.clear();
+  lru.clear();
+}
+
+}
@@ -0,0 +1,88 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph distributed storage system
+ *
+ *  This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2.1 of the License, or (at your option) any later version.
+ *
+ */
+
+#ifndef CEPH_ERASURE_CODE_DECODE_CACHE_H
+#define CEPH_ERASURE_CODE_DECODE_CACHE_H
+
+/*! @file ErasureCodeDecodeCache.h
+    @brief LRU cache of what plugins compute before they can decode
+
+    Decoding needs a plan that depends only on the profile and on
+    which chunks are missing: an inverted matrix, an XOR schedule, the
+    order in which to repair the planes of a CLAY chunk... While an
+    OSD is down, every object of every PG it held is decoded with the
+    same erasures, and recomputing the plan each time adds up. Plugins
+    keep their plans here, keyed by ErasureCode::decode_signature().
+ */
+
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "common/ceph_mutex.h"
+
+namespace ceph {
+
+  class ErasureCodeDecodeCache {
+  public:
+    /// what a plugin computed to decode a given set of erasures
+    struct Plan {
+      virtual ~Plan() = default;
+    };
+    typedef std::shared_ptr<const Plan> PlanRef;
+
+    // enough for every combination of up to 4 erasures out of 16 chunks
+    static const size_t DEFAULT_SIZE = 2516;
+
+    explicit ErasureCodeDecodeCache(size_t max_size = DEFAULT_SIZE)
+      : max_size(max_size) {}
+
+    /// the cache shared by the plugins of this library
+    static ErasureCodeDecodeCache &instance();
+
+    /// return the plan for **signature** or nullptr
+    PlanRef get(const std::string &signature);
+
+    /// remember **plan** for **signature**, evicting the oldest if full
+    void put(const std::string &signature, PlanRef plan);
+
+    /**
+     * Return the plan for **signature**, computing it with **make**
+     * and remembering it if it is not known yet. **make** returns
+     * nullptr if there is no plan, e.g. when there are too many
+     * erasures, and nothing is remembered then.
+     */
+    template <typename T, typename F>
+    std::shared_ptr<const T> lookup(const std::string &signature, F &&make) {
+      if (PlanRef plan = get(signature))
+	return std::static_pointer_cast<const T>(plan);
+      std::shared_ptr<const T> plan = make();
+      if (plan)
+	put(signature, plan);
+      return plan;
+    }
+
+    size_t size() const;
+    void clear();
+
+  private:
+    typedef std::list<std::string> lru_t;
+
+    mutable ceph::mutex lock = ceph::make_mutex("ErasureCodeDecodeCache::lock");
+    size_t max_size;
+    lru_t lru;
+    std::map<std::string, std::pair<lru_t::iterator, PlanRef>> plans;
+  };
+}
+
+#endif
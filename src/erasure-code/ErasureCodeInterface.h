@@ -355,6 +355,12 @@ namespace ceph {
      * by the encode method. They will be freed when **encoded** is
      * freed. The allocation method is not specified.
      *
+     * **in** may be made of several buffers. Plugins that can work on
+     * each of them where it is, as long as it is suitably aligned,
+     * do so and the data chunks in **encoded** are then made of
+     * several buffers too. The same goes for the chunks given to
+     * decode.
+     *
      * Returns 0 on success.
      *
      * @param [in] want_to_encode chunk indexes to be encoded
@@ -412,6 +418,108 @@ namespace ceph {
                               const std::map<int, bufferlist> &chunks,
                               std::map<int, bufferlist> *decoded) = 0;
 
+    /**
+     * Optimizations a plugin may implement on top of **encode** and
+     * **decode**, as returned by **get_supported_optimizations**.
+     */
+    enum {
+      /// encode_delta() and apply_delta() are implemented
+      FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION = 1 << 0,
+    };
+
+    /**
+     * Return the FLAG_EC_PLUGIN_* optimizations the instance
+     * supports with the profile it was initialized with.
+     *
+     * @return a bitmask of FLAG_EC_PLUGIN_* flags
+     */
+    virtual uint64_t get_supported_optimizations() const = 0;
+
+    /**
+     * Compute the difference between the **old_data** and the
+     * **new_data** content of a data chunk and store it in
+     * **delta**, to be passed to **apply_delta**.
+     *
+     * Both buffers must have the same size, which must be a valid
+     * chunk size for the instance.
+     *
+     * @param [in] old_data current content of the data chunk
+     * @param [in] new_data content the data chunk is overwritten with
+     * @param [out] delta difference between the two
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int encode_delta(const bufferlist &old_data,
+                             const bufferlist &new_data,
+                             bufferlist *delta) = 0;
+
+    /**
+     * Update the **coding** chunks in place so that they match a
+     * stripe in which the data chunk **data_chunk** changed by
+     * **delta**, as if the whole stripe had been encoded again.
+     * Only the data chunk that changed and the coding chunks are
+     * needed, which makes small overwrites much cheaper than
+     * reading and encoding the full stripe.
+     *
+     * Chunk indexes are those of **encode_chunks**. **coding** must
+     * hold every coding chunk; the buffers are modified in place
+     * and must not be shared with anything else.
+     *
+     * Returns -EOPNOTSUPP unless
+     * FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION is supported.
+     *
+     * @param [in] data_chunk index of the data chunk that changed
+     * @param [in] delta as returned by **encode_delta**
+     * @param [in,out] coding map coding chunk indexes to chunk data
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int apply_delta(int data_chunk,
+                            const bufferlist &delta,
+                            std::map<int, bufferlist> *coding) = 0;
+
+    /**
+     * Encode **in**, made of whole stripes of
+     * **get_data_chunk_count()** chunks of **chunk_size** bytes
+     * each, in a single call. Chunk **i** in **encoded** is the
+     * concatenation of chunk **i** of every stripe, exactly as if
+     * **encode** had been called on each stripe in turn.
+     *
+     * Plugins that can, run their coding kernels over all the stripes
+     * at once instead of paying for a call, its allocations and a
+     * reload of the coding tables per stripe, which dominates when
+     * stripes are small.
+     *
+     * **chunk_size** must be what **get_chunk_size** returns for a
+     * stripe of **get_data_chunk_count() * chunk_size** bytes.
+     *
+     * @param [in] want_to_encode chunk indexes to be encoded
+     * @param [in] in stripes to be encoded
+     * @param [in] chunk_size size of a chunk of one stripe
+     * @param [out] encoded map chunk indexes to chunk data
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int encode_stripes(const std::set<int> &want_to_encode,
+                               const bufferlist &in,
+                               unsigned chunk_size,
+                               std::map<int, bufferlist> *encoded) = 0;
+
+    /**
+     * Decode the chunks listed in **want_to_read** from **chunks**,
+     * each of which is the concatenation of that chunk for several
+     * stripes, as encoded by **encode_stripes**. The chunks in
+     * **decoded** hold the same stripes, exactly as if **decode**
+     * had been called on each stripe in turn.
+     *
+     * @param [in] want_to_read chunk indexes to be decoded
+     * @param [in] chunks map chunk indexes to chunk data
+     * @param [in] chunk_size size of a chunk of one stripe
+     * @param [out] decoded map chunk indexes to chunk data
+     * @return **0** on success or a negative errno on error.
+     */
+    virtual int decode_stripes(const std::set<int> &want_to_read,
+                               const std::map<int, bufferlist> &chunks,
+                               unsigned chunk_size,
+                               std::map<int, bufferlist> *decoded) = 0;
+
     /**
      * Return the ordered list of chunks or an empty vector
      * if no remapping is necessary.
@@ -20,6 +20,7 @@
 #include "ErasureCodeClay.h"
 
 #include "common/debug.h"
+#include "erasure-code/ErasureCodeDecodeCache.h"
 #include "erasure-code/ErasureCodePlugin.h"
 #include "include/ceph_assert.h"
 #include "include/str_map.h"
@@ -52,6 +53,22 @@ static int pow_int(int a, int x) {
   return power;
 }
 
+namespace {
+
+// the order in which repair_one_lost_chunk() goes through the planes,
+// and where each of them is in the helper chunks
+struct RepairPlan : public ErasureCodeDecodeCache::Plan {
+  map<int, set<int>> ordered_planes;
+  map<int, int> repair_plane_to_ind;
+};
+
+// the order in which decode_layered() goes through the planes
+struct LayeredDecodePlan : public ErasureCodeDecodeCache::Plan {
+  vector<int> order;
+};
+
+}
+
 ErasureCodeClay::~ErasureCodeClay()
 {
   for (int i = 0; i < q*t; i++) {
@@ -469,35 +486,51 @@ int ErasureCodeClay::repair_one_lost_chunk(map<int, bufferlist> &recovered_data,
   unsigned sub_chunksize = repair_blocksize / repair_subchunks;
 
   int z_vec[t];
-  map<int, set<int> > ordered_planes;
-  map<int, int> repair_plane_to_ind;
   int count_retrieved_sub_chunks = 0;
-  int plane_ind = 0;
 
   bufferptr buf(buffer::create_aligned(sub_chunksize, SIMD_ALIGN));
   bufferlist temp_buf;
   temp_buf.push_back(buf);
 
-  for (auto [index,count] : repair_sub_chunks_ind) {
-    for (int j = index; j < index + count; j++) {
-      get_plane_vector(j, z_vec);
-      int order = 0;
-      // check across all erasures and aloof nodes
-      for ([[maybe_unused]] auto& [node, bl] : recovered_data) {
-        if (node % q == z_vec[node / q]) order++;
-        (void)bl;  // silence -Wunused-variable
-      }
-      for (auto node : aloof_nodes) {
-        if (node % q == z_vec[node / q]) order++;
-      }
-      ceph_assert(order > 0);
-      ordered_planes[order].insert(j);
-      // to keep track of a sub chunk within helper buffer recieved
-      repair_plane_to_ind[j] = plane_ind;
-      plane_ind++;
-    }
+  int lost_chunk;
+  int count = 0;
+  for ([[maybe_unused]] auto& [node, bl] : recovered_data) {
+    lost_chunk = node;
+    count++;
+    (void)bl;  // silence -Wunused-variable
   }
-  assert((unsigned)plane_ind == repair_subchunks);
+  ceph_assert(count == 1);
+
+  // the planes to repair, in order, only depend on the lost chunk and
+  // the aloof nodes: every object repaired after the same failure
+  // shares them
+  string plan_name = "clay-repair-" + stringify(lost_chunk);
+  auto plan = ErasureCodeDecodeCache::instance().lookup<RepairPlan>(
+    decode_signature(plan_name.c_str(), aloof_nodes),
+    [&] {
+      auto plan = std::make_shared<RepairPlan>();
+      int plane_ind = 0;
+      for (auto [index,count] : repair_sub_chunks_ind) {
+	for (int j = index; j < index + count; j++) {
+	  get_plane_vector(j, z_vec);
+	  int order = 0;
+	  // check across all erasures and aloof nodes
+	  if (lost_chunk % q == z_vec[lost_chunk / q]) order++;
+	  for (auto node : aloof_nodes) {
+	    if (node % q == z_vec[node / q]) order++;
+	  }
+	  ceph_assert(order > 0);
+	  plan->ordered_planes[order].insert(j);
+	  // to keep track of a sub chunk within helper buffer recieved
+	  plan->repair_plane_to_ind[j] = plane_ind;
+	  plane_ind++;
+	}
+      }
+      assert((unsigned)plane_ind == repair_subchunks);
+      return std::shared_ptr<const RepairPlan>(std::move(plan));
+    });
+  const map<int, set<int>> &ordered_planes = plan->ordered_planes;
+  const map<int, int> &repair_plane_to_ind = plan->repair_plane_to_ind;
 
   for (int i = 0; i < q*t; i++) {
     if (U_buf[i].length() == 0) {
@@ -507,15 +540,6 @@ int ErasureCodeClay::repair_one_lost_chunk(map<int, bufferlist> &recovered_data,
     }
   }
 
-  int lost_chunk;
-  int count = 0;
-  for ([[maybe_unused]] auto& [node, bl] : recovered_data) {
-    lost_chunk = node;
-    count++;
-    (void)bl;  // silence -Wunused-variable
-  }
-  ceph_assert(count == 1);
-
   set<int> erasures;
   for (int i = 0; i < q; i++) {
     erasures.insert(lost_chunk - lost_chunk % q + i);
@@ -528,7 +552,7 @@ int ErasureCodeClay::repair_one_lost_chunk(map<int, bufferlist> &recovered_data,
     if (ordered_planes.count(order) == 0) {
       break;
     }
-    for (auto z : ordered_planes[order]) {
+    for (auto z : ordered_planes.at(order)) {
       get_plane_vector(z, z_vec);
 
       for (int y = 0; y < t; y++) {
@@ -552,7 +576,7 @@ int ErasureCodeClay::repair_one_lost_chunk(map<int, bufferlist> &recovered_data,
 	      assert(repair_plane_to_ind.count(z) > 0);
 	      assert(repair_plane_to_ind.count(z_sw) > 0);
 	      pft_erasures.insert(i2);
-	      known_subchunks[i0].substr_of(helper_data[node_xy], repair_plane_to_ind[z]*sub_chunksize, sub_chunksize);
+	      known_subchunks[i0].substr_of(helper_data[node_xy], repair_plane_to_ind.at(z)*sub_chunksize, sub_chunksize);
 	      known_subchunks[i3].substr_of(U_buf[node_sw], z_sw*sub_chunksize, sub_chunksize);
 	      pftsubchunks[i0] = known_subchunks[i0];
 	      pftsubchunks[i1] = temp_buf;
@@ -568,8 +592,8 @@ int ErasureCodeClay::repair_one_lost_chunk(map<int, bufferlist> &recovered_data,
 	      if (z_vec[y] != x){
 		pft_erasures.insert(i2);
 		ceph_assert(repair_plane_to_ind.count(z_sw) > 0);
-		known_subchunks[i0].substr_of(helper_data[node_xy], repair_plane_to_ind[z]*sub_chunksize, sub_chunksize);
-		known_subchunks[i1].substr_of(helper_data[node_sw], repair_plane_to_ind[z_sw]*sub_chunksize, sub_chunksize);
+		known_subchunks[i0].substr_of(helper_data[node_xy], repair_plane_to_ind.at(z)*sub_chunksize, sub_chunksize);
+		known_subchunks[i1].substr_of(helper_data[node_sw], repair_plane_to_ind.at(z_sw)*sub_chunksize, sub_chunksize);
 		pftsubchunks[i0] = known_subchunks[i0];
 		pftsubchunks[i1] = known_subchunks[i1];
 		pftsubchunks[i2].substr_of(U_buf[node_xy], z*sub_chunksize, sub_chunksize);
@@ -582,7 +606,7 @@ int ErasureCodeClay::repair_one_lost_chunk(map<int, bufferlist> &recovered_data,
 		char* uncoupled_chunk = U_buf[node_xy].c_str();
 		char* coupled_chunk = helper_data[node_xy].c_str();
 		memcpy(&uncoupled_chunk[z*sub_chunksize],
-		       &coupled_chunk[repair_plane_to_ind[z]*sub_chunksize],
+		       &coupled_chunk[repair_plane_to_ind.at(z)*sub_chunksize],
 		       sub_chunksize);
 	      }
 	    }
@@ -621,7 +645,7 @@ int ErasureCodeClay::repair_one_lost_chunk(map<int, bufferlist> &recovered_data,
 	    ceph_assert(node_sw == lost_chunk);
 	    ceph_assert(helper_data.count(i) > 0);
 	    pft_erasures.insert(i1);
-	    known_subchunks[i0].substr_of(helper_data[i], repair_plane_to_ind[z]*sub_chunksize, sub_chunksize);
+	    known_subchunks[i0].substr_of(helper_data[i], repair_plane_to_ind.at(z)*sub_chunksize, sub_chunksize);
 	    known_subchunks[i2].substr_of(U_buf[i], z*sub_chunksize, sub_chunksize);
 
 	    pftsubchunks[i0] = known_subchunks[i0];
@@ -662,7 +686,6 @@ int ErasureCodeClay::decode_layered(set<int> &erased_chunks,
   ceph_assert(num_erasures == m);
 
   int max_iscore = get_max_iscore(erased_chunks);
-  int order[sub_chunk_no];
   int z_vec[t];
   for (int i = 0; i < q*t; i++) {
     if (U_buf[i].length() == 0) {
@@ -672,7 +695,15 @@ int ErasureCodeClay::decode_layered(set<int> &erased_chunks,
     }
   }
 
-  set_planes_sequential_decoding_order(order, erased_chunks);
+  auto plan = ErasureCodeDecodeCache::instance().lookup<LayeredDecodePlan>(
+    decode_signature("clay-layered", erased_chunks),
+    [&] {
+      auto plan = std::make_shared<LayeredDecodePlan>();
+      plan->order.resize(sub_chunk_no);
+      set_planes_sequential_decoding_order(plan->order.data(), erased_chunks);
+      return std::shared_ptr<const LayeredDecodePlan>(std::move(plan));
+    });
+  const vector<int> &order = plan->order;
 
   for (int iscore = 0; iscore <= max_iscore; iscore++) {
    for (int z = 0; z < sub_chunk_no; z++) {
@@ -83,6 +83,8 @@ ErasureCodeIsa::get_chunk_size(unsigned int object_size) const
 int ErasureCodeIsa::encode_chunks(const set<int> &want_to_encode,
                                   map<int, bufferlist> *encoded)
 {
+  if (is_segmented(*encoded))
+    return encode_segments(encoded);
   char *chunks[k + m];
   for (int i = 0; i < k + m; i++)
     chunks[i] = (*encoded)[i].c_str();
@@ -97,25 +99,87 @@ int ErasureCodeIsa::decode_chunks(const set<int> &want_to_read,
   unsigned blocksize = (*chunks.begin()).second.length();
   int erasures[k + m + 1];
   int erasures_count = 0;
-  char *data[k];
-  char *coding[m];
   for (int i = 0; i < k + m; i++) {
     if (chunks.find(i) == chunks.end()) {
       erasures[erasures_count] = i;
       erasures_count++;
     }
+  }
+  erasures[erasures_count] = -1;
+  ceph_assert(erasures_count > 0);
+  if (is_segmented(*decoded))
+    return decode_segments(erasures, decoded);
+  char *data[k];
+  char *coding[m];
+  for (int i = 0; i < k + m; i++) {
     if (i < k)
       data[i] = (*decoded)[i].c_str();
     else
       coding[i - k] = (*decoded)[i].c_str();
   }
-  erasures[erasures_count] = -1;
-  ceph_assert(erasures_count > 0);
   return isa_decode(erasures, data, coding, blocksize);
 }
 
 // -----------------------------------------------------------------------------
 
+unsigned
+ErasureCodeIsa::get_segment_alignment() const
+{
+  // ec_encode_data() and region_xor() work on any run of aligned bytes
+  return EC_ISA_ADDRESS_ALIGNMENT;
+}
+
+int
+ErasureCodeIsa::encode_segment(char **data, char **coding, unsigned len)
+{
+  isa_encode(data, coding, len);
+  return 0;
+}
+
+int
+ErasureCodeIsa::decode_segment(int *erasures, char **data, char **coding,
+                               unsigned len)
+{
+  return isa_decode(erasures, data, coding, len);
+}
+
+uint64_t
+ErasureCodeIsa::get_supported_optimizations() const
+{
+  // apply_delta() works on encode_chunks() indexes, which only match
+  // the shards when the chunks are not remapped
+  if (chunk_mapping.empty())
+    return FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION;
+  return 0;
+}
+
+int
+ErasureCodeIsa::apply_delta(int data_chunk,
+                            const bufferlist &delta,
+                            map<int, bufferlist> *coding)
+{
+  if (!(get_supported_optimizations() &
+        FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION))
+    return -EOPNOTSUPP;
+  if (data_chunk < 0 || data_chunk >= k)
+    return -EINVAL;
+  unsigned blocksize = delta.length();
+  char *parity[m];
+  for (int i = 0; i < m; i++) {
+    auto p = coding->find(k + i);
+    if (p == coding->end() || p->second.length() != blocksize)
+      return -EINVAL;
+    p->second.rebuild_aligned(EC_ISA_ADDRESS_ALIGNMENT);
+    parity[i] = p->second.c_str();
+  }
+  bufferlist in = delta;
+  in.rebuild_aligned(EC_ISA_ADDRESS_ALIGNMENT);
+  isa_apply_delta(data_chunk, in.c_str(), parity, blocksize);
+  return 0;
+}
+
+// -----------------------------------------------------------------------------
+
 void
 ErasureCodeIsaDefault::isa_encode(char **data,
                                   char **coding,
@@ -132,6 +196,24 @@ ErasureCodeIsaDefault::isa_encode(char **data,
 
 // -----------------------------------------------------------------------------
 
+void
+ErasureCodeIsaDefault::isa_apply_delta(int data_chunk,
+                                       char *delta,
+                                       char **coding,
+                                       int blocksize)
+{
+  if (m == 1) {
+    // single parity stripe, see isa_encode
+    byte_xor((unsigned char*) delta, (unsigned char*) coding[0],
+             (unsigned char*) delta + blocksize);
+  } else {
+    ec_encode_data_update(blocksize, k, m, data_chunk, encode_tbls,
+                          (unsigned char*) delta, (unsigned char**) coding);
+  }
+}
+
+// -----------------------------------------------------------------------------
+
 bool
 ErasureCodeIsaDefault::erasure_contains(int *erasures, int i)
 {
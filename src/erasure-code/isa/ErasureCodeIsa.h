@@ -82,10 +82,28 @@ public:
 
   int init(ceph::ErasureCodeProfile &profile, std::ostream *ss) override;
 
+  uint64_t get_supported_optimizations() const override;
+
+  int apply_delta(int data_chunk,
+                  const ceph::buffer::list &delta,
+                  std::map<int, ceph::buffer::list> *coding) override;
+
+  unsigned get_segment_alignment() const override;
+
+  int encode_segment(char **data, char **coding, unsigned len) override;
+
+  int decode_segment(int *erasures, char **data, char **coding,
+                     unsigned len) override;
+
   virtual void isa_encode(char **data,
                           char **coding,
                           int blocksize) = 0;
 
+  virtual void isa_apply_delta(int data_chunk,
+                               char *delta,
+                               char **coding,
+                               int blocksize) = 0;
+
 
   virtual int isa_decode(int *erasures,
                          char **data,
@@ -134,6 +152,11 @@ public:
                           char **coding,
                           int blocksize) override;
 
+  void isa_apply_delta(int data_chunk,
+                       char *delta,
+                       char **coding,
+                       int blocksize) override;
+
   virtual bool erasure_contains(int *erasures, int i);
 
   int isa_decode(int *erasures,
@@ -15,7 +15,10 @@
  * 
  */
 
+#include <numeric>
+
 #include "common/debug.h"
+#include "erasure-code/ErasureCodeDecodeCache.h"
 #include "ErasureCodeJerasure.h"
 
 
@@ -39,6 +42,7 @@ using std::map;
 using std::set;
 
 using ceph::bufferlist;
+using ceph::bufferptr;
 using ceph::ErasureCodeProfile;
 
 static ostream& _prefix(std::ostream* _dout)
@@ -105,6 +109,8 @@ unsigned int ErasureCodeJerasure::get_chunk_size(unsigned int object_size) const
 int ErasureCodeJerasure::encode_chunks(const set<int> &want_to_encode,
 				       map<int, bufferlist> *encoded)
 {
+  if (is_segmented(*encoded))
+    return encode_segments(encoded);
   char *chunks[k + m];
   for (int i = 0; i < k + m; i++)
     chunks[i] = (*encoded)[i].c_str();
@@ -119,24 +125,329 @@ int ErasureCodeJerasure::decode_chunks(const set<int> &want_to_read,
   unsigned blocksize = (*chunks.begin()).second.length();
   int erasures[k + m + 1];
   int erasures_count = 0;
-  char *data[k];
-  char *coding[m];
   for (int i =  0; i < k + m; i++) {
     if (chunks.find(i) == chunks.end()) {
       erasures[erasures_count] = i;
       erasures_count++;
     }
+  }
+  erasures[erasures_count] = -1;
+
+  ceph_assert(erasures_count > 0);
+  if (is_segmented(*decoded))
+    return decode_segments(erasures, decoded);
+  char *data[k];
+  char *coding[m];
+  for (int i =  0; i < k + m; i++) {
     if (i < k)
       data[i] = (*decoded)[i].c_str();
     else
       coding[i - k] = (*decoded)[i].c_str();
   }
-  erasures[erasures_count] = -1;
-
-  ceph_assert(erasures_count > 0);
   return jerasure_decode(erasures, data, coding, blocksize);
 }
 
+unsigned ErasureCodeJerasure::get_segment_alignment() const
+{
+  return w * LARGEST_VECTOR_WORDSIZE;
+}
+
+int ErasureCodeJerasure::encode_segment(char **data, char **coding,
+					unsigned len)
+{
+  jerasure_encode(data, coding, len);
+  return 0;
+}
+
+int ErasureCodeJerasure::decode_segment(int *erasures, char **data,
+					char **coding, unsigned len)
+{
+  return jerasure_decode(erasures, data, coding, len);
+}
+
+uint64_t ErasureCodeJerasure::get_supported_optimizations() const
+{
+  // apply_delta() works on encode_chunks() indexes, which only match
+  // the shards when the chunks are not remapped
+  if (chunk_mapping.empty())
+    return FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION;
+  return 0;
+}
+
+int ErasureCodeJerasure::apply_delta(int data_chunk,
+				     const bufferlist &delta,
+				     map<int, bufferlist> *coding)
+{
+  if (!(get_supported_optimizations() &
+	FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION))
+    return -EOPNOTSUPP;
+  if (data_chunk < 0 || data_chunk >= k)
+    return -EINVAL;
+  unsigned blocksize = delta.length();
+  char *parity[m];
+  for (int i = 0; i < m; i++) {
+    auto p = coding->find(k + i);
+    if (p == coding->end() || p->second.length() != blocksize)
+      return -EINVAL;
+    p->second.rebuild_aligned(SIMD_ALIGN);
+    parity[i] = p->second.c_str();
+  }
+  bufferlist in = delta;
+  in.rebuild_aligned(SIMD_ALIGN);
+  jerasure_apply_delta(data_chunk, in.c_str(), parity, blocksize);
+  return 0;
+}
+
+void ErasureCodeJerasure::jerasure_apply_delta(int data_chunk,
+					       char *delta,
+					       char **coding,
+					       int blocksize)
+{
+  // the code is linear: encoding a stripe that is all zeros but for
+  // the delta yields what has to be added to each coding chunk
+  bufferptr zero(ceph::buffer::create_aligned(blocksize, SIMD_ALIGN));
+  zero.zero();
+  bufferptr out(ceph::buffer::create_aligned(blocksize * m, SIMD_ALIGN));
+  char *data[k];
+  char *parity[m];
+  for (int i = 0; i < k; i++)
+    data[i] = i == data_chunk ? delta : zero.c_str();
+  for (int i = 0; i < m; i++)
+    parity[i] = out.c_str() + i * blocksize;
+  jerasure_encode(data, parity, blocksize);
+  for (int i = 0; i < m; i++)
+    galois_region_xor(parity[i], coding[i], blocksize);
+}
+
+static void matrix_apply_delta(int k, int m, int w, int *matrix,
+			       int data_chunk, char *delta,
+			       char **coding, int blocksize)
+{
+  for (int i = 0; i < m; i++) {
+    int coefficient = matrix[i * k + data_chunk];
+    if (coefficient == 0)
+      continue;
+    if (coefficient == 1) {
+      galois_region_xor(delta, coding[i], blocksize);
+      continue;
+    }
+    switch (w) {
+    case 8:
+      galois_w08_region_multiply(delta, coefficient, blocksize, coding[i], 1);
+      break;
+    case 16:
+      galois_w16_region_multiply(delta, coefficient, blocksize, coding[i], 1);
+      break;
+    case 32:
+      galois_w32_region_multiply(delta, coefficient, blocksize, coding[i], 1);
+      break;
+    default:
+      ceph_abort_msg("unsupported word size");
+    }
+  }
+}
+
+namespace {
+
+using ceph::ErasureCodeDecodeCache;
+
+std::set<int> erasures_to_set(const int *erasures)
+{
+  std::set<int> erased;
+  for (; *erasures != -1; erasures++)
+    erased.insert(*erasures);
+  return erased;
+}
+
+// what jerasure_matrix_decode() computes before it touches the data
+struct MatrixDecodePlan : public ErasureCodeDecodeCache::Plan {
+  // for each erased data chunk, in the order they must be rebuilt:
+  // the k coefficients and the k chunks they multiply
+  std::vector<int> data_ids;
+  std::vector<int> rows;
+  std::vector<int> src_ids;
+  // the erased coding chunks, encoded again from the data
+  std::vector<int> coding_ids;
+};
+
+std::shared_ptr<const MatrixDecodePlan>
+make_matrix_plan(int k, int m, int w, int *matrix, const std::set<int> &erased)
+{
+  if ((int)erased.size() > m)
+    return nullptr;
+  std::vector<int> is_erased(k + m, 0);
+  for (int i : erased)
+    is_erased[i] = 1;
+  auto plan = std::make_shared<MatrixDecodePlan>();
+
+  // as jerasure_matrix_decode() with row_k_ones: the last erased data
+  // chunk is the xor of the first coding chunk and the other data
+  // chunks when the first coding chunk is available
+  int lastdrive = k;
+  int edd = 0;
+  for (int i = 0; i < k; i++) {
+    if (is_erased[i]) {
+      edd++;
+      lastdrive = i;
+    }
+  }
+  if (is_erased[k])
+    lastdrive = k;
+  if (edd > 1 || (edd > 0 && is_erased[k])) {
+    std::vector<int> decoding_matrix(k * k);
+    std::vector<int> dm_ids(k);
+    if (jerasure_make_decoding_matrix(k, m, w, matrix, is_erased.data(),
+				      decoding_matrix.data(),
+				      dm_ids.data()) < 0)
+      return nullptr;
+    for (int i = 0; edd > 0 && i < lastdrive; i++) {
+      if (is_erased[i]) {
+	plan->data_ids.push_back(i);
+	plan->rows.insert(plan->rows.end(),
+			  decoding_matrix.begin() + i * k,
+			  decoding_matrix.begin() + (i + 1) * k);
+	plan->src_ids.insert(plan->src_ids.end(), dm_ids.begin(), dm_ids.end());
+	edd--;
+      }
+    }
+  }
+  if (edd > 0) {
+    plan->data_ids.push_back(lastdrive);
+    plan->rows.insert(plan->rows.end(), matrix, matrix + k);
+    for (int i = 0; i < k; i++)
+      plan->src_ids.push_back(i < lastdrive ? i : i + 1);
+  }
+  for (int i = 0; i < m; i++) {
+    if (is_erased[k + i])
+      plan->coding_ids.push_back(k + i);
+  }
+  return plan;
+}
+
+// what jerasure_schedule_decode_lazy() computes before it touches the
+// data, as two schedules: one that rebuilds the erased data chunks
+// from k available chunks, then one that encodes the erased coding
+// chunks again
+struct BitmatrixDecodePlan : public ErasureCodeDecodeCache::Plan {
+  std::vector<int> src_ids;
+  std::vector<int> data_ids;
+  int **data_schedule = nullptr;
+  std::vector<int> coding_ids;
+  int **coding_schedule = nullptr;
+
+  ~BitmatrixDecodePlan() override {
+    if (data_schedule)
+      jerasure_free_schedule(data_schedule);
+    if (coding_schedule)
+      jerasure_free_schedule(coding_schedule);
+  }
+};
+
+std::shared_ptr<const BitmatrixDecodePlan>
+make_bitmatrix_plan(int k, int m, int w, int *bitmatrix,
+		    const std::set<int> &erased)
+{
+  if ((int)erased.size() > m)
+    return nullptr;
+  std::vector<int> is_erased(k + m, 0);
+  for (int i : erased)
+    is_erased[i] = 1;
+  auto plan = std::make_shared<BitmatrixDecodePlan>();
+  int row_size = k * w * w;
+
+  for (int i : erased) {
+    if (i < k)
+      plan->data_ids.push_back(i);
+    else
+      plan->coding_ids.push_back(i);
+  }
+  if (!plan->data_ids.empty()) {
+    std::vector<int> decoding_matrix(k * row_size);
+    plan->src_ids.resize(k);
+    if (jerasure_make_decoding_bitmatrix(k, m, w, bitmatrix, is_erased.data(),
+					 decoding_matrix.data(),
+					 plan->src_ids.data()) < 0)
+      return nullptr;
+    std::vector<int> rows;
+    for (int i : plan->data_ids) {
+      rows.insert(rows.end(),
+		  decoding_matrix.begin() + i * row_size,
+		  decoding_matrix.begin() + (i + 1) * row_size);
+    }
+    plan->data_schedule = jerasure_smart_bitmatrix_to_schedule(
+      k, plan->data_ids.size(), w, rows.data());
+  }
+  if (!plan->coding_ids.empty()) {
+    std::vector<int> rows;
+    for (int i : plan->coding_ids) {
+      rows.insert(rows.end(),
+		  bitmatrix + (i - k) * row_size,
+		  bitmatrix + (i - k + 1) * row_size);
+    }
+    plan->coding_schedule = jerasure_smart_bitmatrix_to_schedule(
+      k, plan->coding_ids.size(), w, rows.data());
+  }
+  return plan;
+}
+
+}
+
+int ErasureCodeJerasure::matrix_decode(int *matrix, int *erasures,
+				       char **data, char **coding,
+				       int blocksize)
+{
+  std::set<int> erased = erasures_to_set(erasures);
+  auto plan = ErasureCodeDecodeCache::instance().lookup<MatrixDecodePlan>(
+    decode_signature(technique, erased),
+    [&] { return make_matrix_plan(k, m, w, matrix, erased); });
+  if (!plan)
+    return -1;
+  for (unsigned i = 0; i < plan->data_ids.size(); i++) {
+    jerasure_matrix_dotprod(k, w, const_cast<int*>(&plan->rows[i * k]),
+			    const_cast<int*>(&plan->src_ids[i * k]),
+			    plan->data_ids[i], data, coding, blocksize);
+  }
+  for (int i : plan->coding_ids) {
+    jerasure_matrix_dotprod(k, w, matrix + (i - k) * k, NULL, i,
+			    data, coding, blocksize);
+  }
+  return 0;
+}
+
+int ErasureCodeJerasure::bitmatrix_decode(int *bitmatrix, int packetsize,
+					  int *erasures, char **data,
+					  char **coding, int blocksize)
+{
+  std::set<int> erased = erasures_to_set(erasures);
+  auto plan = ErasureCodeDecodeCache::instance().lookup<BitmatrixDecodePlan>(
+    decode_signature(technique, erased),
+    [&] { return make_bitmatrix_plan(k, m, w, bitmatrix, erased); });
+  if (!plan)
+    return -1;
+  if (plan->data_schedule) {
+    char *src[k];
+    char *dst[plan->data_ids.size()];
+    for (int i = 0; i < k; i++) {
+      int id = plan->src_ids[i];
+      src[i] = id < k ? data[id] : coding[id - k];
+    }
+    for (unsigned i = 0; i < plan->data_ids.size(); i++)
+      dst[i] = data[plan->data_ids[i]];
+    jerasure_schedule_encode(k, plan->data_ids.size(), w,
+			     plan->data_schedule, src, dst,
+			     blocksize, packetsize);
+  }
+  if (plan->coding_schedule) {
+    char *dst[plan->coding_ids.size()];
+    for (unsigned i = 0; i < plan->coding_ids.size(); i++)
+      dst[i] = coding[plan->coding_ids[i] - k];
+    jerasure_schedule_encode(k, plan->coding_ids.size(), w,
+			     plan->coding_schedule, data, dst,
+			     blocksize, packetsize);
+  }
+  return 0;
+}
+
 bool ErasureCodeJerasure::is_prime(int value)
 {
   int prime55[] = {
@@ -167,8 +478,15 @@ int ErasureCodeJerasureReedSolomonVandermonde::jerasure_decode(int *erasures,
                                                                 char **coding,
                                                                 int blocksize)
 {
-  return jerasure_matrix_decode(k, m, w, matrix, 1,
-				erasures, data, coding, blocksize);
+  return matrix_decode(matrix, erasures, data, coding, blocksize);
+}
+
+void ErasureCodeJerasureReedSolomonVandermonde::jerasure_apply_delta(int data_chunk,
+								   char *delta,
+								   char **coding,
+								   int blocksize)
+{
+  matrix_apply_delta(k, m, w, matrix, data_chunk, delta, coding, blocksize);
 }
 
 unsigned ErasureCodeJerasureReedSolomonVandermonde::get_alignment() const
@@ -218,7 +536,16 @@ int ErasureCodeJerasureReedSolomonRAID6::jerasure_decode(int *erasures,
 							 char **coding,
 							 int blocksize)
 {
-  return jerasure_matrix_decode(k, m, w, matrix, 1, erasures, data, coding, blocksize);
+  return matrix_decode(matrix, erasures, data, coding, blocksize);
+}
+
+void ErasureCodeJerasureReedSolomonRAID6::jerasure_apply_delta(int data_chunk,
+							     char *delta,
+							     char **coding,
+							     int blocksize)
+{
+  // reed_sol_r6_encode() computes the same products as the matrix
+  matrix_apply_delta(k, m, w, matrix, data_chunk, delta, coding, blocksize);
 }
 
 unsigned ErasureCodeJerasureReedSolomonRAID6::get_alignment() const
@@ -271,8 +598,8 @@ int ErasureCodeJerasureCauchy::jerasure_decode(int *erasures,
 					       char **coding,
 					       int blocksize)
 {
-  return jerasure_schedule_decode_lazy(k, m, w, bitmatrix,
-				       erasures, data, coding, blocksize, packetsize, 1);
+  return bitmatrix_decode(bitmatrix, packetsize, erasures,
+			  data, coding, blocksize);
 }
 
 unsigned ErasureCodeJerasureCauchy::get_alignment() const
@@ -291,6 +618,12 @@ unsigned ErasureCodeJerasureCauchy::get_alignment() const
   }  
 }
 
+unsigned ErasureCodeJerasureCauchy::get_segment_alignment() const
+{
+  // the bit matrix schedule works on w * packetsize bytes at a time
+  return std::lcm<unsigned>(w * packetsize, LARGEST_VECTOR_WORDSIZE);
+}
+
 int ErasureCodeJerasureCauchy::parse(ErasureCodeProfile &profile,
 				     ostream *ss)
 {
@@ -359,8 +692,8 @@ int ErasureCodeJerasureLiberation::jerasure_decode(int *erasures,
                                                     char **coding,
                                                     int blocksize)
 {
-  return jerasure_schedule_decode_lazy(k, m, w, bitmatrix, erasures, data,
-				       coding, blocksize, packetsize, 1);
+  return bitmatrix_decode(bitmatrix, packetsize, erasures,
+			  data, coding, blocksize);
 }
 
 unsigned ErasureCodeJerasureLiberation::get_alignment() const
@@ -371,6 +704,11 @@ unsigned ErasureCodeJerasureLiberation::get_alignment() const
   return alignment;
 }
 
+unsigned ErasureCodeJerasureLiberation::get_segment_alignment() const
+{
+  return std::lcm<unsigned>(w * packetsize, LARGEST_VECTOR_WORDSIZE);
+}
+
 bool ErasureCodeJerasureLiberation::check_k(ostream *ss) const
 {
   if (k > w) {
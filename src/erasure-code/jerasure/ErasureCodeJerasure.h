@@ -65,6 +65,19 @@ public:
 
   int init(ceph::ErasureCodeProfile &profile, std::ostream *ss) override;
 
+  uint64_t get_supported_optimizations() const override;
+
+  int apply_delta(int data_chunk,
+		  const ceph::buffer::list &delta,
+		  std::map<int, ceph::buffer::list> *coding) override;
+
+  unsigned get_segment_alignment() const override;
+
+  int encode_segment(char **data, char **coding, unsigned len) override;
+
+  int decode_segment(int *erasures, char **data, char **coding,
+		     unsigned len) override;
+
   virtual void jerasure_encode(char **data,
                                char **coding,
                                int blocksize) = 0;
@@ -72,11 +85,21 @@ public:
                                char **data,
                                char **coding,
                                int blocksize) = 0;
+  virtual void jerasure_apply_delta(int data_chunk,
+				    char *delta,
+				    char **coding,
+				    int blocksize);
   virtual unsigned get_alignment() const = 0;
   virtual void prepare() = 0;
   static bool is_prime(int value);
 protected:
   virtual int parse(ceph::ErasureCodeProfile &profile, std::ostream *ss);
+
+  // decode with a plan kept in ErasureCodeDecodeCache
+  int matrix_decode(int *matrix, int *erasures,
+		    char **data, char **coding, int blocksize);
+  int bitmatrix_decode(int *bitmatrix, int packetsize, int *erasures,
+		       char **data, char **coding, int blocksize);
 };
 class ErasureCodeJerasureReedSolomonVandermonde : public ErasureCodeJerasure {
 public:
@@ -102,6 +125,10 @@ public:
                                char **data,
                                char **coding,
                                int blocksize) override;
+  void jerasure_apply_delta(int data_chunk,
+			    char *delta,
+			    char **coding,
+			    int blocksize) override;
   unsigned get_alignment() const override;
   void prepare() override;
 private:
@@ -132,6 +159,10 @@ public:
                                char **data,
                                char **coding,
                                int blocksize) override;
+  void jerasure_apply_delta(int data_chunk,
+			    char *delta,
+			    char **coding,
+			    int blocksize) override;
   unsigned get_alignment() const override;
   void prepare() override;
 private:
@@ -166,6 +197,7 @@ public:
                                char **coding,
                                int blocksize) override;
   unsigned get_alignment() const override;
+  unsigned get_segment_alignment() const override;
   void prepare_schedule(int *matrix);
 private:
   int parse(ceph::ErasureCodeProfile& profile, std::ostream *ss) override;
@@ -215,6 +247,7 @@ public:
                                char **coding,
                                int blocksize) override;
   unsigned get_alignment() const override;
+  unsigned get_segment_alignment() const override;
   virtual bool check_k(std::ostream *ss) const;
   virtual bool check_w(std::ostream *ss) const;
   virtual bool check_packetsize_set(std::ostream *ss) const;
@@ -8,6 +8,10 @@ extern unsigned ceph_str_hash_linux(const char *s, unsigned len);
 extern unsigned ceph_str_hash_rjenkins(const char *s, unsigned len);
 
 extern unsigned ceph_str_hash(int type, const char *s, unsigned len);
+/* hash n strings at once; same results as ceph_str_hash() on each */
+extern void ceph_str_hash_multi(int type, const char * const *strs,
+				const unsigned *lens, unsigned n,
+				unsigned *hashes);
 extern const char *ceph_str_hash_name(int type);
 extern bool ceph_str_hash_valid(int type);
 
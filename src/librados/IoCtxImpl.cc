@@ -803,6 +803,13 @@ int librados::IoCtxImpl::aio_read(const object_t oid, AioCompletionImpl *c,
   c->io = this;
   c->blp = pbl;
 
+  if (snapid == CEPH_NOSNAP &&
+      objecter->wants_ec_direct_read(oloc.pool, len)) {
+    objecter->read_ec_direct(oid, oloc, off, len, pbl, extra_op_flags,
+			     oncomplete, &c->objver);
+    return 0;
+  }
+
   ZTracer::Trace trace;
   if (info)
     trace.init("rados read", &objecter->trace_endpoint, info);
@@ -0,0 +1,147 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#ifndef CEPH_MOSDREPOPBATCH_H
+#define CEPH_MOSDREPOPBATCH_H
+
+#include "MOSDFastDispatchOp.h"
+#include "MOSDRepOp.h"
+
+/*
+ * Several MOSDRepOps for the same PG and peer, shipped as one message.
+ * The receiving OSD splits it back into the individual rep ops on fast
+ * dispatch, so each one is queued, applied and acked exactly as if it
+ * had arrived on its own.
+ */
+
+class MOSDRepOpBatch final : public MOSDFastDispatchOp {
+private:
+  static constexpr int HEAD_VERSION = 1;
+  static constexpr int COMPAT_VERSION = 1;
+
+public:
+  epoch_t map_epoch = 0, min_epoch = 0;
+  spg_t pgid;
+  std::vector<ceph::ref_t<MOSDRepOp>> ops;
+
+  epoch_t get_map_epoch() const override {
+    return map_epoch;
+  }
+  epoch_t get_min_epoch() const override {
+    return min_epoch;
+  }
+  spg_t get_spg() const override {
+    return pgid;
+  }
+
+  void decode_payload() override {
+    using ceph::decode;
+    auto p = payload.cbegin();
+    decode(map_epoch, p);
+    decode(min_epoch, p);
+    decode(pgid, p);
+    uint32_t num_ops;
+    decode(num_ops, p);
+    auto dp = data.cbegin();
+    ops.reserve(num_ops);
+    while (num_ops--) {
+      auto op = ceph::make_message<MOSDRepOp>();
+      ceph_msg_header& h = op->get_header();
+      ceph_tid_t tid;
+      __s16 priority;
+      __u16 version, data_off;
+      uint32_t data_len;
+      ceph::buffer::list front, opdata;
+      decode(tid, p);
+      decode(priority, p);
+      decode(version, p);
+      decode(data_off, p);
+      decode(front, p);
+      decode(data_len, p);
+      dp.copy(data_len, opdata);
+      h.tid = tid;
+      h.priority = priority;
+      h.version = version;
+      h.data_off = data_off;
+      h.src = header.src;
+      op->set_payload(front);
+      op->set_data(opdata);
+      op->decode_payload();
+      ops.push_back(std::move(op));
+    }
+  }
+
+  void encode_payload(uint64_t features) override {
+    using ceph::encode;
+    encode(map_epoch, payload);
+    encode(min_epoch, payload);
+    encode(pgid, payload);
+    encode((uint32_t)ops.size(), payload);
+    for (auto& op : ops) {
+      if (op->empty_payload()) {
+	op->encode_payload(features);
+      }
+      const ceph_msg_header& h = op->get_header();
+      encode((ceph_tid_t)h.tid, payload);
+      encode((__s16)h.priority, payload);
+      encode((__u16)h.version, payload);
+      encode((__u16)h.data_off, payload);
+      encode(op->get_payload(), payload);
+      encode(op->get_data().length(), payload);
+      data.append(op->get_data());
+    }
+  }
+
+  /**
+   * Take the rep ops out of a received batch, to be dispatched one by one
+   * as if each had arrived on the batch's connection by itself.
+   *
+   * Each op takes its share of the messenger throttles the batch was
+   * charged to: the ops share the batch's buffers and outlive it in the
+   * PG queues, while the batch returns its own charge once it is put.
+   */
+  std::vector<ceph::ref_t<MOSDRepOp>> split() {
+    for (auto& op : ops) {
+      op->set_connection(get_connection());
+      op->set_recv_stamp(get_recv_stamp());
+      op->set_throttle_stamp(get_throttle_stamp());
+      op->set_recv_complete_stamp(get_recv_complete_stamp());
+      op->set_dispatch_stamp(get_dispatch_stamp());
+      if (byte_throttler) {
+	byte_throttler->take(op->get_payload().length() +
+			     op->get_middle().length() +
+			     op->get_data().length());
+	op->set_byte_throttler(byte_throttler);
+      }
+      if (msg_throttler) {
+	msg_throttler->take(1);
+	op->set_message_throttler(msg_throttler);
+      }
+    }
+    return std::move(ops);
+  }
+
+  MOSDRepOpBatch()
+    : MOSDFastDispatchOp{MSG_OSD_REPOP_BATCH, HEAD_VERSION, COMPAT_VERSION} {}
+  MOSDRepOpBatch(spg_t pgid, epoch_t map_epoch, epoch_t min_epoch,
+		 std::vector<ceph::ref_t<MOSDRepOp>>&& ops)
+    : MOSDFastDispatchOp{MSG_OSD_REPOP_BATCH, HEAD_VERSION, COMPAT_VERSION},
+      map_epoch(map_epoch),
+      min_epoch(min_epoch),
+      pgid(pgid),
+      ops(std::move(ops)) {}
+private:
+  ~MOSDRepOpBatch() final {}
+
+public:
+  std::string_view get_type_name() const override { return "osd_repop_batch"; }
+  void print(std::ostream& out) const override {
+    out << "osd_repop_batch(" << pgid << " e" << map_epoch << "/" << min_epoch
+	<< " " << ops.size() << " ops)";
+  }
+private:
+  template<class T, typename... Args>
+  friend boost::intrusive_ptr<T> ceph::make_message(Args&&... args);
+};
+
+#endif
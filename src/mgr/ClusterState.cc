@@ -89,7 +89,7 @@ void ClusterState::ingest_pgstats(ref_t<MPGStats> stats)
     pending_inc.update_stat(from, std::move(empty_stat));  
   }
 
-  for (auto p : stats->pg_stat) {
+  for (const auto& p : stats->pg_stat) {
     pg_t pgid = p.first;
     const auto &pg_stats = p.second;
 
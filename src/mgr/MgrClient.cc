@@ -419,7 +419,8 @@ void MgrClient::send_pgstats()
 void MgrClient::_send_pgstats()
 {
   if (pgstats_cb && session) {
-    session->con->send_message(pgstats_cb());
+    session->con->send_message(pgstats_cb(!session->pgstats_full_sent));
+    session->pgstats_full_sent = true;
   }
 }
 
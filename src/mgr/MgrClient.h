@@ -45,6 +45,9 @@ class MgrSessionState
 
   // Our connection to the mgr
   ConnectionRef con;
+
+  // Has the mgr been sent the stats of all our PGs on this session?
+  bool pgstats_full_sent = false;
 };
 
 class MgrCommand : public CommandOp
@@ -85,8 +88,9 @@ protected:
   Context *connect_retry_callback = nullptr;
 
   // If provided, use this to compose an MPGStats to send with
-  // our reports (hook for use by OSD)
-  std::function<MPGStats*()> pgstats_cb;
+  // our reports (hook for use by OSD).  Unless asked for a full
+  // report, it may leave out PGs whose stats it already sent.
+  std::function<MPGStats*(bool full)> pgstats_cb;
   std::function<void(const ConfigPayload &)> set_perf_queries_cb;
   std::function<MetricPayload()> get_perf_report_cb;
 
@@ -141,7 +145,7 @@ public:
   }
 
   void send_pgstats();
-  void set_pgstats_cb(std::function<MPGStats*()>&& cb_)
+  void set_pgstats_cb(std::function<MPGStats*(bool full)>&& cb_)
   {
     std::lock_guard l(lock);
     pgstats_cb = std::move(cb_);
@@ -146,6 +146,8 @@
 #define MSG_OSD_PG_LEASE        133
 #define MSG_OSD_PG_LEASE_ACK    134
 
+#define MSG_OSD_REPOP_BATCH     124
+
 // *** MDS ***
 
 #define MSG_MDS_BEACON             100  // to monitor
@@ -299,6 +299,15 @@ void BlueFS::_init_logger()
 	    "How many times bluefs read found page with all 0s");
   b.add_u64(l_bluefs_read_zeros_errors, "read_zeros_errors",
 	    "How many times bluefs read found transient page with all 0s");
+  b.add_time_avg(l_bluefs_compaction_lat, "compaction_lat",
+		 "Average metadata log compaction latency");
+  b.add_time_avg(l_bluefs_compaction_lock_lat, "compaction_lock_lat",
+		 "Average time the BlueFS lock was held by log compaction");
+  b.add_time(l_bluefs_log_replay_lat, "log_replay_lat",
+	     "Time spent replaying the metadata log at mount");
+  b.add_u64(l_bluefs_log_replay_bytes, "log_replay_bytes",
+	    "Size of the metadata log replayed at mount",
+	    NULL, 0, unit_t(UNIT_BYTES));
 
   logger = b.create_perf_counters();
   cct->get_perfcounters_collection()->add(logger);
@@ -777,11 +786,20 @@ int BlueFS::mount()
   _init_alloc();
   _init_logger();
 
-  r = _replay(false, false);
-  if (r < 0) {
-    derr << __func__ << " failed to replay log: " << cpp_strerror(r) << dendl;
-    _stop_alloc();
-    goto out;
+  {
+    auto replay_start = mono_clock::now();
+    r = _replay(false, false);
+    if (r < 0) {
+      derr << __func__ << " failed to replay log: " << cpp_strerror(r) << dendl;
+      _stop_alloc();
+      goto out;
+    }
+    auto replay_lat = mono_clock::now() - replay_start;
+    logger->tset(l_bluefs_log_replay_lat, utime_t(replay_lat));
+    logger->set(l_bluefs_log_replay_bytes, _get_file(1)->fnode.size);
+    dout(1) << __func__ << " replayed 0x" << std::hex
+            << _get_file(1)->fnode.size << std::dec
+            << " bytes of log in " << replay_lat << dendl;
   }
 
   // init freelist
@@ -1058,8 +1076,14 @@ int BlueFS::_replay(bool noop, bool to_stdout)
     std::cout << " log_fnode " << super.log_fnode << std::endl;
   } 
 
+  // the whole log is consumed sequentially, so read it in large chunks
+  uint64_t replay_prefetch =
+    cct->_conf.get_val<Option::size_t>("bluefs_log_replay_prefetch");
+  replay_prefetch = std::max<uint64_t>(
+    round_up_to(replay_prefetch, super.block_size),
+    cct->_conf->bluefs_max_prefetch);
   FileReader *log_reader = new FileReader(
-    log_file, cct->_conf->bluefs_max_prefetch,
+    log_file, replay_prefetch,
     false,  // !random
     true);  // ignore eof
 
@@ -2163,6 +2187,7 @@ void BlueFS::_compact_log_dump_metadata(bluefs_transaction_t *t,
 void BlueFS::_compact_log_sync()
 {
   dout(10) << __func__ << dendl;
+  auto compact_start = mono_clock::now();
   auto prefer_bdev =
     vselector->select_prefer_bdev(log_writer->file->vselector_hint);
   _rewrite_log_and_layout_sync(true,
@@ -2172,6 +2197,9 @@ void BlueFS::_compact_log_sync()
     0,
     super.memorized_layout);
   logger->inc(l_bluefs_log_compactions);
+  auto compact_lat = mono_clock::now() - compact_start;
+  logger->tinc(l_bluefs_compaction_lat, compact_lat);
+  logger->tinc(l_bluefs_compaction_lock_lat, compact_lat);
 }
 
 void BlueFS::_rewrite_log_and_layout_sync(bool allocate_with_fallback,
@@ -2269,9 +2297,10 @@ void BlueFS::_rewrite_log_and_layout_sync(bool allocate_with_fallback,
  * old extent(s) won't be written to, and reflect everything to compact.
  * New events will be written to the new region that we'll keep.
  *
- * 2. While still holding the lock, encode a bufferlist that dumps all of the
- * in-memory fnodes and names.  This will become the new beginning of the
+ * 2. While still holding the lock, dump all of the in-memory fnodes and
+ * names into a transaction.  This will become the new beginning of the
  * log.  The last event will jump to the log continuation extent from #1.
+ * The (potentially large) transaction is encoded with the lock dropped.
  *
  * 3. Queue a write to a new extent for the new beginnging of the log.
  *
@@ -2292,11 +2321,26 @@ void BlueFS::_compact_log_async(std::unique_lock<ceph::mutex>& l)
   ceph_assert(!new_log);
   ceph_assert(!new_log_writer);
 
+  // account for the time we are holding the lock; stretches spent with
+  // the lock dropped are subtracted from the total
+  auto compact_start = mono_clock::now();
+  ceph::timespan unlocked_span = ceph::timespan::zero();
+  auto drop_lock = [&](auto&& fn) {
+    auto t0 = mono_clock::now();
+    l.unlock();
+    fn();
+    l.lock();
+    unlocked_span += mono_clock::now() - t0;
+  };
+
   // create a new log [writer] so that we know compaction is in progress
   // (see _should_compact_log)
   new_log = ceph::make_ref<File>();
   new_log->fnode.ino = 0;   // so that _flush_range won't try to log the fnode
 
+  // flush devices before we jump, but don't make writers wait for it
+  drop_lock([this] { flush_bdev(); });
+
   // 0. wait for any racing flushes to complete.  (We do not want to block
   // in _flush_sync_log with jump_to set or else a racing thread might flush
   // our entries and our jump_to update won't be correct.)
@@ -2324,8 +2368,6 @@ void BlueFS::_compact_log_async(std::unique_lock<ceph::mutex>& l)
   log_t.op_file_update(log_file->fnode);
   log_t.op_jump(log_seq, old_log_jump_to);
 
-  flush_bdev();  // FIXME?
-
   _flush_and_sync_log(l, 0, old_log_jump_to);
 
   // 2. prepare compacted log
@@ -2352,14 +2394,21 @@ void BlueFS::_compact_log_async(std::unique_lock<ceph::mutex>& l)
   // we might have some more ops in log_t due to _allocate call
   t.claim_ops(log_t);
 
-  bufferlist bl;
-  encode(t, bl);
-  _pad_bl(bl);
-
   dout(10) << __func__ << " new_log_jump_to 0x" << std::hex << new_log_jump_to
 	   << std::dec << dendl;
 
+  // once new_log_writer is set, log flushes that need more runway wait
+  // for us (see _flush_and_sync_log)
   new_log_writer = _create_writer(new_log);
+
+  // t is a private snapshot of the metadata now; encoding it can be
+  // done without blocking writers.  Anything they log meanwhile lands
+  // in the old log past old_log_jump_to and is spliced in below.
+  bufferlist bl;
+  drop_lock([&] {
+    encode(t, bl);
+    _pad_bl(bl);
+  });
   new_log_writer->append(bl);
 
   // 3. flush
@@ -2367,7 +2416,11 @@ void BlueFS::_compact_log_async(std::unique_lock<ceph::mutex>& l)
   ceph_assert(r == 0);
 
   // 4. wait
-  _flush_bdev_safely(new_log_writer);
+  {
+    auto t0 = mono_clock::now();
+    _flush_bdev_safely(new_log_writer);
+    unlocked_span += mono_clock::now() - t0;
+  }
 
   // 5. update our log fnode
   // discard first old_log_jump_to extents
@@ -2420,9 +2473,7 @@ void BlueFS::_compact_log_async(std::unique_lock<ceph::mutex>& l)
   ++super.version;
   _write_super(BDEV_DB);
 
-  lock.unlock();
-  flush_bdev();
-  lock.lock();
+  drop_lock([this] { flush_bdev(); });
 
   // 7. release old space
   dout(10) << __func__ << " release old log extents " << old_extents << dendl;
@@ -2443,6 +2494,9 @@ void BlueFS::_compact_log_async(std::unique_lock<ceph::mutex>& l)
 
   dout(10) << __func__ << " log extents " << log_file->fnode.extents << dendl;
   logger->inc(l_bluefs_log_compactions);
+  auto compact_lat = mono_clock::now() - compact_start;
+  logger->tinc(l_bluefs_compaction_lat, compact_lat);
+  logger->tinc(l_bluefs_compaction_lock_lat, compact_lat - unlocked_span);
 }
 
 void BlueFS::_pad_bl(bufferlist& bl)
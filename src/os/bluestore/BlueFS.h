@@ -52,6 +52,10 @@ enum {
   l_bluefs_read_prefetch_bytes,
   l_bluefs_read_zeros_candidate,
   l_bluefs_read_zeros_errors,
+  l_bluefs_compaction_lat,
+  l_bluefs_compaction_lock_lat,
+  l_bluefs_log_replay_lat,
+  l_bluefs_log_replay_bytes,
 
   l_bluefs_last,
 };
@@ -5167,6 +5167,8 @@ const char **BlueStore::get_tracked_conf_keys() const
     "bluestore_warn_on_no_per_pool_omap",
     "bluestore_warn_on_no_per_pg_omap",
     "bluestore_max_defer_interval",
+    "bluestore_hot_object_threshold",
+    "bluestore_hot_object_half_life",
     NULL
   };
   return KEYS;
@@ -5231,6 +5233,10 @@ void BlueStore::handle_conf_change(const ConfigProxy& conf,
       _set_max_defer_interval();
     }
   }
+  if (changed.count("bluestore_hot_object_threshold") ||
+      changed.count("bluestore_hot_object_half_life")) {
+    _set_hot_object_params();
+  }
   if (changed.count("osd_memory_target") ||
       changed.count("osd_memory_base") ||
       changed.count("osd_memory_cache_min") ||
@@ -5611,6 +5617,12 @@ void BlueStore::_init_logger()
                     "Read EIO errors propagated to high level callers");
   b.add_u64_counter(l_bluestore_reads_with_retries, "bluestore_reads_with_retries",
                     "Read operations that required at least one retry due to failed checksum validation");
+  b.add_u64_counter(l_bluestore_hot_buffered_reads,
+		    "bluestore_hot_buffered_reads",
+		    "Reads cached only because the object is hot");
+  b.add_u64_counter(l_bluestore_hot_buffered_writes,
+		    "bluestore_hot_buffered_writes",
+		    "Writes cached only because the object is hot");
   b.add_u64(l_bluestore_fragmentation, "bluestore_fragmentation_micros",
             "How fragmented bluestore free space is (free extents / max possible number of free extents) * 1000");
   b.add_time_avg(l_bluestore_omap_seek_to_first_lat, "omap_seek_to_first_lat",
@@ -5629,6 +5641,18 @@ void BlueStore::_init_logger()
     "Average collection listing latency");
   b.add_time_avg(l_bluestore_remove_lat, "remove_lat",
     "Average removal latency");
+  b.add_time(l_bluestore_mount_open_db_lat, "mount_open_db_lat",
+    "Time spent opening BlueFS, RocksDB and freelist at last mount");
+  b.add_time(l_bluestore_mount_init_alloc_lat, "mount_init_alloc_lat",
+    "Time spent initializing the allocator at last mount");
+  b.add_time(l_bluestore_mount_open_collections_lat,
+    "mount_open_collections_lat",
+    "Time spent loading collections at last mount");
+  b.add_time(l_bluestore_mount_deferred_replay_lat,
+    "mount_deferred_replay_lat",
+    "Time spent replaying deferred writes at last mount");
+  b.add_time(l_bluestore_mount_lat, "mount_lat",
+    "Total time spent in last mount");
 
   // Resulting size axis configuration for op histograms, values are in bytes
   PerfHistogramCommon::axis_config_d alloc_hist_x_axis_config{
@@ -5874,6 +5898,7 @@ int BlueStore::_open_bdev(bool create)
   block_size_order = ctz(block_size);
   ceph_assert(block_size == 1u << block_size_order);
   _set_max_defer_interval();
+  _set_hot_object_params();
   // and set cache_size based on device type
   r = _set_cache_sizes();
   if (r < 0) {
@@ -6586,9 +6611,14 @@ int BlueStore::_open_db_and_around(bool read_only, bool to_repair)
   if (r < 0)
     goto out_db;
 
-  r = _init_alloc();
-  if (r < 0)
-    goto out_fm;
+  {
+    auto alloc_start = mono_clock::now();
+    r = _init_alloc();
+    if (r < 0)
+      goto out_fm;
+    logger->tset(l_bluestore_mount_init_alloc_lat,
+		 utime_t(mono_clock::now() - alloc_start));
+  }
 
   // Re-open in the proper mode(s).
 
@@ -7723,11 +7753,20 @@ int BlueStore::_mount()
     return -EINVAL;
   }
 
+  auto mount_start = mono_clock::now();
+  auto phase_start = mount_start;
+  auto end_phase = [&](int idx) {
+    auto now = mono_clock::now();
+    logger->tset(idx, utime_t(now - phase_start));
+    phase_start = now;
+  };
+
   dout(5) << __func__ << "::NCB::calling open_db_and_around(read/write)" << dendl;
   int r = _open_db_and_around(false);
   if (r < 0) {
     return r;
   }
+  end_phase(l_bluestore_mount_open_db_lat);
   auto close_db = make_scope_guard([&] {
     if (!mounted) {
       _close_db_and_around(true);
@@ -7740,10 +7779,12 @@ int BlueStore::_mount()
   }
 
   // The recovery process for allocation-map needs to open collection early
+  phase_start = mono_clock::now();
   r = _open_collections();
   if (r < 0) {
     return r;
   }
+  end_phase(l_bluestore_mount_open_collections_lat);
   auto shutdown_cache = make_scope_guard([&] {
     if (!mounted) {
       _shutdown_cache();
@@ -7773,10 +7814,12 @@ int BlueStore::_mount()
   }
 #endif
 
+  phase_start = mono_clock::now();
   r = _deferred_replay();
   if (r < 0) {
     return r;
   }
+  end_phase(l_bluestore_mount_deferred_replay_lat);
 
   mempool_thread.init();
 
@@ -7800,6 +7843,17 @@ int BlueStore::_mount()
     }
   }
 
+  logger->tset(l_bluestore_mount_lat,
+	       utime_t(mono_clock::now() - mount_start));
+  dout(1) << __func__ << " mounted in "
+	  << logger->tget(l_bluestore_mount_lat)
+	  << " (open_db " << logger->tget(l_bluestore_mount_open_db_lat)
+	  << ", init_alloc " << logger->tget(l_bluestore_mount_init_alloc_lat)
+	  << ", open_collections "
+	  << logger->tget(l_bluestore_mount_open_collections_lat)
+	  << ", deferred_replay "
+	  << logger->tget(l_bluestore_mount_deferred_replay_lat)
+	  << ")" << dendl;
   mounted = true;
   return 0;
 }
@@ -10707,6 +10761,17 @@ int BlueStore::_generate_read_result_bl(
   return 0;
 }
 
+bool BlueStore::_note_access_is_hot(Onode *o)
+{
+  uint32_t threshold = hot_object_threshold;
+  if (!threshold) {
+    return false;
+  }
+  uint32_t now = std::chrono::duration_cast<std::chrono::seconds>(
+    ceph::coarse_mono_clock::now().time_since_epoch()).count();
+  return o->note_access(now, hot_object_half_life) >= threshold;
+}
+
 int BlueStore::_do_read(
   Collection *c,
   OnodeRef o,
@@ -10742,6 +10807,13 @@ int BlueStore::_do_read(
     dout(20) << __func__ << " defaulting to buffered read" << dendl;
     buffered = true;
   }
+  if (_note_access_is_hot(o.get()) && !buffered &&
+      (op_flags & (CEPH_OSD_OP_FLAG_FADVISE_DONTNEED |
+		   CEPH_OSD_OP_FLAG_FADVISE_NOCACHE)) == 0) {
+    dout(20) << __func__ << " hot object, will do buffered read" << dendl;
+    logger->inc(l_bluestore_hot_buffered_reads);
+    buffered = true;
+  }
 
   if (offset + length > o->onode.size) {
     length = o->onode.size - offset;
@@ -11104,6 +11176,13 @@ int BlueStore::_do_readv(
     dout(20) << __func__ << " defaulting to buffered read" << dendl;
     buffered = true;
   }
+  if (_note_access_is_hot(o.get()) && !buffered &&
+      (op_flags & (CEPH_OSD_OP_FLAG_FADVISE_DONTNEED |
+		   CEPH_OSD_OP_FLAG_FADVISE_NOCACHE)) == 0) {
+    dout(20) << __func__ << " hot object, will do buffered read" << dendl;
+    logger->inc(l_bluestore_hot_buffered_reads);
+    buffered = true;
+  }
   // this method must be idempotent since we may call it several times
   // before we finally read the expected result.
   bl.clear();
@@ -15285,6 +15364,13 @@ void BlueStore::_choose_write_options(
     dout(20) << __func__ << " defaulting to buffered write" << dendl;
     wctx->buffered = true;
   }
+  if (_note_access_is_hot(o.get()) && !wctx->buffered &&
+      (fadvise_flags & (CEPH_OSD_OP_FLAG_FADVISE_DONTNEED |
+			CEPH_OSD_OP_FLAG_FADVISE_NOCACHE)) == 0) {
+    dout(20) << __func__ << " hot object, will do buffered write" << dendl;
+    logger->inc(l_bluestore_hot_buffered_writes);
+    wctx->buffered = true;
+  }
 
   // apply basic csum block size
   wctx->csum_order = block_size_order;
@@ -163,6 +163,13 @@ enum {
   l_bluestore_omap_get_values_lat,
   l_bluestore_clist_lat,
   l_bluestore_remove_lat,
+  l_bluestore_hot_buffered_reads,
+  l_bluestore_hot_buffered_writes,
+  l_bluestore_mount_open_db_lat,
+  l_bluestore_mount_init_alloc_lat,
+  l_bluestore_mount_open_collections_lat,
+  l_bluestore_mount_deferred_replay_lat,
+  l_bluestore_mount_lat,
   l_bluestore_allocate_hist,
   l_bluestore_last
 };
@@ -190,6 +197,14 @@ public:
     max_defer_interval =
 	cct->_conf.get_val<double>("bluestore_max_defer_interval");
   }
+  void _set_hot_object_params() {
+    hot_object_threshold = std::min<uint64_t>(
+      cct->_conf.get_val<uint64_t>("bluestore_hot_object_threshold"),
+      UINT32_MAX);
+    hot_object_half_life = std::min<uint64_t>(
+      cct->_conf.get_val<uint64_t>("bluestore_hot_object_half_life"),
+      UINT32_MAX);
+  }
 
   struct TransContext;
 
@@ -1111,6 +1126,10 @@ public:
     ceph::mutex flush_lock = ceph::make_mutex("BlueStore::Onode::flush_lock");
     ceph::condition_variable flush_cond;   ///< wait here for uncommitted txns
 
+    /// access temperature, halved every half_life seconds (see note_access)
+    std::atomic<uint32_t> heat = {0};
+    std::atomic<uint32_t> heat_stamp = {0};  ///< coarse time of last decay
+
 	Onode(const ghobject_t& o) : nref(0),
 	c(NULL),
 	oid(o),
@@ -1178,6 +1197,29 @@ public:
       return !pinned;
     }
 
+    /// account an access at coarse time @now (seconds) and return the
+    /// resulting temperature.  Races between accessors may lose an
+    /// update, which is fine for a heuristic.
+    uint32_t note_access(uint32_t now, uint32_t half_life) {
+      uint32_t h = heat.load(std::memory_order_relaxed);
+      uint32_t stamp = heat_stamp.load(std::memory_order_relaxed);
+      if (half_life && now > stamp) {
+        uint32_t periods = (now - stamp) / half_life;
+        if (periods) {
+          h = periods >= 32 ? 0 : h >> periods;
+          heat_stamp.store(stamp + periods * half_life,
+                           std::memory_order_relaxed);
+        }
+      } else if (stamp == 0) {
+        heat_stamp.store(now, std::memory_order_relaxed);
+      }
+      if (h < std::numeric_limits<uint32_t>::max()) {
+        ++h;
+      }
+      heat.store(h, std::memory_order_relaxed);
+      return h;
+    }
+
     static const std::string& calc_omap_prefix(uint8_t flags);
     static void calc_omap_header(uint8_t flags, const Onode* o,
       std::string* out);
@@ -2350,6 +2392,8 @@ private:
   uint64_t osd_memory_cache_min = 0; ///< Min memory to assign when autotuning cache
   double osd_memory_cache_resize_interval = 0; ///< Time to wait between cache resizing 
   double max_defer_interval = 0; ///< Time to wait between last deferred submit
+  std::atomic<uint32_t> hot_object_threshold = {0}; ///< temperature at which we always cache
+  std::atomic<uint32_t> hot_object_half_life = {0}; ///< seconds to halve object temperature
   std::atomic<uint32_t> config_changed = {0}; ///< Counter to determine if there is a configuration change.
 
   typedef std::map<uint64_t, volatile_statfs> osd_pools_map;
@@ -2975,6 +3019,9 @@ private:
     bool* csum_error,
     ceph::buffer::list& bl);
 
+  /// account an access to o and tell if it is hot enough to be cached
+  bool _note_access_is_hot(Onode *o);
+
   int _do_read(
     Collection *c,
     OnodeRef o,
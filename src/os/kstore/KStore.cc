@@ -642,6 +642,11 @@ void KStore::_init_logger()
   b.add_time_avg(l_kstore_state_kv_done_lat, "state_kv_done_lat", "Average kv_done state latency");
   b.add_time_avg(l_kstore_state_finishing_lat, "state_finishing_lat", "Average finishing state latency");
   b.add_time_avg(l_kstore_state_done_lat, "state_done_lat", "Average done state latency");
+  b.add_u64_counter(l_kstore_stripe_writes, "stripe_writes", "Stripes written to the kv store");
+  b.add_u64_counter(l_kstore_stripe_writes_coalesced, "stripe_writes_coalesced",
+		    "Stripe updates merged into a later update of the same stripe within a transaction");
+  b.add_u64_counter(l_kstore_stripe_read_ahead, "stripe_read_ahead",
+		    "Stripes fetched by a single iterator pass for multi-stripe reads");
   logger = b.create_perf_counters();
   cct->get_perfcounters_collection()->add(logger);
 }
@@ -1218,6 +1223,8 @@ int KStore::_do_read(
   int r = 0;
   uint64_t stripe_size = o->onode.stripe_size;
   uint64_t stripe_off;
+  map<uint64_t,bufferlist> stripes;
+  bool read_ahead = false;
 
   dout(20) << __func__ << " " << offset << "~" << length << " size "
 	   << o->onode.size << " nid " << o->onode.nid << dendl;
@@ -1238,9 +1245,20 @@ int KStore::_do_read(
   o->flush();
 
   stripe_off = offset % stripe_size;
+  if (!do_cache && stripe_off + length > stripe_size) {
+    _do_read_stripes(o, offset - stripe_off, stripe_off + length, &stripes);
+    read_ahead = true;
+  }
   while (length > 0) {
     bufferlist stripe;
-    _do_read_stripe(o, offset - stripe_off, &stripe, do_cache);
+    if (read_ahead) {
+      auto p = stripes.find(offset - stripe_off);
+      if (p != stripes.end()) {
+	stripe.claim_append(p->second);
+      }
+    } else {
+      _do_read_stripe(o, offset - stripe_off, &stripe, do_cache);
+    }
     dout(30) << __func__ << " stripe " << offset - stripe_off << " got "
 	     << stripe.length() << dendl;
     unsigned swant = std::min<unsigned>(stripe_size - stripe_off, length);
@@ -1968,6 +1986,13 @@ void KStore::_txc_finalize(OpSequencer *osr, TransContext *txc)
   dout(20) << __func__ << " osr " << osr << " txc " << txc
 	   << " onodes " << txc->onodes << dendl;
 
+  // write out the coalesced stripes
+  for (auto& [key, bl] : txc->pending_stripe_writes) {
+    txc->t->set(PREFIX_DATA, key, bl);
+  }
+  logger->inc(l_kstore_stripe_writes, txc->pending_stripe_writes.size());
+  txc->pending_stripe_writes.clear();
+
   // finalize onodes
   for (set<OnodeRef>::iterator p = txc->onodes.begin();
        p != txc->onodes.end();
@@ -2594,13 +2619,46 @@ void KStore::_do_read_stripe(OnodeRef o, uint64_t offset, bufferlist *pbl, bool
   }
 }
 
+void KStore::_do_read_stripes(OnodeRef o, uint64_t offset, uint64_t length,
+			      map<uint64_t,bufferlist> *stripes)
+{
+  // fetch all stripes covering offset~length in one iterator pass rather
+  // than with one point lookup per stripe
+  uint64_t stripe_size = o->onode.stripe_size;
+  string first, last;
+  get_data_key(o->onode.nid, offset, &first);
+  get_data_key(o->onode.nid, offset + length, &last);
+  KeyValueDB::Iterator it = db->get_iterator(PREFIX_DATA);
+  it->lower_bound(first);
+  for (uint64_t pos = offset; pos < offset + length && it->valid();
+       pos += stripe_size) {
+    string key;
+    get_data_key(o->onode.nid, pos, &key);
+    string cur = it->key();
+    if (cur >= last) {
+      break;
+    }
+    if (cur != key) {
+      // a hole; the stripe after it (if any) is still under the iterator
+      continue;
+    }
+    (*stripes)[pos] = it->value();
+    logger->inc(l_kstore_stripe_read_ahead);
+    it->next();
+  }
+}
+
 void KStore::_do_write_stripe(TransContext *txc, OnodeRef o,
 			      uint64_t offset, bufferlist& bl)
 {
   o->pending_stripes[offset] = bl;
   string key;
   get_data_key(o->onode.nid, offset, &key);
-  txc->t->set(PREFIX_DATA, key, bl);
+  // later writes to the same stripe in this transaction replace this one
+  auto r = txc->pending_stripe_writes.insert_or_assign(std::move(key), bl);
+  if (!r.second) {
+    logger->inc(l_kstore_stripe_writes_coalesced);
+  }
 }
 
 void KStore::_do_remove_stripe(TransContext *txc, OnodeRef o, uint64_t offset)
@@ -2608,6 +2666,7 @@ void KStore::_do_remove_stripe(TransContext *txc, OnodeRef o, uint64_t offset)
   o->pending_stripes.erase(offset);
   string key;
   get_data_key(o->onode.nid, offset, &key);
+  txc->pending_stripe_writes.erase(key);
   txc->t->rmkey(PREFIX_DATA, key);
 }
 
@@ -44,6 +44,9 @@ enum {
   l_kstore_state_kv_done_lat,
   l_kstore_state_finishing_lat,
   l_kstore_state_done_lat,
+  l_kstore_stripe_writes,
+  l_kstore_stripe_writes_coalesced,
+  l_kstore_stripe_read_ahead,
   l_kstore_last
 };
 
@@ -227,6 +230,8 @@ public:
     uint64_t ops, bytes;
 
     std::set<OnodeRef> onodes;     ///< these onodes need to be updated/written
+    /// dirty stripes by data key, written to t once in _txc_finalize
+    std::map<std::string, ceph::buffer::list> pending_stripe_writes;
     KeyValueDB::Transaction t; ///< then we will commit this
     Context *oncommit;         ///< signal on commit
     Context *onreadable;         ///< signal on readable
@@ -392,6 +397,8 @@ private:
   }
 
   void _do_read_stripe(OnodeRef o, uint64_t offset, ceph::buffer::list *pbl, bool do_cache);
+  void _do_read_stripes(OnodeRef o, uint64_t offset, uint64_t length,
+			std::map<uint64_t,ceph::buffer::list> *stripes);
   void _do_write_stripe(TransContext *txc, OnodeRef o,
 			uint64_t offset, ceph::buffer::list& bl);
   void _do_remove_stripe(TransContext *txc, OnodeRef o, uint64_t offset);
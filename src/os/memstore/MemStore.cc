@@ -49,14 +49,18 @@ int MemStore::mount()
   int r = _load();
   if (r < 0)
     return r;
-  finisher.start();
+  for (auto& f : finishers) {
+    f->start();
+  }
   return 0;
 }
 
 int MemStore::umount()
 {
-  finisher.wait_for_empty();
-  finisher.stop();
+  for (auto& f : finishers) {
+    f->wait_for_empty();
+    f->stop();
+  }
   return _save();
 }
 
@@ -668,6 +672,7 @@ int MemStore::queue_transactions(
 					     &on_apply_sync);
   if (on_apply_sync)
     on_apply_sync->complete(0);
+  auto& finisher = get_finisher(c);
   if (on_apply)
     finisher.queue(on_apply);
   if (on_commit)
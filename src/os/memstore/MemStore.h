@@ -17,6 +17,7 @@
 #define CEPH_MEMSTORE_H
 
 #include <atomic>
+#include <memory>
 #include <mutex>
 #include <boost/intrusive_ptr.hpp>
 
@@ -194,7 +195,12 @@ private:
 
   CollectionRef get_collection(const coll_t& cid);
 
-  Finisher finisher;
+  /// completion threads; a collection always maps to the same one
+  std::vector<std::unique_ptr<Finisher>> finishers;
+
+  Finisher& get_finisher(const Collection *c) {
+    return *finishers[c->cid.hash_to_shard(finishers.size())];
+  }
 
   std::atomic<uint64_t> used_bytes;
 
@@ -239,8 +245,13 @@ private:
 public:
   MemStore(CephContext *cct, const std::string& path)
     : ObjectStore(cct, path),
-      finisher(cct),
-      used_bytes(0) {}
+      used_bytes(0) {
+    auto num_finishers = std::max<uint64_t>(
+      1, cct->_conf.get_val<uint64_t>("memstore_num_finishers"));
+    for (uint64_t i = 0; i < num_finishers; ++i) {
+      finishers.emplace_back(std::make_unique<Finisher>(cct));
+    }
+  }
   ~MemStore() override { }
 
   std::string get_type() override {
@@ -174,8 +174,15 @@ ostream &operator<<(ostream &lhs, const ECBackend::Op &rhs)
       << " pending_apply=" << rhs.pending_apply
       << " pending_commit=" << rhs.pending_commit
       << " plan.to_read=" << rhs.plan.to_read
-      << " plan.will_write=" << rhs.plan.will_write
-      << ")";
+      << " plan.will_write=" << rhs.plan.will_write;
+  if (!rhs.plan.delta_writes.empty()) {
+    lhs << " delta_writes=[";
+    for (auto &&i : rhs.plan.delta_writes) {
+      lhs << i.first << ":" << i.second.data_chunks << " ";
+    }
+    lhs << "] delta_reads_pending=" << rhs.delta_reads_pending;
+  }
+  lhs << ")";
   return lhs;
 }
 
@@ -192,6 +199,8 @@ ostream &operator<<(ostream &lhs, const ECBackend::RecoveryOp &rhs)
 	     << " state=" << ECBackend::RecoveryOp::tostr(rhs.state)
 	     << " waiting_on_pushes=" << rhs.waiting_on_pushes
 	     << " extent_requested=" << rhs.extent_requested
+	     << " reading_ahead=" << rhs.reading_ahead
+	     << " deferred_abort=" << rhs.deferred_abort
 	     << ")";
 }
 
@@ -206,6 +215,8 @@ void ECBackend::RecoveryOp::dump(Formatter *f) const
   f->dump_stream("state") << tostr(state);
   f->dump_stream("waiting_on_pushes") << waiting_on_pushes;
   f->dump_stream("extent_requested") << extent_requested;
+  f->dump_bool("reading_ahead", reading_ahead);
+  f->dump_int("deferred_abort", deferred_abort);
 }
 
 ECBackend::ECBackend(
@@ -237,13 +248,23 @@ void ECBackend::_failed_push(const hobject_t &hoid,
   dout(10) << __func__ << ": canceling recovery op for obj " << hoid
 	   << dendl;
   ceph_assert(recovery_ops.count(hoid));
-  eversion_t v = recovery_ops[hoid].v;
-  recovery_ops.erase(hoid);
+  RecoveryOp &op = recovery_ops[hoid];
 
   set<pg_shard_t> fl;
   for (auto&& i : res.errors) {
     fl.insert(i.first);
   }
+  if (!op.waiting_on_pushes.empty()) {
+    // a read-ahead; the pushes of the previous extent are still in flight
+    dout(10) << __func__ << ": deferred until " << op.waiting_on_pushes
+	     << " ack their pushes" << dendl;
+    op.reading_ahead = false;
+    op.deferred_abort = RecoveryOp::ABORT_READ_FAILED;
+    op.failed_read_shards = std::move(fl);
+    return;
+  }
+  eversion_t v = op.v;
+  recovery_ops.erase(hoid);
   get_parent()->on_failed_pull(fl, hoid, v);
 }
 
@@ -453,15 +474,24 @@ void ECBackend::handle_recovery_read_complete(
     target[*i] = &(op.returned_data[*i]);
   }
   map<int, bufferlist> from;
+  uint64_t read_bytes = 0;
   for(map<pg_shard_t, bufferlist>::iterator i = to_read.get<2>().begin();
       i != to_read.get<2>().end();
       ++i) {
+    read_bytes += i->second.length();
     from[i->first.shard] = std::move(i->second);
   }
   dout(10) << __func__ << ": " << from << dendl;
   int r;
   r = ECUtil::decode(sinfo, ec_impl, from, target);
   ceph_assert(r == 0);
+  uint64_t rebuilt_bytes = 0;
+  for (auto &&i : op.returned_data) {
+    rebuilt_bytes += i.second.length();
+  }
+  get_parent()->get_logger()->inc(l_osd_ec_recovery_read_bytes, read_bytes);
+  get_parent()->get_logger()->inc(l_osd_ec_recovery_rebuilt_bytes,
+				  rebuilt_bytes);
   if (attrs) {
     op.xattrs.swap(*attrs);
 
@@ -587,6 +617,45 @@ void ECBackend::dispatch_recovery_messages(RecoveryMessages &m, int priority)
     false, true);
 }
 
+int ECBackend::read_recovery_extent(
+  RecoveryOp &op,
+  RecoveryMessages *m)
+{
+  set<int> want(op.missing_on_shards.begin(), op.missing_on_shards.end());
+  uint64_t from = op.recovery_progress.data_recovered_to;
+  uint64_t amount = get_recovery_chunk_size();
+
+  // with a code like clay, repairing a single shard only takes some of
+  // the sub-chunks of the others: minimum_to_decode() says which, and
+  // only those are read
+  map<pg_shard_t, vector<pair<int, int>>> to_read;
+  int r = get_min_avail_to_read_shards(
+    op.hoid, want, true, false, &to_read);
+  if (r != 0)
+    return r;
+  for (auto &&i : to_read) {
+    int subchunks = 0;
+    for (auto &&j : i.second) {
+      subchunks += j.second;
+    }
+    if (subchunks < ec_impl->get_sub_chunk_count()) {
+      get_parent()->get_logger()->inc(l_osd_ec_recovery_subchunk_reads);
+    }
+  }
+  m->read(
+    this,
+    op.hoid,
+    from,
+    amount,
+    std::move(want),
+    to_read,
+    op.recovery_progress.first && !op.obc);
+  op.extent_requested = make_pair(
+    from,
+    amount);
+  return 0;
+}
+
 void ECBackend::continue_recovery_op(
   RecoveryOp &op,
   RecoveryMessages *m)
@@ -598,9 +667,6 @@ void ECBackend::continue_recovery_op(
       // start read
       op.state = RecoveryOp::READING;
       ceph_assert(!op.recovery_progress.data_complete);
-      set<int> want(op.missing_on_shards.begin(), op.missing_on_shards.end());
-      uint64_t from = op.recovery_progress.data_recovered_to;
-      uint64_t amount = get_recovery_chunk_size();
 
       if (op.recovery_progress.first && op.obc) {
 	/* We've got the attrs and the hinfo, might as well use them */
@@ -610,9 +676,7 @@ void ECBackend::continue_recovery_op(
 	encode(*(op.hinfo), op.xattrs[ECUtil::get_hinfo_key()]);
       }
 
-      map<pg_shard_t, vector<pair<int, int>>> to_read;
-      int r = get_min_avail_to_read_shards(
-	op.hoid, want, true, false, &to_read);
+      int r = read_recovery_extent(op, m);
       if (r != 0) {
 	// we must have lost a recovery source
 	ceph_assert(!op.recovery_progress.first);
@@ -622,17 +686,6 @@ void ECBackend::continue_recovery_op(
 	recovery_ops.erase(op.hoid);
 	return;
       }
-      m->read(
-	this,
-	op.hoid,
-	op.recovery_progress.data_recovered_to,
-	amount,
-	std::move(want),
-	to_read,
-	op.recovery_progress.first && !op.obc);
-      op.extent_requested = make_pair(
-	from,
-	amount);
       dout(10) << __func__ << ": IDLE return " << op << dendl;
       return;
     }
@@ -689,11 +742,32 @@ void ECBackend::continue_recovery_op(
       op.returned_data.clear();
       op.waiting_on_pushes = op.missing_on;
       op.recovery_progress = after_progress;
+      if (!op.recovery_progress.data_complete &&
+	  cct->_conf.get_val<bool>("osd_ec_recovery_read_ahead")) {
+	// overlap the reads of the next extent with these pushes; if the
+	// read can't be sent now, it is retried once they complete
+	op.reading_ahead = read_recovery_extent(op, m) == 0;
+      }
       dout(10) << __func__ << ": READING return " << op << dendl;
       return;
     }
     case RecoveryOp::WRITING: {
       if (op.waiting_on_pushes.empty()) {
+	if (op.deferred_abort != RecoveryOp::NO_ABORT) {
+	  dout(10) << __func__ << ": canceling recovery op for obj " << op.hoid
+		   << " after its pushes completed" << dendl;
+	  hobject_t hoid = op.hoid;
+	  eversion_t v = op.v;
+	  auto why = op.deferred_abort;
+	  set<pg_shard_t> fl = std::move(op.failed_read_shards);
+	  recovery_ops.erase(hoid);
+	  if (why == RecoveryOp::ABORT_READ_FAILED) {
+	    get_parent()->on_failed_pull(fl, hoid, v);
+	  } else {
+	    get_parent()->cancel_pull(hoid);
+	  }
+	  return;
+	}
 	if (op.recovery_progress.data_complete) {
 	  op.state = RecoveryOp::COMPLETE;
 	  for (set<pg_shard_t>::iterator i = op.missing_on.begin();
@@ -718,6 +792,15 @@ void ECBackend::continue_recovery_op(
 	  dout(10) << __func__ << ": WRITING return " << op << dendl;
 	  recovery_ops.erase(op.hoid);
 	  return;
+	} else if (op.reading_ahead) {
+	  op.reading_ahead = false;
+	  op.state = RecoveryOp::READING;
+	  if (op.returned_data.empty()) {
+	    dout(10) << __func__ << ": WRITING wait for read " << op << dendl;
+	    return;
+	  }
+	  dout(10) << __func__ << ": WRITING continue " << op << dendl;
+	  continue;
 	} else {
 	  op.state = RecoveryOp::IDLE;
 	  dout(10) << __func__ << ": WRITING continue " << op << dendl;
@@ -1039,24 +1122,29 @@ void ECBackend::handle_sub_read(
 	  bl, j->get<2>()); // Allow EIO return
       } else {
         dout(25) << __func__ << " case2: going to do fragmented read." << dendl;
-        int subchunk_size =
+        // gather the sub-chunks of every stripe and read them all with
+        // a single readv, which the store can issue at once
+        uint64_t subchunk_size =
           sinfo.get_chunk_size() / ec_impl->get_sub_chunk_count();
-        bool error = false;
-        for (int m = 0; m < (int)j->get<1>() && !error;
-             m += sinfo.get_chunk_size()) {
-          for (auto &&k:op.subchunks.find(i->first)->second) {
-            bufferlist bl0;
-            r = store->read(
-                ch,
-                ghobject_t(i->first, ghobject_t::NO_GEN, shard),
-                j->get<0>() + m + (k.first)*subchunk_size,
-                (k.second)*subchunk_size,
-                bl0, j->get<2>());
-            if (r < 0) {
-              error = true;
-              break;
+        ghobject_t oid(i->first, ghobject_t::NO_GEN, shard);
+        struct stat st;
+        r = store->stat(ch, oid, &st);
+        if (r >= 0) {
+          uint64_t end = std::min<uint64_t>(j->get<0>() + j->get<1>(),
+                                            st.st_size);
+          interval_set<uint64_t> extents;
+          for (uint64_t m = j->get<0>(); m < end;
+               m += sinfo.get_chunk_size()) {
+            for (auto &&k:op.subchunks.find(i->first)->second) {
+              uint64_t off = m + k.first * subchunk_size;
+              if (off >= end)
+                break;
+              extents.insert(off, std::min<uint64_t>(k.second * subchunk_size,
+                                                     end - off));
             }
-            bl.claim_append(bl0);
+          }
+          if (!extents.empty()) {
+            r = store->readv(ch, oid, extents, bl, j->get<2>());
           }
         }
       }
@@ -1271,8 +1359,26 @@ void ECBackend::handle_sub_read_reply(
         dout(20) << __func__ << " have shard=" << j->first.shard << dendl;
       }
       map<int, vector<pair<int, int>>> dummy_minimum;
-      int err;
-      if ((err = ec_impl->minimum_to_decode(rop.want_to_read[iter->first], have, &dummy_minimum)) < 0) {
+      int err = ec_impl->minimum_to_decode(rop.want_to_read[iter->first], have, &dummy_minimum);
+      if (err == 0) {
+	// the shards that answered were asked for some of their sub-chunks
+	// only, to decode along with the others: without those, they may
+	// not have returned enough
+	auto req = rop.to_read.find(iter->first);
+	if (req != rop.to_read.end()) {
+	  for (auto &&j : req->second.need) {
+	    auto k = dummy_minimum.find(j.first.shard);
+	    if (k != dummy_minimum.end() && k->second != j.second) {
+	      dout(20) << __func__ << " shard " << j.first
+		       << " returned sub-chunks " << j.second
+		       << " but decoding needs " << k->second << dendl;
+	      err = -EIO;
+	      break;
+	    }
+	  }
+	}
+      }
+      if (err < 0) {
 	dout(20) << __func__ << " minimum_to_decode failed" << dendl;
         if (rop.in_progress.empty()) {
 	  // If we don't have enough copies, try other pg_shard_ts if available.
@@ -1408,8 +1514,6 @@ void ECBackend::filter_read_op(
   for (set<hobject_t>::iterator i = to_cancel.begin();
        i != to_cancel.end();
        ++i) {
-    get_parent()->cancel_pull(*i);
-
     ceph_assert(op.to_read.count(*i));
     read_request_t &req = op.to_read.find(*i)->second;
     dout(10) << __func__ << ": canceling " << req
@@ -1420,6 +1524,18 @@ void ECBackend::filter_read_op(
 
     op.to_read.erase(*i);
     op.complete.erase(*i);
+
+    auto rop = recovery_ops.find(*i);
+    if (rop != recovery_ops.end() &&
+	!rop->second.waiting_on_pushes.empty()) {
+      // a read-ahead; see continue_recovery_op()
+      dout(10) << __func__ << ": deferred until "
+	       << rop->second.waiting_on_pushes << " ack their pushes" << dendl;
+      rop->second.reading_ahead = false;
+      rop->second.deferred_abort = RecoveryOp::ABORT_READ_CANCELED;
+      continue;
+    }
+    get_parent()->cancel_pull(*i);
     recovery_ops.erase(*i);
   }
 
@@ -1695,22 +1811,12 @@ int ECBackend::get_remaining_shards(
     return -EIO;
   }
 
-  set<int> shards_left;
-  for (auto p : need) {
+  for (auto &&p : need) {
     if (avail.find(p.first) == avail.end()) {
-      shards_left.insert(p.first);
+      ceph_assert(shards.count(shard_id_t(p.first)));
+      to_read->insert(make_pair(shards[shard_id_t(p.first)], p.second));
     }
   }
-
-  vector<pair<int, int>> subchunks;
-  subchunks.push_back(make_pair(0, ec_impl->get_sub_chunk_count()));
-  for (set<int>::iterator i = shards_left.begin();
-       i != shards_left.end();
-       ++i) {
-    ceph_assert(shards.count(shard_id_t(*i)));
-    ceph_assert(avail.find(*i) == avail.end());
-    to_read->insert(make_pair(shards[shard_id_t(*i)], subchunks));
-  }
   return 0;
 }
 
@@ -1892,7 +1998,11 @@ void ECBackend::start_rmw(Op *op, PGTransactionUPtr &&t)
       }
       return ref;
     },
-    get_parent()->get_dpp());
+    get_parent()->get_dpp(),
+    get_parent()->get_pool().allows_ecoverwrites() &&
+    cct->_conf.get_val<bool>("osd_ec_parity_delta_writes") &&
+    (ec_impl->get_supported_optimizations() &
+     ceph::ErasureCodeInterface::FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION));
 
   dout(10) << __func__ << ": " << *op << dendl;
 
@@ -1900,6 +2010,174 @@ void ECBackend::start_rmw(Op *op, PGTransactionUPtr &&t)
   check_ops();
 }
 
+bool ECBackend::use_parity_delta(
+  const hobject_t &hoid,
+  const ECTransaction::DeltaWrite &delta)
+{
+  /* A write still in flight on these stripes may not have reached the
+   * shards yet.  Only the data it writes is in the cache, not the
+   * coding chunks, so read and encode the whole stripes instead. */
+  if (cache.is_pinned(hoid, delta.stripes)) {
+    dout(20) << __func__ << ": " << hoid << " " << delta.stripes
+	     << " pinned by an earlier write" << dendl;
+    return false;
+  }
+  // chunks read and written, against reading the data chunks and
+  // writing every chunk
+  uint64_t k = ec_impl->get_data_chunk_count();
+  uint64_t m = ec_impl->get_coding_chunk_count();
+  return 2 * (delta.data_chunks.size() + m) < k + (k + m);
+}
+
+struct ReadDeltaChunks :
+  public GenContext<pair<RecoveryMessages*, ECBackend::read_result_t& > &> {
+  ECBackend *ec;
+  ECBackend::Op *op;
+  hobject_t hoid;
+  set<int> want;
+  ReadDeltaChunks(
+    ECBackend *ec,
+    ECBackend::Op *op,
+    const hobject_t &hoid,
+    const set<int> &want)
+    : ec(ec), op(op), hoid(hoid), want(want) {}
+  void finish(pair<RecoveryMessages *, ECBackend::read_result_t &> &in) override {
+    ec->handle_delta_read_complete(op, hoid, want, in.second);
+  }
+};
+
+void ECBackend::start_delta_reads(Op *op)
+{
+  map<hobject_t, set<int>> want_to_read;
+  map<hobject_t, read_request_t> for_read_op;
+  for (auto &&i : op->plan.delta_writes) {
+    set<int> want = i.second.data_chunks;
+    for (unsigned j = ec_impl->get_data_chunk_count();
+	 j < ec_impl->get_chunk_count();
+	 ++j) {
+      want.insert(j);
+    }
+    // just want when they are all up, otherwise enough to rebuild them
+    map<pg_shard_t, vector<pair<int, int>>> shards;
+    int r = get_min_avail_to_read_shards(
+      i.first,
+      want,
+      false,
+      false,
+      &shards);
+    ceph_assert(r == 0);
+
+    list<boost::tuple<uint64_t, uint64_t, uint32_t> > to_read;
+    for (auto j = i.second.stripes.begin(); j != i.second.stripes.end(); ++j) {
+      to_read.emplace_back(j.get_start(), j.get_len(), 0);
+    }
+    for_read_op.insert(
+      make_pair(
+	i.first,
+	read_request_t(
+	  to_read,
+	  shards,
+	  false,
+	  new ReadDeltaChunks(this, op, i.first, want))));
+    want_to_read.emplace(i.first, std::move(want));
+  }
+  op->delta_reads_pending = for_read_op.size();
+  start_read_op(
+    CEPH_MSG_PRIO_DEFAULT,
+    want_to_read,
+    for_read_op,
+    OpRequestRef(),
+    false, false);
+}
+
+void ECBackend::handle_delta_read_complete(
+  Op *op,
+  const hobject_t &hoid,
+  const set<int> &want,
+  read_result_t &res)
+{
+  ceph_assert(op->delta_reads_pending);
+  if (res.r != 0) {
+    /* Read the whole stripes instead, as the full stripe read-modify-write
+     * does; that read rebuilds them from whichever shards are left. */
+    dout(0) << __func__ << ": reading " << hoid << " for " << *op
+	    << " failed: " << res << ", reading whole stripes" << dendl;
+    auto &delta = op->plan.delta_writes.at(hoid);
+    objects_read_async_no_cache(
+      map<hobject_t,extent_set>{{hoid, delta.stripes}},
+      [this, op, hoid, want](map<hobject_t,pair<int, extent_map> > &&results) {
+	auto &result = results[hoid];
+	handle_delta_stripes_read(op, hoid, want, result.first, result.second);
+      });
+    return;
+  }
+  auto &chunks = op->delta_read_result[hoid];
+  for (auto &&read : res.returned) {
+    pair<uint64_t, uint64_t> chunk_off_len =
+      sinfo.aligned_offset_len_to_chunk(
+	make_pair(read.get<0>(), read.get<1>()));
+    map<int, bufferlist> have;
+    for (auto &&j : read.get<2>()) {
+      have[j.first.shard] = std::move(j.second);
+    }
+    map<int, bufferlist> decoded;
+    map<int, bufferlist*> missing;
+    for (int i : want) {
+      if (!have.count(i)) {
+	missing[i] = &decoded[i];
+      }
+    }
+    if (!missing.empty()) {
+      dout(10) << __func__ << ": " << hoid << " rebuilding "
+	       << missing.size() << " shards" << dendl;
+      int r = ECUtil::decode(sinfo, ec_impl, have, missing);
+      ceph_assert(r == 0);
+      have.insert(decoded.begin(), decoded.end());
+    }
+    for (int i : want) {
+      ceph_assert(have[i].length() == chunk_off_len.second);
+      chunks[i].insert(chunk_off_len.first, chunk_off_len.second, have[i]);
+    }
+  }
+  if (--op->delta_reads_pending == 0) {
+    check_ops();
+  }
+}
+
+void ECBackend::handle_delta_stripes_read(
+  Op *op,
+  const hobject_t &hoid,
+  const set<int> &want,
+  int r,
+  const extent_map &stripes)
+{
+  ceph_assert(op->delta_reads_pending);
+  if (r < 0) {
+    derr << __func__ << ": reading " << hoid << " for " << *op
+	 << " failed: " << cpp_strerror(r) << " and there is no way to"
+	 << " recover from such an error in this context" << dendl;
+    ceph_abort();
+  }
+  // encoding the old stripes gives the chunks the delta read would have
+  auto &chunks = op->delta_read_result[hoid];
+  for (auto &&extent : stripes) {
+    pair<uint64_t, uint64_t> chunk_off_len =
+      sinfo.aligned_offset_len_to_chunk(
+	make_pair(extent.get_off(), extent.get_len()));
+    bufferlist bl = extent.get_val();
+    map<int, bufferlist> encoded;
+    r = ECUtil::encode(sinfo, ec_impl, bl, want, &encoded);
+    ceph_assert(r == 0);
+    for (int i : want) {
+      ceph_assert(encoded[i].length() == chunk_off_len.second);
+      chunks[i].insert(chunk_off_len.first, chunk_off_len.second, encoded[i]);
+    }
+  }
+  if (--op->delta_reads_pending == 0) {
+    check_ops();
+  }
+}
+
 bool ECBackend::try_state_to_reads()
 {
   if (waiting_state.empty())
@@ -1929,6 +2207,17 @@ bool ECBackend::try_state_to_reads()
   if (op->using_cache) {
     cache.open_write_pin(op->pin);
 
+    for (auto i = op->plan.delta_writes.begin();
+	 i != op->plan.delta_writes.end();) {
+      if (use_parity_delta(i->first, i->second)) {
+	op->plan.to_read.erase(i->first);
+	op->plan.will_write[i->first] = i->second.written;
+	++i;
+      } else {
+	op->plan.delta_writes.erase(i++);
+      }
+    }
+
     extent_set empty;
     for (auto &&hpair: op->plan.will_write) {
       auto to_read_plan_iter = op->plan.to_read.find(hpair.first);
@@ -1947,18 +2236,29 @@ bool ECBackend::try_state_to_reads()
       pending_read.subtract(remote_read);
 
       if (!remote_read.empty()) {
-	op->remote_read[hpair.first] = std::move(remote_read);
+	/* Parity delta writes pin less than a stripe.  Reads are done in
+	 * whole stripes, and the pending data laid over them. */
+	auto &aligned = op->remote_read[hpair.first];
+	for (auto &&extent : remote_read) {
+	  auto bounds = sinfo.offset_len_to_stripe_bounds(extent);
+	  aligned.union_insert(bounds.first, bounds.second);
+	}
       }
       if (!pending_read.empty()) {
 	op->pending_read[hpair.first] = std::move(pending_read);
       }
     }
   } else {
+    op->plan.delta_writes.clear();
     op->remote_read = op->plan.to_read;
   }
 
   dout(10) << __func__ << ": " << *op << dendl;
 
+  if (!op->plan.delta_writes.empty()) {
+    start_delta_reads(op);
+  }
+
   if (!op->remote_read.empty()) {
     ceph_assert(get_parent()->get_pool().allows_ecoverwrites());
     objects_read_async_no_cache(
@@ -2022,6 +2322,7 @@ bool ECBackend::try_reads_to_commit()
       get_parent()->get_info().pgid.pgid,
       sinfo,
       op->remote_read_result,
+      op->delta_read_result,
       op->log_entries,
       &written,
       &trans,
@@ -2060,6 +2361,7 @@ bool ECBackend::try_reads_to_commit()
   }
   op->remote_read.clear();
   op->remote_read_result.clear();
+  op->delta_read_result.clear();
 
   ObjectStore::Transaction empty;
   bool should_write_local = false;
@@ -2449,6 +2751,23 @@ int ECBackend::send_all_remaining_reads(
   const set<pg_shard_t>& ots = rop.obj_to_source[hoid];
   for (set<pg_shard_t>::iterator i = ots.begin(); i != ots.end(); ++i)
     already_read.insert(i->shard);
+
+  // The sub-chunks read from each shard were chosen along with those of
+  // the shard that failed, and may not be what decoding without it
+  // takes: start over with what minimum_to_decode() asks for now.
+  bool subchunk_reads = false;
+  for (auto &&i : rop.to_read.find(hoid)->second.need) {
+    if (i.second.size() != 1 ||
+	i.second.front().second != ec_impl->get_sub_chunk_count()) {
+      subchunk_reads = true;
+    }
+  }
+  if (subchunk_reads) {
+    already_read.clear();
+    for (auto &&i : rop.complete[hoid].returned) {
+      i.get<2>().clear();
+    }
+  }
   dout(10) << __func__ << " have/error shards=" << already_read << dendl;
   map<pg_shard_t, vector<pair<int, int>>> shards;
   int r = get_remaining_shards(hoid, already_read, rop.want_to_read[hoid],
@@ -283,6 +283,18 @@ private:
     // valid in state READING
     std::pair<uint64_t, uint64_t> extent_requested;
 
+    // the read of the next extent was sent before the pushes of the
+    // current one completed (osd_ec_recovery_read_ahead): extent_requested
+    // is that extent, and returned_data is filled once it is read
+    bool reading_ahead = false;
+
+    // the read-ahead failed, or lost its source, while pushes were still
+    // in flight: the op is only torn down once they are all acked, so that
+    // no late push reply reaches a retry of the same object
+    enum abort_t { NO_ABORT, ABORT_READ_FAILED, ABORT_READ_CANCELED };
+    abort_t deferred_abort = NO_ABORT;
+    std::set<pg_shard_t> failed_read_shards;  ///< for ABORT_READ_FAILED
+
     void dump(ceph::Formatter *f) const;
 
     RecoveryOp() : state(IDLE) {}
@@ -293,6 +305,9 @@ private:
   void continue_recovery_op(
     RecoveryOp &op,
     RecoveryMessages *m);
+  int read_recovery_extent(
+    RecoveryOp &op,
+    RecoveryMessages *m);
   void dispatch_recovery_messages(RecoveryMessages &m, int priority);
   friend struct OnRecoveryReadComplete;
   void handle_recovery_read_complete(
@@ -481,8 +496,12 @@ public:
     std::map<hobject_t,extent_set> pending_read; // subset already being read
     std::map<hobject_t,extent_set> remote_read;  // subset we must read
     std::map<hobject_t,extent_map> remote_read_result;
+    /// chunks read for plan.delta_writes, by object and shard
+    std::map<hobject_t,std::map<int,extent_map>> delta_read_result;
+    unsigned delta_reads_pending = 0;
     bool read_in_progress() const {
-      return !remote_read.empty() && remote_read_result.empty();
+      return (!remote_read.empty() && remote_read_result.empty()) ||
+	delta_reads_pending;
     }
 
     /// In progress write state.
@@ -561,6 +580,21 @@ public:
   eversion_t completed_to;
   eversion_t committed_to;
   void start_rmw(Op *op, PGTransactionUPtr &&t);
+  bool use_parity_delta(const hobject_t &hoid,
+			const ECTransaction::DeltaWrite &delta);
+  void start_delta_reads(Op *op);
+  friend struct ReadDeltaChunks;
+  void handle_delta_read_complete(
+    Op *op,
+    const hobject_t &hoid,
+    const std::set<int> &want,
+    read_result_t &res);
+  void handle_delta_stripes_read(
+    Op *op,
+    const hobject_t &hoid,
+    const std::set<int> &want,
+    int r,
+    const extent_map &stripes);
   bool try_state_to_reads();
   bool try_reads_to_commit();
   bool try_finish_rmw();
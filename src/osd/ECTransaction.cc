@@ -30,6 +30,7 @@ using std::string;
 using std::vector;
 
 using ceph::bufferlist;
+using ceph::bufferptr;
 using ceph::decode;
 using ceph::encode;
 using ceph::ErasureCodeInterfaceRef;
@@ -106,12 +107,211 @@ bool ECTransaction::requires_overwrite(
       (op.truncate->first < prev_size)));
 }
 
+bool ECTransaction::get_delta_write(
+  const ECUtil::stripe_info_t &sinfo,
+  uint64_t orig_size,
+  const PGTransaction::ObjectOperation &op,
+  const extent_set &raw_write_set,
+  DeltaWrite *delta)
+{
+  // plain overwrites of existing data only
+  if (!op.is_none() || op.truncate || raw_write_set.empty() ||
+      raw_write_set.range_end() > orig_size) {
+    return false;
+  }
+  const uint64_t chunk_size = sinfo.get_chunk_size();
+  const uint64_t data_chunk_count = sinfo.get_stripe_width() / chunk_size;
+  set<int> data_chunks;
+  extent_set stripes;
+  for (auto extent = raw_write_set.begin();
+       extent != raw_write_set.end();
+       ++extent) {
+    uint64_t end = extent.get_start() + extent.get_len();
+    for (uint64_t off = extent.get_start(); off < end;
+	 off = (off / chunk_size + 1) * chunk_size) {
+      data_chunks.insert(
+	(off % sinfo.get_stripe_width()) / chunk_size);
+    }
+    auto bounds = sinfo.offset_len_to_stripe_bounds(
+      make_pair(extent.get_start(), extent.get_len()));
+    stripes.union_insert(bounds.first, bounds.second);
+  }
+  if (data_chunks.size() >= data_chunk_count) {
+    // every data chunk changes, encoding the stripes is cheaper
+    return false;
+  }
+  delta->stripes = std::move(stripes);
+  delta->data_chunks = std::move(data_chunks);
+  delta->written = raw_write_set;
+  return true;
+}
+
+static bufferlist get_chunk(
+  const map<int, extent_map> &chunks,
+  int shard,
+  uint64_t off,
+  uint64_t len)
+{
+  auto iter = chunks.find(shard);
+  ceph_assert(iter != chunks.end());
+  bufferlist bl;
+  for (auto &&extent: iter->second.intersect(off, len)) {
+    ceph_assert(extent.get_off() == off + bl.length());
+    bl.append(extent.get_val());
+  }
+  ceph_assert(bl.length() == len);
+  return bl;
+}
+
+static void overwrite_with_parity_delta(
+  pg_t pgid,
+  const hobject_t &oid,
+  const ECUtil::stripe_info_t &sinfo,
+  ErasureCodeInterfaceRef &ecimpl,
+  const PGTransaction::ObjectOperation &op,
+  const ECTransaction::DeltaWrite &delta,
+  const map<int, extent_map> &old_chunks,
+  pg_log_entry_t *entry,
+  extent_map &written,
+  map<shard_id_t, ObjectStore::Transaction> *transactions,
+  DoutPrefixProvider *dpp)
+{
+  const uint64_t stripe_width = sinfo.get_stripe_width();
+  const uint64_t chunk_size = sinfo.get_chunk_size();
+  const int k = ecimpl->get_data_chunk_count();
+  const int m = ecimpl->get_coding_chunk_count();
+
+  extent_map to_write;
+  uint32_t fadvise_flags = 0;
+  for (auto &&extent: op.buffer_updates) {
+    using BufferUpdate = PGTransaction::ObjectOperation::BufferUpdate;
+    bufferlist bl;
+    match(
+      extent.get_val(),
+      [&](const BufferUpdate::Write &op) {
+	bl = op.buffer;
+	fadvise_flags |= op.fadvise_flags;
+      },
+      [&](const BufferUpdate::Zero &) {
+	bl.append_zero(extent.get_len());
+      },
+      [&](const BufferUpdate::CloneRange &) {
+	ceph_assert(
+	  0 ==
+	  "CloneRange is not allowed, do_op should have returned ENOTSUPP");
+      });
+    to_write.insert(extent.get_off(), extent.get_len(), bl);
+  }
+  written.insert(to_write);
+
+  /* Rollback restores the saved range on every shard, so every shard
+   * saves it, including the ones this op doesn't write; cloning a range
+   * doesn't copy any data. */
+  if (entry) {
+    vector<pair<uint64_t, uint64_t> > rollback_extents;
+    for (auto &&st : *transactions) {
+      st.second.touch(
+	coll_t(spg_t(pgid, st.first)),
+	ghobject_t(oid, entry->version.version, st.first));
+    }
+    for (auto stripes = delta.stripes.begin();
+	 stripes != delta.stripes.end();
+	 ++stripes) {
+      uint64_t restore_from = sinfo.aligned_logical_offset_to_chunk_offset(
+	stripes.get_start());
+      uint64_t restore_len = sinfo.aligned_logical_offset_to_chunk_offset(
+	stripes.get_len());
+      rollback_extents.emplace_back(make_pair(restore_from, restore_len));
+      for (auto &&st : *transactions) {
+	st.second.clone_range(
+	  coll_t(spg_t(pgid, st.first)),
+	  ghobject_t(oid, ghobject_t::NO_GEN, st.first),
+	  ghobject_t(oid, entry->version.version, st.first),
+	  restore_from,
+	  restore_len,
+	  restore_from);
+      }
+    }
+    ldpp_dout(dpp, 20) << __func__ << ": " << oid
+		       << " marking rollback extents "
+		       << rollback_extents
+		       << dendl;
+    entry->mod_desc.rollback_extents(
+      entry->version.version, rollback_extents);
+  }
+
+  map<int, extent_map> shard_writes; // chunk offsets
+  for (auto stripes = delta.stripes.begin();
+       stripes != delta.stripes.end();
+       ++stripes) {
+    for (uint64_t stripe = stripes.get_start();
+	 stripe < stripes.get_start() + stripes.get_len();
+	 stripe += stripe_width) {
+      uint64_t chunk_off = sinfo.aligned_logical_offset_to_chunk_offset(
+	stripe);
+      map<int, bufferlist> coding;
+      for (int i = k; i < k + m; i++) {
+	// updated in place, so it must not share the read buffer
+	coding[i] = get_chunk(old_chunks, i, chunk_off, chunk_size);
+	coding[i].rebuild();
+      }
+      for (int i = 0; i < k; i++) {
+	auto updates = to_write.intersect(stripe + i * chunk_size, chunk_size);
+	if (updates.empty()) {
+	  continue;
+	}
+	bufferlist old_bl = get_chunk(old_chunks, i, chunk_off, chunk_size);
+	bufferptr new_chunk(ceph::buffer::create_page_aligned(chunk_size));
+	old_bl.begin().copy(chunk_size, new_chunk.c_str());
+	for (auto &&update: updates) {
+	  update.get_val().begin().copy(
+	    update.get_len(),
+	    new_chunk.c_str() + update.get_off() - (stripe + i * chunk_size));
+	}
+	bufferlist new_bl;
+	new_bl.push_back(std::move(new_chunk));
+
+	bufferlist delta_bl;
+	int r = ecimpl->encode_delta(old_bl, new_bl, &delta_bl);
+	ceph_assert(r == 0);
+	r = ecimpl->apply_delta(i, delta_bl, &coding);
+	ceph_assert(r == 0);
+	shard_writes[i].insert(chunk_off, chunk_size, new_bl);
+      }
+      for (auto &&i : coding) {
+	shard_writes[i.first].insert(chunk_off, chunk_size, i.second);
+      }
+    }
+  }
+
+  for (auto &&i : shard_writes) {
+    auto st = transactions->find(shard_id_t(i.first));
+    if (st == transactions->end()) {
+      continue;
+    }
+    for (auto &&extent : i.second) {
+      ldpp_dout(dpp, 20) << __func__ << ": " << oid
+			 << " writing shard " << i.first << " "
+			 << extent.get_off() << "~" << extent.get_len()
+			 << dendl;
+      st->second.write(
+	coll_t(spg_t(pgid, st->first)),
+	ghobject_t(oid, ghobject_t::NO_GEN, st->first),
+	extent.get_off(),
+	extent.get_len(),
+	extent.get_val(),
+	fadvise_flags);
+    }
+  }
+}
+
 void ECTransaction::generate_transactions(
   WritePlan &plan,
   ErasureCodeInterfaceRef &ecimpl,
   pg_t pgid,
   const ECUtil::stripe_info_t &sinfo,
   const map<hobject_t,extent_map> &partial_extents,
+  const map<hobject_t,map<int,extent_map>> &delta_chunks,
   vector<pg_log_entry_t> &entries,
   map<hobject_t,extent_map> *written_map,
   map<shard_id_t, ObjectStore::Transaction> *transactions,
@@ -403,6 +603,35 @@ void ECTransaction::generate_transactions(
 	}
       }
 
+      auto deltaiter = plan.delta_writes.find(oid);
+      if (deltaiter != plan.delta_writes.end()) {
+	auto chunksiter = delta_chunks.find(oid);
+	ceph_assert(chunksiter != delta_chunks.end());
+	overwrite_with_parity_delta(
+	  pgid,
+	  oid,
+	  sinfo,
+	  ecimpl,
+	  op,
+	  deltaiter->second,
+	  chunksiter->second,
+	  entry,
+	  written,
+	  transactions,
+	  dpp);
+	hinfo->set_total_chunk_size_clear_hash(hinfo->get_total_chunk_size());
+	bufferlist hbuf;
+	encode(*hinfo, hbuf);
+	for (auto &&i : *transactions) {
+	  i.second.setattr(
+	    coll_t(spg_t(pgid, i.first)),
+	    ghobject_t(oid, ghobject_t::NO_GEN, i.first),
+	    ECUtil::get_hinfo_key(),
+	    hbuf);
+	}
+	return;
+      }
+
       extent_map to_write;
       auto pextiter = partial_extents.find(oid);
       if (pextiter != partial_extents.end()) {
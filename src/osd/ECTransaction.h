@@ -23,6 +23,18 @@
 #include "ExtentCache.h"
 
 namespace ECTransaction {
+  /**
+   * A partial stripe overwrite done with parity deltas: only the data
+   * chunks it changes and the coding chunks are read, the coding chunks
+   * are updated with the difference between the old and new data, and
+   * only those chunks are written back.
+   */
+  struct DeltaWrite {
+    extent_set stripes;      // stripe aligned, logical offsets
+    std::set<int> data_chunks; // data chunk indexes changed in any stripe
+    extent_set written;      // the bytes the op writes, logical offsets
+  };
+
   struct WritePlan {
     PGTransactionUPtr t;
     bool invalidates_cache = false; // Yes, both are possible
@@ -30,18 +42,32 @@ namespace ECTransaction {
     std::map<hobject_t,extent_set> will_write; // superset of to_read
 
     std::map<hobject_t,ECUtil::HashInfoRef> hash_infos;
+
+    /* objects which may be overwritten with parity deltas; the backend
+     * drops the ones it can't do that way, and for the others replaces
+     * to_read and will_write with the delta reads and writes */
+    std::map<hobject_t,DeltaWrite> delta_writes;
   };
 
   bool requires_overwrite(
     uint64_t prev_size,
     const PGTransaction::ObjectOperation &op);
 
+  /// true (and *delta filled in) if op can be done with parity deltas
+  bool get_delta_write(
+    const ECUtil::stripe_info_t &sinfo,
+    uint64_t orig_size,
+    const PGTransaction::ObjectOperation &op,
+    const extent_set &raw_write_set,
+    DeltaWrite *delta);
+
   template <typename F>
   WritePlan get_write_plan(
     const ECUtil::stripe_info_t &sinfo,
     PGTransactionUPtr &&t,
     F &&get_hinfo,
-    DoutPrefixProvider *dpp) {
+    DoutPrefixProvider *dpp,
+    bool parity_delta = false) {
     WritePlan plan;
     t->safe_create_traverse(
       [&](std::pair<const hobject_t, PGTransaction::ObjectOperation> &i) {
@@ -150,6 +176,17 @@ namespace ECTransaction {
 	  }
 	}
 
+	if (parity_delta && plan.to_read.count(i.first)) {
+	  DeltaWrite delta;
+	  if (get_delta_write(sinfo, orig_size, i.second, raw_write_set,
+			      &delta)) {
+	    ldpp_dout(dpp, 20) << __func__ << ": " << i.first
+			       << " may use parity deltas for chunks "
+			       << delta.data_chunks << dendl;
+	    plan.delta_writes.emplace(i.first, std::move(delta));
+	  }
+	}
+
 	if (i.second.truncate &&
 	    i.second.truncate->second > projected_size) {
 	  uint64_t truncating_to =
@@ -188,6 +225,7 @@ namespace ECTransaction {
     pg_t pgid,
     const ECUtil::stripe_info_t &sinfo,
     const std::map<hobject_t,extent_map> &partial_extents,
+    const std::map<hobject_t,std::map<int,extent_map>> &delta_chunks,
     std::vector<pg_log_entry_t> &entries,
     std::map<hobject_t,extent_map> *written,
     std::map<shard_id_t, ObjectStore::Transaction> *transactions,
@@ -220,6 +220,23 @@ void ExtentCache::present_rmw_update(
   }
 }
 
+bool ExtentCache::is_pinned(
+  const hobject_t &oid,
+  const extent_set &extents)
+{
+  auto *eset = get_if_exists(oid);
+  if (!eset) {
+    return false;
+  }
+  for (auto &&res: extents) {
+    auto range = eset->get_containing_range(res.first, res.second);
+    if (range.first != range.second) {
+      return true;
+    }
+  }
+  return false;
+}
+
 ostream &ExtentCache::print(ostream &out) const
 {
   out << "ExtentCache(" << std::endl;
@@ -473,6 +473,20 @@ public:
     write_pin &pin,
     const extent_map &extents);
 
+  /**
+   * Checks whether an in progress write pins any of extents
+   *
+   * Such a write hasn't necessarily reached the shards yet, so their
+   * content for those extents can't be relied upon.
+   *
+   * @param oid [in] object
+   * @param extents [in] extents to check
+   * @return true if any part of extents is pinned
+   */
+  bool is_pinned(
+    const hobject_t &oid,
+    const extent_set &extents);
+
   /**
    * Release all buffers pinned by pin
    */
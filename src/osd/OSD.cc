@@ -84,6 +84,7 @@
 #include "messages/MOSDBeacon.h"
 #include "messages/MOSDRepOp.h"
 #include "messages/MOSDRepOpReply.h"
+#include "messages/MOSDRepOpBatch.h"
 #include "messages/MOSDBoot.h"
 #include "messages/MOSDPGTemp.h"
 #include "messages/MOSDPGReadyToMerge.h"
@@ -1670,6 +1671,25 @@ void OSDService::queue_for_snap_trim(PG *pg)
       pg->get_osdmap_epoch()));
 }
 
+void OSDService::queue_for_repop_batch_flush(PG *pg, ceph::timespan delay)
+{
+  spg_t pgid = pg->get_pgid();
+  epoch_t epoch = pg->get_osdmap_epoch();
+  mono_timer.add_event(
+    delay,
+    [this, pgid, epoch]() {
+      enqueue_back(
+	OpSchedulerItem(
+	  unique_ptr<OpSchedulerItem::OpQueueable>(
+	    new PGRepOpBatchFlush(pgid, epoch)),
+	  0,
+	  CEPH_MSG_PRIO_HIGH,
+	  ceph_clock_now(),
+	  0,
+	  epoch));
+    });
+}
+
 template <class MSG_TYPE>
 void OSDService::queue_scrub_event_msg(PG* pg,
 				       Scrub::scrub_prio_t with_priority,
@@ -2222,6 +2242,10 @@ OSD::OSD(CephContext *cct_,
   asok_hook(NULL),
   m_osd_pg_epoch_max_lag_factor(cct->_conf.get_val<double>(
 				  "osd_pg_epoch_max_lag_factor")),
+  op_queue_steal_threshold(cct->_conf.get_val<uint64_t>(
+			     "osd_op_queue_steal_threshold")),
+  op_queue_steal_interval(cct->_conf.get_val<double>(
+			    "osd_op_queue_steal_interval")),
   osd_compat(get_osd_compat_set()),
   osd_op_tp(cct, "OSD::osd_op_tp", "tp_osd_tp",
 	    get_num_op_threads()),
@@ -2656,6 +2680,9 @@ will start to track new ops received afterwards.";
   } else if (prefix == "dump_op_pq_state") {
     f->open_object_section("pq");
     op_shardedwq.dump(f);
+    f->open_object_section("op_cost_model");
+    service.op_cost_model.dump(f);
+    f->close_section();
     f->close_section();
   } else if (prefix == "dump_blocklist") {
     list<pair<entity_addr_t,utime_t> > bl;
@@ -3404,6 +3431,9 @@ int OSD::get_num_op_threads()
 
 float OSD::get_osd_recovery_sleep()
 {
+  // the adaptive throttle paces recovery on its own
+  if (service.get_recovery_max_active_adaptive())
+    return 0;
   if (cct->_conf->osd_recovery_sleep)
     return cct->_conf->osd_recovery_sleep;
   if (!store_is_rotational && !journal_is_rotational)
@@ -3428,6 +3458,8 @@ float OSD::get_osd_delete_sleep()
 
 int OSD::get_recovery_max_active()
 {
+  if (auto adaptive = service.get_recovery_max_active_adaptive(); adaptive)
+    return adaptive;
   if (cct->_conf->osd_recovery_max_active)
     return cct->_conf->osd_recovery_max_active;
   if (store_is_rotational)
@@ -3704,7 +3736,7 @@ int OSD::init()
   if (r < 0)
     goto out;
 
-  mgrc.set_pgstats_cb([this]() { return collect_pg_stats(); });
+  mgrc.set_pgstats_cb([this](bool full) { return collect_pg_stats(full); });
   mgrc.set_perf_metric_query_cb(
     [this](const ConfigPayload &config_payload) {
         set_perf_queries(config_payload);
@@ -6081,6 +6113,9 @@ void OSD::tick_without_osd_lock()
       sched_scrub();
     }
     service.promote_throttle_recalibrate();
+    service.recovery_throttle_recalibrate();
+    recalibrate_op_cost_model();
+    update_scrub_device_load();
     resume_creating_pg();
     bool need_send_beacon = false;
     const auto now = ceph::coarse_mono_clock::now();
@@ -6104,6 +6139,59 @@ void OSD::tick_without_osd_lock()
 					      new C_Tick_WithoutOSDLock(this));
 }
 
+void OSD::update_scrub_device_load()
+{
+  auto& scrub_services = service.get_scrub_services();
+  if (cct->_conf.get_val<double>("osd_scrub_device_util_target") <= 0) {
+    scrub_services.update_device_load(0);
+    logger->set(l_osd_scrub_pace, 100);
+    return;
+  }
+  if (scrub_load_devices.empty()) {
+    store->get_devices(&scrub_load_devices);
+  }
+  auto now = ceph::mono_clock::now();
+  double elapsed_ms =
+    std::chrono::duration<double, std::milli>(now - last_io_ticks_stamp).count();
+  last_io_ticks_stamp = now;
+  double util = 0;
+  for (auto& dev : scrub_load_devices) {
+    uint64_t ticks;
+    if (get_device_io_ticks(dev, &ticks) < 0) {
+      continue;
+    }
+    auto p = last_io_ticks.find(dev);
+    if (p != last_io_ticks.end() && elapsed_ms > 0) {
+      util = std::max(util, std::min((ticks - p->second) / elapsed_ms, 1.0));
+    }
+    last_io_ticks[dev] = ticks;
+  }
+  scrub_services.update_device_load(util);
+  logger->set(l_osd_scrub_device_util, util * 100);
+  logger->set(l_osd_scrub_pace,
+	      scrub_services.scrub_chunk_factor(false) * 100);
+}
+
+void OSD::recalibrate_op_cost_model()
+{
+  if (!cct->_conf.get_val<bool>("osd_mclock_cost_calibration")) {
+    return;
+  }
+  auto& model = service.op_cost_model;
+  if (!model.recalibrate(
+	cct->_conf.get_val<uint64_t>("osd_mclock_cost_calibration_min_samples"),
+	cct->_conf.get_val<double>("osd_mclock_cost_calibration_alpha"))) {
+    return;
+  }
+  dout(10) << __func__ << " cost_per_io " << model.get_cost_per_io()
+	   << " cost_per_byte " << model.get_cost_per_byte() << dendl;
+  for (auto shard : shards) {
+    std::lock_guard l(shard->shard_lock);
+    shard->scheduler->update_cost_model(model.get_cost_per_io(),
+					model.get_cost_per_byte());
+  }
+}
+
 // Usage:
 //   setomapval <pool-id> [namespace/]<obj-name> <key> <val>
 //   rmomapkey <pool-id> [namespace/]<obj-name> <key>
@@ -7220,6 +7308,8 @@ void OSD::ms_fast_dispatch(Message *m)
     return handle_fast_pg_info(static_cast<MOSDPGInfo*>(m));
   case MSG_OSD_PG_REMOVE:
     return handle_fast_pg_remove(static_cast<MOSDPGRemove*>(m));
+  case MSG_OSD_REPOP_BATCH:
+    return handle_fast_repop_batch(static_cast<MOSDRepOpBatch*>(m));
     // these are single-pg messages that handle themselves
   case MSG_OSD_PG_LOG:
   case MSG_OSD_PG_TRIM:
@@ -7590,14 +7680,27 @@ void OSD::resched_all_scrubs()
   dout(10) << __func__ << ": done" << dendl;
 }
 
-MPGStats* OSD::collect_pg_stats()
+MPGStats* OSD::collect_pg_stats(bool full)
 {
-  // This implementation unconditionally sends every is_primary PG's
-  // stats every time we're called.  This has equivalent cost to the
-  // previous implementation's worst case where all PGs are busy and
-  // their stats are always enqueued for sending.
+  // Every is_primary PG is visited each time we're called, but a PG's
+  // stats are only sent if they changed (reported_epoch/reported_seq
+  // moved) since we last sent them, or if this is a full report.  The
+  // mgr keeps the last stats it got for a PG, so leaving out an
+  // unchanged PG loses nothing.  Full reports go out on each new mgr
+  // session and every osd_pg_stats_full_report_interval reports, the
+  // latter to repair anything the mgr dropped (e.g. a PG of a pool it
+  // did not know about yet).
   std::shared_lock l{map_lock};
 
+  if (++pg_stats_reports_since_full >=
+      cct->_conf.get_val<uint64_t>("osd_pg_stats_full_report_interval")) {
+    full = true;
+  }
+  if (full) {
+    pg_stats_reports_since_full = 0;
+  }
+  decltype(last_sent_pg_stats) sent;
+
   osd_stat_t cur_stat = service.get_osd_stat();
   cur_stat.os_perf_stat = store->get_cur_stats();
 
@@ -7618,7 +7721,13 @@ MPGStats* OSD::collect_pg_stats()
       continue;
     }
     pg->with_pg_stats([&](const pg_stat_t& s, epoch_t lec) {
-	m->pg_stat[pg->pg_id.pgid] = s;
+	const pg_t pgid = pg->pg_id.pgid;
+	auto version = s.get_version_pair();
+	if (auto p = last_sent_pg_stats.find(pgid);
+	    full || p == last_sent_pg_stats.end() || p->second != version) {
+	  m->pg_stat[pgid] = s;
+	}
+	sent.emplace(pgid, version);
 	min_last_epoch_clean = std::min(min_last_epoch_clean, lec);
 	min_last_epoch_clean_pgs.push_back(pg->pg_id.pgid);
       });
@@ -7637,6 +7746,10 @@ MPGStats* OSD::collect_pg_stats()
     }
   }
 
+  dout(20) << __func__ << (full ? " full" : "") << " reporting "
+	   << m->pg_stat.size() << "/" << sent.size() << " pgs" << dendl;
+  last_sent_pg_stats.swap(sent);
+
   // indicate whether we are reporting per-pool stats
   m->osd_stat.num_osds = 1;
   m->osd_stat.num_per_pool_osds = per_pool_stats ? 1 : 0;
@@ -7958,16 +8071,31 @@ void OSD::handle_osd_map(MOSDMap *m)
       ghobject_t oid = get_inc_osdmap_pobject_name(e);
       t.write(coll_t::meta(), oid, 0, bl.length(), bl);
 
+      auto apply_start = ceph::mono_clock::now();
       OSDMap *o = new OSDMap;
       if (e > 1) {
-	bufferlist obl;
-        bool got = get_map_bl(e - 1, obl);
-	if (!got) {
-	  auto p = added_maps_bl.find(e - 1);
-	  ceph_assert(p != added_maps_bl.end());
-	  obl = p->second;
+	// build on the previous epoch in memory if we still have it,
+	// sharing everything the incremental doesn't touch; the crc
+	// check below covers us either way.
+	OSDMapRef prev;
+	if (auto am = added_maps.find(e - 1); am != added_maps.end()) {
+	  prev = am->second;
+	} else {
+	  prev = service.lookup_map(e - 1);
+	}
+	if (prev) {
+	  o->shallow_copy_from(*prev);
+	  logger->inc(l_osd_map_inc_shared);
+	} else {
+	  bufferlist obl;
+	  bool got = get_map_bl(e - 1, obl);
+	  if (!got) {
+	    auto p = added_maps_bl.find(e - 1);
+	    ceph_assert(p != added_maps_bl.end());
+	    obl = p->second;
+	  }
+	  o->decode(obl);
 	}
-	o->decode(obl);
       }
 
       OSDMap::Incremental inc;
@@ -7978,6 +8106,7 @@ void OSD::handle_osd_map(MOSDMap *m)
 	derr << "ERROR: bad fsid?  i have " << get_osdmap()->get_fsid() << " and inc has " << inc.fsid << dendl;
 	ceph_abort_msg("bad fsid");
       }
+      logger->tinc(l_osd_map_apply_lat, ceph::mono_clock::now() - apply_start);
 
       bufferlist fbl;
       o->encode(fbl, inc.encode_features | CEPH_FEATURE_RESERVED);
@@ -9311,6 +9440,20 @@ void OSD::handle_fast_pg_remove(MOSDPGRemove *m)
   m->put();
 }
 
+void OSD::handle_fast_repop_batch(MOSDRepOpBatch *m)
+{
+  dout(10) << __func__ << " " << *m << " from " << m->get_source() << dendl;
+  if (!require_osd_peer(m)) {
+    m->put();
+    return;
+  }
+  // dispatch the rep ops one by one, in order
+  for (auto& op : m->split()) {
+    ms_fast_dispatch(op.detach());
+  }
+  m->put();
+}
+
 void OSD::handle_fast_force_recovery(MOSDForceRecovery *m)
 {
   dout(10) << __func__ << " " << *m << dendl;
@@ -9595,6 +9738,80 @@ void OSDService::finish_recovery_op(PG *pg, const hobject_t& soid, bool dequeue)
   _maybe_queue_recovery();
 }
 
+/*
+ * Adjust the number of concurrent recovery ops once per tick from the
+ * client op latency and recovery throughput seen since the last tick:
+ * halve it when clients are slower than osd_recovery_client_latency_target,
+ * otherwise add one while recovery is using all of it and the last step
+ * up actually bought more recovery bytes/sec.
+ */
+void OSDService::recovery_throttle_recalibrate()
+{
+  utime_t now = ceph_clock_now();
+  double dur = now - last_recovery_recalibrate;
+  last_recovery_recalibrate = now;
+
+  auto [lat_sum, lat_count] = osd->logger->get_tavg_ns(l_osd_op_lat);
+  uint64_t client_ops = lat_count - last_client_op_lat.second;
+  double client_lat = client_ops ?
+    (double)(lat_sum - last_client_op_lat.first) / client_ops / 1000000000.0 :
+    0.0;
+  last_client_op_lat = {lat_sum, lat_count};
+
+  uint64_t rbytes = osd->logger->get(l_osd_rbytes);
+  uint64_t bps = dur > 0 ? (rbytes - last_recovery_bytes) / dur : 0;
+  last_recovery_bytes = rbytes;
+  osd->logger->set(l_osd_rbytes_rate, bps);
+
+  double target = cct->_conf.get_val<double>(
+    "osd_recovery_client_latency_target");
+  if (target <= 0) {
+    if (recovery_max_active_adaptive) {
+      recovery_max_active_adaptive = 0;
+      kick_recovery_queue();
+    }
+    osd->logger->set(l_osd_recovery_active_limit,
+		     osd->get_recovery_max_active());
+    return;
+  }
+
+  uint64_t limit = recovery_max_active_adaptive;
+  if (!limit) {
+    // start from the static setting
+    limit = osd->get_recovery_max_active();
+    recovery_limit_raised = false;
+  }
+  uint64_t ceiling = std::max<uint64_t>(
+    cct->_conf.get_val<uint64_t>("osd_recovery_max_active_adaptive_max"), 1);
+  bool saturated;
+  {
+    std::lock_guard l(recovery_lock);
+    saturated = !awaiting_throttle.empty() ||
+      recovery_ops_active + recovery_ops_reserved >= limit;
+  }
+
+  uint64_t new_limit = limit;
+  if (client_lat > target) {
+    new_limit = limit / 2;
+  } else if (saturated && client_lat < target * 0.8 &&
+	     !(recovery_limit_raised && bps <= last_recovery_bps)) {
+    new_limit = limit + 1;
+  }
+  new_limit = std::clamp<uint64_t>(new_limit, 1, ceiling);
+  dout(10) << __func__ << " client latency " << client_lat
+	   << " (target " << target << ") over " << client_ops << " ops, "
+	   << byte_u_t(bps) << "/sec recovery, saturated " << saturated
+	   << ", limit " << limit << " -> " << new_limit << dendl;
+
+  recovery_limit_raised = new_limit > limit;
+  last_recovery_bps = bps;
+  recovery_max_active_adaptive = new_limit;
+  osd->logger->set(l_osd_recovery_active_limit, new_limit);
+  if (new_limit > limit) {
+    kick_recovery_queue();
+  }
+}
+
 bool OSDService::is_recovery_active()
 {
   if (cct->_conf->osd_debug_pretend_recovery_active) {
@@ -9835,6 +10052,8 @@ const char** OSD::get_tracked_conf_keys() const
     "osd_object_clean_region_max_num_intervals",
     "osd_scrub_min_interval",
     "osd_scrub_max_interval",
+    "osd_op_queue_steal_threshold",
+    "osd_op_queue_steal_interval",
     NULL
   };
   return KEYS;
@@ -9914,6 +10133,14 @@ void OSD::handle_conf_change(const ConfigProxy& conf,
     m_osd_pg_epoch_max_lag_factor = conf.get_val<double>(
       "osd_pg_epoch_max_lag_factor");
   }
+  if (changed.count("osd_op_queue_steal_threshold")) {
+    op_queue_steal_threshold = conf.get_val<uint64_t>(
+      "osd_op_queue_steal_threshold");
+  }
+  if (changed.count("osd_op_queue_steal_interval")) {
+    op_queue_steal_interval = conf.get_val<double>(
+      "osd_op_queue_steal_interval");
+  }
 
 #ifdef HAVE_LIBFUSE
   if (changed.count("osd_objectstore_fuse")) {
@@ -10414,6 +10641,7 @@ int OSDShard::_wake_pg_slot(
        i != slot->to_process.rend();
        ++i) {
     scheduler->enqueue_front(std::move(*i));
+    ++queue_depth;
     count++;
   }
   slot->to_process.clear();
@@ -10421,6 +10649,7 @@ int OSDShard::_wake_pg_slot(
        i != slot->waiting.rend();
        ++i) {
     scheduler->enqueue_front(std::move(*i));
+    ++queue_depth;
     count++;
   }
   slot->waiting.clear();
@@ -10432,6 +10661,7 @@ int OSDShard::_wake_pg_slot(
     // someday, if we decide this inefficiency matters
     for (auto j = i->second.rbegin(); j != i->second.rend(); ++j) {
       scheduler->enqueue_front(std::move(*j));
+      ++queue_depth;
       count++;
     }
   }
@@ -10683,10 +10913,37 @@ void OSD::ShardedOpWQ::_add_slot_waiter(
 #undef dout_prefix
 #define dout_prefix *_dout << "osd." << osd->whoami << " op_wq(" << shard_index << ") "
 
+OSDShard *OSD::ShardedOpWQ::_lock_steal_victim(uint32_t shard_index)
+{
+  const uint32_t threshold = osd->op_queue_steal_threshold;
+  OSDShard *victim = nullptr;
+  uint32_t victim_depth = 0;
+  for (uint32_t i = 1; i < osd->num_shards; ++i) {
+    OSDShard *s = osd->shards[(shard_index + i) % osd->num_shards];
+    uint32_t depth = s->queue_depth;
+    if (depth >= threshold && depth > victim_depth) {
+      victim = s;
+      victim_depth = depth;
+    }
+  }
+  if (!victim) {
+    return nullptr;
+  }
+  victim->shard_lock.lock();
+  if (victim->scheduler->empty()) {
+    // drained while we were looking
+    victim->shard_lock.unlock();
+    return nullptr;
+  }
+  dout(20) << __func__ << " shard " << victim->shard_id
+	   << " queue_depth " << victim_depth << dendl;
+  return victim;
+}
+
 void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 {
   uint32_t shard_index = thread_index % osd->num_shards;
-  auto& sdata = osd->shards[shard_index];
+  OSDShard *sdata = osd->shards[shard_index];
   ceph_assert(sdata);
 
   // If all threads of shards do oncommits, there is a out-of-order
@@ -10697,6 +10954,26 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 
   // peek at spg_t
   sdata->shard_lock.lock();
+
+  // Nothing to do here; help out a backlogged shard instead.  We go
+  // through the victim's scheduler and pg slots exactly like one of its
+  // own threads would, so per-pg ordering is preserved.  We never run
+  // the victim's oncommits.
+  bool stealing = false;
+  if (osd->op_queue_steal_threshold &&
+      osd->num_shards > 1 &&
+      sdata->scheduler->empty() &&
+      (!is_smallest_thread_index || sdata->context_queue.empty())) {
+    sdata->shard_lock.unlock();
+    if (OSDShard *victim = _lock_steal_victim(shard_index)) {
+      sdata = victim;
+      is_smallest_thread_index = false;
+      stealing = true;
+    } else {
+      sdata->shard_lock.lock();
+    }
+  }
+
   if (sdata->scheduler->empty() &&
       (!is_smallest_thread_index || sdata->context_queue.empty())) {
     std::unique_lock wait_lock{sdata->sdata_wait_lock};
@@ -10707,7 +10984,14 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
       dout(20) << __func__ << " empty q, waiting" << dendl;
       osd->cct->get_heartbeat_map()->clear_timeout(hb);
       sdata->shard_lock.unlock();
-      sdata->sdata_cond.wait(wait_lock);
+      if (osd->op_queue_steal_threshold) {
+	// wake up now and then to look for work on other shards
+	sdata->sdata_cond.wait_for(
+	  wait_lock,
+	  ceph::make_timespan(osd->op_queue_steal_interval));
+      } else {
+	sdata->sdata_cond.wait(wait_lock);
+      }
       wait_lock.unlock();
       sdata->shard_lock.lock();
       if (sdata->scheduler->empty() &&
@@ -10760,7 +11044,7 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
     // If the work item is scheduled in the future, wait until
     // the time returned in the dequeue response before retrying.
     if (auto when_ready = std::get_if<double>(&work_item)) {
-      if (is_smallest_thread_index) {
+      if (is_smallest_thread_index || stealing) {
         sdata->shard_lock.unlock();
         handle_oncommits(oncommits);
         return;
@@ -10784,6 +11068,13 @@ void OSD::ShardedOpWQ::_process(uint32_t thread_index, heartbeat_handle_d *hb)
 
   // Access the stored item
   auto item = std::move(std::get<OpSchedulerItem>(work_item));
+  --sdata->queue_depth;
+  if (stealing) {
+    dout(20) << __func__ << " stole " << item << " from shard "
+	     << sdata->shard_id << dendl;
+    ++sdata->num_stolen;
+    osd->logger->inc(l_osd_op_wq_steal);
+  }
   if (osd->is_stopping()) {
     sdata->shard_lock.unlock();
     for (auto c : oncommits) {
@@ -11030,6 +11321,7 @@ void OSD::ShardedOpWQ::_enqueue(OpSchedulerItem&& item) {
     std::lock_guard l{sdata->shard_lock};
     empty = sdata->scheduler->empty();
     sdata->scheduler->enqueue(std::move(item));
+    ++sdata->queue_depth;
   }
 
   {
@@ -11065,6 +11357,7 @@ void OSD::ShardedOpWQ::_enqueue_front(OpSchedulerItem&& item)
     dout(20) << __func__ << " " << item << dendl;
   }
   sdata->scheduler->enqueue_front(std::move(item));
+  ++sdata->queue_depth;
   sdata->shard_lock.unlock();
   std::lock_guard l{sdata->sdata_wait_lock};
   sdata->sdata_cond.notify_one();
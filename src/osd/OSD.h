@@ -38,6 +38,7 @@
 #include "OpRequest.h"
 #include "Session.h"
 
+#include "osd/scheduler/OpCostModel.h"
 #include "osd/scheduler/OpScheduler.h"
 
 #include <atomic>
@@ -89,6 +90,7 @@ class MOSDPGCreate2;
 class MOSDPGNotify;
 class MOSDPGInfo;
 class MOSDPGRemove;
+class MOSDRepOpBatch;
 class MOSDForceRecovery;
 class MMonGetPurgedSnapsReply;
 
@@ -443,6 +445,10 @@ public:
     promote_counter.finish(bytes);
   }
   void promote_throttle_recalibrate();
+
+  /// measured store op costs, see OSD::recalibrate_op_cost_model()
+  ceph::osd::scheduler::OpCostModel op_cost_model;
+
   unsigned get_num_shards() const {
     return m_objecter_finishers;
   }
@@ -538,6 +544,7 @@ public:
   AsyncReserver<spg_t, Finisher> snap_reserver;
   void queue_recovery_context(PG *pg, GenContext<ThreadPool::TPHandle&> *c);
   void queue_for_snap_trim(PG *pg);
+  void queue_for_repop_batch_flush(PG *pg, ceph::timespan delay);
   void queue_for_scrub(PG* pg, Scrub::scrub_prio_t with_priority);
 
   void queue_scrub_after_repair(PG* pg, Scrub::scrub_prio_t with_priority);
@@ -629,6 +636,13 @@ private:
   uint64_t recovery_ops_active;
   uint64_t recovery_ops_reserved;
   bool recovery_paused;
+  /// recovery concurrency picked by recovery_throttle_recalibrate(); 0 if off
+  std::atomic<uint64_t> recovery_max_active_adaptive{0};
+  utime_t last_recovery_recalibrate;
+  uint64_t last_recovery_bytes = 0;
+  uint64_t last_recovery_bps = 0;
+  bool recovery_limit_raised = false;
+  std::pair<uint64_t, uint64_t> last_client_op_lat; ///< (sum ns, count)
 #ifdef DEBUG_RECOVERY_OIDS
   std::map<spg_t, std::set<hobject_t> > recovery_oids;
 #endif
@@ -641,6 +655,10 @@ public:
   void finish_recovery_op(PG *pg, const hobject_t& soid, bool dequeue);
   bool is_recovery_active();
   void release_reserved_pushes(uint64_t pushes);
+  void recovery_throttle_recalibrate();
+  uint64_t get_recovery_max_active_adaptive() const {
+    return recovery_max_active_adaptive;
+  }
   void defer_recovery(float defer_for) {
     defer_recovery_until = ceph_clock_now();
     defer_recovery_until += defer_for;
@@ -704,6 +722,11 @@ public:
     ceph_assert(ret);
     return ret;
   }
+  /// return epoch e if it is in the map cache; never loads from disk
+  OSDMapRef lookup_map(epoch_t e) {
+    std::lock_guard l(map_cache_lock);
+    return map_cache.lookup(e);
+  }
   OSDMapRef add_map(OSDMap *o) {
     std::lock_guard l(map_cache_lock);
     return _add_map(o);
@@ -1028,6 +1051,11 @@ struct OSDShard {
   /// priority queue
   ceph::osd::scheduler::OpSchedulerRef scheduler;
 
+  /// items in scheduler; updated under shard_lock, read without it
+  std::atomic<uint32_t> queue_depth = {0};
+  /// items dequeued by threads of other shards (work stealing)
+  std::atomic<uint64_t> num_stolen = {0};
+
   bool stop_waiting = false;
 
   ContextQueue context_queue;
@@ -1121,11 +1149,18 @@ protected:
   bool store_is_rotational = true;
   bool journal_is_rotational = true;
 
+  // device utilization sampled by update_scrub_device_load()
+  std::set<std::string> scrub_load_devices;
+  std::map<std::string, uint64_t> last_io_ticks;  ///< dev -> io_ticks (ms)
+  ceph::mono_time last_io_ticks_stamp;
+
   ZTracer::Endpoint trace_endpoint;
   PerfCounters* create_logger();
   PerfCounters* create_recoverystate_perf();
   void tick();
   void tick_without_osd_lock();
+  void recalibrate_op_cost_model();
+  void update_scrub_device_load();
   void _dispatch(Message *m);
   void dispatch_op(OpRequestRef op);
 
@@ -1242,6 +1277,9 @@ private:
 
   // -- config settings --
   float m_osd_pg_epoch_max_lag_factor;
+  /// queue depth at which idle shard threads steal work; 0 disables
+  std::atomic<uint32_t> op_queue_steal_threshold;
+  std::atomic<double> op_queue_steal_interval;
 
   // -- superblock --
   OSDSuperblock superblock;
@@ -1606,6 +1644,9 @@ protected:
       OSDShardPGSlot *slot,
       OpSchedulerItem&& qi);
 
+    /// pick the most backlogged other shard and return it locked
+    OSDShard *_lock_steal_victim(uint32_t shard_index);
+
     /// try to do some work
     void _process(uint32_t thread_index, ceph::heartbeat_handle_d *hb) override;
 
@@ -1644,6 +1685,8 @@ protected:
 
 	std::scoped_lock l{sdata->shard_lock};
 	f->open_object_section(queue_name);
+	f->dump_unsigned("queue_depth", sdata->queue_depth);
+	f->dump_unsigned("num_stolen", sdata->num_stolen);
 	sdata->scheduler->dump(*f);
 	f->close_section();
       }
@@ -1911,6 +1954,7 @@ protected:
   void handle_pg_notify_nopg(const MNotifyRec& q);
   void handle_fast_pg_info(MOSDPGInfo *m);
   void handle_fast_pg_remove(MOSDPGRemove *m);
+  void handle_fast_repop_batch(MOSDRepOpBatch *m);
 
 public:
   // used by OSDShard
@@ -1934,7 +1978,11 @@ protected:
   bool scrub_random_backoff();
 
   // -- status reporting --
-  MPGStats *collect_pg_stats();
+  MPGStats *collect_pg_stats(bool full);
+  // what we last told the mgr about each primary pg; only touched by
+  // collect_pg_stats(), which MgrClient serializes
+  std::map<pg_t, std::pair<epoch_t, version_t>> last_sent_pg_stats;
+  unsigned pg_stats_reports_since_full = 0;
   std::vector<DaemonHealthMetric> get_health_metrics();
 
 
@@ -1962,6 +2010,7 @@ private:
     case MSG_OSD_RECOVERY_RESERVE:
     case MSG_OSD_REPOP:
     case MSG_OSD_REPOPREPLY:
+    case MSG_OSD_REPOP_BATCH:
     case MSG_OSD_PG_PUSH:
     case MSG_OSD_PG_PULL:
     case MSG_OSD_PG_PUSH_REPLY:
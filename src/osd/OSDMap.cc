@@ -1397,6 +1397,9 @@ void OSDMap::get_blocklist(std::set<entity_addr_t> *bl) const
 void OSDMap::set_max_osd(int m)
 {
   max_osd = m;
+  _unshare(osd_addrs);
+  _unshare(osd_uuid);
+  _unshare(osd_primary_affinity);
   osd_state.resize(max_osd, 0);
   osd_weight.resize(max_osd, CEPH_OSD_OUT);
   osd_info.resize(max_osd);
@@ -1788,6 +1791,11 @@ void OSDMap::dedup(const OSDMap *o, OSDMap *n)
   if (o->osd_uuid->size() == n->osd_uuid->size() &&
       *o->osd_uuid == *n->osd_uuid)
     n->osd_uuid = o->osd_uuid;
+
+  // does primary affinity match?
+  if (o->osd_primary_affinity && n->osd_primary_affinity &&
+      *o->osd_primary_affinity == *n->osd_primary_affinity)
+    n->osd_primary_affinity = o->osd_primary_affinity;
 }
 
 void OSDMap::clean_temps(CephContext *cct,
@@ -2084,7 +2092,22 @@ int OSDMap::apply_incremental(const Incremental &inc)
     return 0;
   }
 
-  // nope, incremental.
+  // nope, incremental.  unshare whatever it is about to modify; the
+  // rest stays shared with the map we were copied from.
+  if (!inc.new_state.empty() || !inc.new_up_client.empty() ||
+      !inc.new_up_cluster.empty()) {
+    _unshare(osd_addrs);
+  }
+  if (!inc.new_state.empty() || !inc.new_uuid.empty()) {
+    _unshare(osd_uuid);
+  }
+  if (!inc.new_pg_temp.empty()) {
+    _unshare(pg_temp);
+  }
+  if (!inc.new_primary_temp.empty()) {
+    _unshare(primary_temp);
+  }
+
   if (inc.new_flags >= 0) {
     flags = inc.new_flags;
     // the below is just to cover a newly-upgraded luminous mon
@@ -2389,6 +2412,25 @@ int OSDMap::map_to_pg(
   return 0;
 }
 
+int OSDMap::map_to_pgs(
+  int64_t poolid,
+  const vector<string>& names,
+  const string& nspace,
+  vector<pg_t> *pgs) const
+{
+  const pg_pool_t *pool = get_pg_pool(poolid);
+  if (!pool)
+    return -ENOENT;
+  vector<uint32_t> ps;
+  pool->hash_keys(names, nspace, &ps);
+  pgs->clear();
+  pgs->reserve(ps.size());
+  for (auto p : ps) {
+    pgs->emplace_back(p, poolid);
+  }
+  return 0;
+}
+
 int OSDMap::object_locator_to_pg(
   const object_t& oid, const object_locator_t& loc, pg_t &pg) const
 {
@@ -3131,6 +3173,22 @@ void OSDMap::decode(ceph::buffer::list& bl)
   decode(p);
 }
 
+void OSDMap::_unshare_for_decode()
+{
+  // decode fills these in place; don't scribble over another map's
+  // copy.  the contents are about to be replaced, so don't copy them.
+  if (osd_addrs.use_count() > 1)
+    osd_addrs = std::make_shared<addrs_s>();
+  if (pg_temp.use_count() > 1)
+    pg_temp = std::make_shared<PGTempMap>();
+  if (primary_temp.use_count() > 1)
+    primary_temp = std::make_shared<mempool::osdmap::map<pg_t,int32_t>>();
+  if (osd_uuid.use_count() > 1)
+    osd_uuid = std::make_shared<mempool::osdmap::vector<uuid_d>>();
+  if (crush.use_count() > 1)
+    crush = std::make_shared<CrushWrapper>();
+}
+
 void OSDMap::decode_classic(ceph::buffer::list::const_iterator& p)
 {
   using ceph::decode;
@@ -3266,6 +3324,8 @@ void OSDMap::decode(ceph::buffer::list::const_iterator& bl)
   size_t tail_offset = 0;
   ceph::buffer::list crc_front, crc_tail;
 
+  _unshare_for_decode();
+
   DECODE_START_LEGACY_COMPAT_LEN(8, 7, 7, bl); // wrapper
   if (struct_v < 7) {
     bl.seek(start_offset);
@@ -651,6 +651,14 @@ private:
 private:
   OSDMap(const OSDMap& other) = default;
   OSDMap& operator=(const OSDMap& other) = default;
+
+  /// give this map a private copy of p if it is shared with another map
+  template <typename T>
+  static void _unshare(std::shared_ptr<T>& p) {
+    if (p && p.use_count() > 1)
+      p.reset(new T(*p));
+  }
+  void _unshare_for_decode();
 public:
 
   /// return feature mask subset that is relevant to OSDMap encoding
@@ -676,6 +684,17 @@ public:
     // allocate a new CrushWrapper, though.
   }
 
+  /**
+   * copy o, sharing its pg_temp, primary_temp, osd_addrs, osd_uuid,
+   * osd_primary_affinity and crush with it.  the shared members are
+   * copied on write by apply_incremental() and the other mutators, so
+   * building the next epoch this way only pays for what the
+   * incremental actually touches.
+   */
+  void shallow_copy_from(const OSDMap& o) {
+    *this = o;
+  }
+
   // map info
   const uuid_d& get_fsid() const { return fsid; }
   void set_fsid(uuid_d& f) { fsid = f; }
@@ -789,6 +808,8 @@ public:
       osd_primary_affinity.reset(
 	new mempool::osdmap::vector<__u32>(
 	  max_osd, CEPH_OSD_DEFAULT_PRIMARY_AFFINITY));
+    else
+      _unshare(osd_primary_affinity);
     (*osd_primary_affinity)[o] = w;
   }
   unsigned get_primary_affinity(int o) const {
@@ -1109,6 +1130,12 @@ public:
     const std::string& key,
     const std::string& nspace,
     pg_t *pg) const;
+  /// map_to_pg() for many objects in one pool and namespace at once
+  int map_to_pgs(
+    int64_t pool,
+    const std::vector<std::string>& names,
+    const std::string& nspace,
+    std::vector<pg_t> *pgs) const;
   int object_locator_to_pg(const object_t& oid, const object_locator_t& loc,
 			   pg_t &pg) const;
   pg_t object_locator_to_pg(const object_t& oid,
@@ -67,7 +67,7 @@ void OpRequest::_dump(Formatter *f) const
 
   {
     f->open_array_section("events");
-    std::lock_guard l(lock);
+    auto events = get_events();
 
     for (auto i = events.begin(); i != events.end(); ++i) {
       f->open_object_section("event");
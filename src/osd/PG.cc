@@ -771,6 +771,7 @@ void PG::send_cluster_message(
   if (share_map_update) {
     osd->maybe_share_map(con.get(), get_osdmap());
   }
+  get_pgbackend()->flush_repop_batch();
   osd->send_message_osd_cluster(m, con.get());
 }
 
@@ -2257,7 +2258,8 @@ bool PG::can_discard_op(OpRequestRef& op)
   }
 
   if ((m->get_flags() & (CEPH_OSD_FLAG_BALANCE_READS |
-			 CEPH_OSD_FLAG_LOCALIZE_READS)) &&
+			 CEPH_OSD_FLAG_LOCALIZE_READS |
+			 CEPH_OSD_FLAG_EC_SHARD_READ)) &&
       !is_primary() &&
       m->get_map_epoch() < info.history.same_interval_since) {
     // Note: the Objecter will resend on interval change without the primary
@@ -686,6 +686,7 @@ public:
   virtual int get_cache_obj_count() = 0;
 
   virtual void snap_trimmer(epoch_t epoch_queued) = 0;
+  virtual void flush_repop_batch(epoch_t epoch_queued) = 0;
   virtual void do_command(
     const std::string_view& prefix,
     const cmdmap_t& cmdmap,
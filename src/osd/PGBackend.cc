@@ -634,7 +634,7 @@ int PGBackend::be_scan_list(
 	poid, ghobject_t::NO_GEN, get_parent()->whoami_shard().shard),
       o.attrs);
 
-    if (pos.deep) {
+    if (pos.deep && !be_deep_scrub_unchanged(poid, pos, o)) {
       r = be_deep_scrub(poid, map, pos, o);
     }
     dout(25) << __func__ << "  " << poid << dendl;
@@ -657,6 +657,36 @@ int PGBackend::be_scan_list(
   return 0;
 }
 
+bool PGBackend::be_deep_scrub_unchanged(
+  const hobject_t &poid,
+  const ScrubMapBuilder &pos,
+  const ScrubMap::object &o)
+{
+  if (pos.deep_since == eversion_t()) {
+    return false;
+  }
+  auto k = o.attrs.find(OI_ATTR);
+  if (k == o.attrs.end()) {
+    return false;
+  }
+  bufferlist bl;
+  bl.push_back(k->second);
+  object_info_t oi;
+  try {
+    auto p = bl.cbegin();
+    decode(oi, p);
+  } catch (ceph::buffer::error&) {
+    // let the deep scrub and the comparison sort it out
+    return false;
+  }
+  if (oi.version > pos.deep_since) {
+    return false;
+  }
+  dout(20) << __func__ << " " << poid << " at " << oi.version
+	   << ", not written since " << pos.deep_since << dendl;
+  return true;
+}
+
 bool PGBackend::be_compare_scrub_objects(
   pg_shard_t auth_shard,
   const ScrubMap::object &auth,
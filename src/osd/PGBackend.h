@@ -262,6 +262,13 @@ typedef std::shared_ptr<const OSDMap> OSDMapRef;
      virtual void schedule_recovery_work(
        GenContext<ThreadPool::TPHandle&> *c) = 0;
 
+     /// queue a flush_repop_batch() under the pg lock after delay
+     virtual void schedule_repop_batch_flush(ceph::timespan delay) = 0;
+
+     /// a local store op of @bytes took @latency to commit
+     virtual void record_store_op_cost(
+       uint64_t bytes, ceph::timespan latency) = 0;
+
      virtual pg_shard_t whoami_shard() const = 0;
      int whoami() const {
        return whoami_shard().osd;
@@ -413,6 +420,14 @@ typedef std::shared_ptr<const OSDMap> OSDMapRef;
    virtual void on_change() = 0;
    virtual void clear_recovery_state() = 0;
 
+   /**
+    * send any sub ops held back for batching
+    *
+    * Called before anything else is sent to our peers, so that sub ops
+    * never arrive out of order with respect to other pg messages.
+    */
+   virtual void flush_repop_batch() {}
+
    virtual IsPGRecoverablePredicate *get_is_recoverable_predicate() const = 0;
    virtual IsPGReadablePredicate *get_is_readable_predicate() const = 0;
    virtual int get_ec_data_chunk_count() const { return 0; };
@@ -584,6 +599,11 @@ typedef std::shared_ptr<const OSDMap> OSDMapRef;
    int be_scan_list(
      ScrubMap &map,
      ScrubMapBuilder &pos);
+   /// true if an incremental deep scrub can skip reading poid
+   bool be_deep_scrub_unchanged(
+     const hobject_t &poid,
+     const ScrubMapBuilder &pos,
+     const ScrubMap::object &o);
    bool be_compare_scrub_objects(
      pg_shard_t auth_shard,
      const ScrubMap::object &auth,
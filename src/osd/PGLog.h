@@ -189,6 +189,9 @@ public:
 	  break;
 	}
 	f(*rollback_info_trimmed_to_riter);
+	// the entry can no longer be rolled back, so its encoded
+	// rollback info is dead weight for the rest of its life in the log
+	rollback_info_trimmed_to_riter->mark_unrollbackable();
       }
 
       return dirty_log;
@@ -3968,6 +3968,17 @@ void PeeringState::dump_peering_state(Formatter *f)
     f->close_section();
   }
   f->close_section();
+
+  f->open_object_section("pg_log");
+  const auto& log = pg_log.get_log();
+  uint64_t mem_bytes = log.get_approx_mem_usage();
+  f->dump_unsigned("entries", log.log.size());
+  f->dump_unsigned("dups", log.dups.size());
+  f->dump_unsigned("approx_mem_bytes", mem_bytes);
+  f->dump_unsigned(
+    "approx_mem_bytes_per_entry",
+    log.log.empty() ? 0 : mem_bytes / log.log.size());
+  f->close_section();
 }
 
 void PeeringState::update_stats(
@@ -4950,6 +4961,8 @@ void PeeringState::Peering::exit()
 
   utime_t dur = ceph_clock_now() - enter_time;
   pl->get_peering_perf().tinc(rs_peering_latency, dur);
+  pl->get_peering_perf().hinc(rs_peering_latency_hist, dur.to_nsec(),
+			      log_queries);
 }
 
 
@@ -6899,6 +6912,7 @@ PeeringState::GetLog::GetLog(my_context ctx)
       auth_log_shard.shard, ps->pg_whoami.shard,
       request_log_from, ps->info.history,
       ps->get_osdmap_epoch()));
+  ++context< Peering >().log_queries;
 
   ceph_assert(ps->blocked_by.empty());
   ps->blocked_by.insert(auth_log_shard.osd);
@@ -7191,6 +7205,20 @@ void PeeringState::Incomplete::exit()
 }
 
 /*------GetMissing--------*/
+/// true if a peer whose log ends at @v holds a prefix of @log
+static bool log_has_version(const pg_log_t& log, eversion_t v)
+{
+  if (v == log.tail) {
+    return true;
+  }
+  for (auto p = log.log.rbegin(); p != log.log.rend() && p->version >= v; ++p) {
+    if (p->version == v) {
+      return true;
+    }
+  }
+  return false;
+}
+
 PeeringState::GetMissing::GetMissing(my_context ctx)
   : my_base(ctx),
     NamedState(context< PeeringMachine >().state_history, "Started/Primary/Peering/GetMissing")
@@ -7230,13 +7258,25 @@ PeeringState::GetMissing::GetMissing(my_context ctx)
 	pi.last_update == ps->info.last_update) {  // peer is up to date
       // replica has no missing and identical log as us.  no need to
       // pull anything.
-      // FIXME: we can do better here.  if last_update==last_complete we
-      //        can infer the rest!
       psdout(10) << " osd." << *i << " has no missing, identical log" << dendl;
       ps->peer_missing[*i].clear();
       continue;
     }
 
+    if (pi.last_update == pi.last_complete &&  // peer has no missing
+	pi.last_backfill.is_max() &&
+	log_has_version(ps->pg_log.get_log(), pi.last_update)) {
+      // replica has no missing and its log is a prefix of ours (an
+      // eversion names a single entry), so nothing is divergent and it
+      // is missing exactly what our log has after its last_update.
+      // activate() adds those to peer_missing as it sends them.
+      psdout(10) << " osd." << *i << " has no missing, log is a prefix of"
+		 << " ours up to " << pi.last_update << dendl;
+      ps->peer_missing[*i].clear();
+      pl->get_peering_perf().inc(rs_getmissing_inferred);
+      continue;
+    }
+
     // We pull the log from the peer's last_epoch_started to ensure we
     // get enough log to detect divergent updates.
     since.epoch = pi.last_epoch_started;
@@ -7262,6 +7302,7 @@ PeeringState::GetMissing::GetMissing(my_context ctx)
     }
     peer_missing_requested.insert(*i);
     ps->blocked_by.insert(i->osd);
+    ++context< Peering >().log_queries;
   }
 
   if (peer_missing_requested.empty()) {
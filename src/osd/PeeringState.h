@@ -812,6 +812,7 @@ public:
   struct Peering : boost::statechart::state< Peering, Primary, GetInfo >, NamedState {
     PastIntervals::PriorSet prior_set;
     bool history_les_bound;  //< need osd_find_best_info_ignore_history_les
+    unsigned log_queries = 0;  //< log/missing queries sent to peers
 
     explicit Peering(my_context ctx);
     void exit();
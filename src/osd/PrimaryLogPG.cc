@@ -532,6 +532,11 @@ void PrimaryLogPG::schedule_recovery_work(
   osd->queue_recovery_context(this, c);
 }
 
+void PrimaryLogPG::schedule_repop_batch_flush(ceph::timespan delay)
+{
+  osd->queue_for_repop_batch_flush(this, delay);
+}
+
 void PrimaryLogPG::replica_clear_repop_obc(
   const vector<pg_log_entry_t> &logv,
   ObjectStore::Transaction &t)
@@ -1613,6 +1618,85 @@ void PrimaryLogPG::do_pg_op(OpRequestRef op)
   osd->send_message_osd_client(reply, m->get_connection());
 }
 
+/*
+ * A client reading an erasure coded object straight from the shards.
+ * Each shard returns its own chunks as they are on disk, with the
+ * object size and version, and the client reassembles the object.
+ * Anything that would need the primary is bounced with EAGAIN; the
+ * client then falls back to a normal read.
+ */
+void PrimaryLogPG::do_ec_shard_read(OpRequestRef op)
+{
+  MOSDOp *m = static_cast<MOSDOp*>(op->get_nonconst_req());
+  const hobject_t &soid = m->get_hobj();
+  dout(10) << __func__ << " " << soid << " " << m->ops << dendl;
+
+  if (!pool.info.is_erasure() || soid.snap != CEPH_NOSNAP) {
+    osd->reply_op_error(op, -EINVAL);
+    return;
+  }
+  for (auto &osd_op : m->ops) {
+    if (osd_op.op.op != CEPH_OSD_OP_READ &&
+	osd_op.op.op != CEPH_OSD_OP_STAT) {
+      osd->reply_op_error(op, -EINVAL);
+      return;
+    }
+  }
+
+  // what the shards return is combined without the primary, so a write
+  // that may still be rolled back must not be visible
+  const PGLog &pg_log = recovery_state.get_pg_log();
+  if (is_missing_object(soid) ||
+      pg_log.get_log().has_write_since(soid, pg_log.get_can_rollback_to())) {
+    dout(20) << __func__ << " " << soid << " is missing or being written"
+	     << ", bouncing to primary" << dendl;
+    osd->reply_op_error(op, -EAGAIN);
+    return;
+  }
+
+  ghobject_t goid(soid, ghobject_t::NO_GEN, pg_whoami.shard);
+  bufferlist bv;
+  int result = osd->store->getattr(ch, goid, OI_ATTR, bv);
+  if (result < 0) {
+    osd->reply_op_error(op, result);
+    return;
+  }
+  object_info_t oi(bv);
+  if (oi.is_whiteout()) {
+    osd->reply_op_error(op, -ENOENT);
+    return;
+  }
+
+  uint64_t bytes_read = 0;
+  for (auto &osd_op : m->ops) {
+    if (osd_op.op.op == CEPH_OSD_OP_STAT) {
+      encode(oi.size, osd_op.outdata);
+      encode(oi.mtime, osd_op.outdata);
+      continue;
+    }
+    // the extent is in chunk offsets of this shard
+    result = osd->store->read(ch, goid,
+			      osd_op.op.extent.offset,
+			      osd_op.op.extent.length,
+			      osd_op.outdata,
+			      osd_op.op.flags);
+    if (result < 0) {
+      osd->reply_op_error(op, result);
+      return;
+    }
+    osd_op.op.extent.length = result;
+    osd_op.rval = result;
+    bytes_read += result;
+  }
+  log_op_stats(*op, 0, bytes_read);
+
+  MOSDOpReply *reply = new MOSDOpReply(m, 0, get_osdmap_epoch(),
+				       CEPH_OSD_FLAG_ACK | CEPH_OSD_FLAG_ONDISK,
+				       false);
+  reply->set_reply_versions(oi.version, oi.user_version);
+  osd->send_message_osd_client(reply, m->get_connection());
+}
+
 int PrimaryLogPG::do_scrub_ls(const MOSDOp *m, OSDOp *osd_op)
 {
   if (m->get_pg() != info.pgid.pgid) {
@@ -1747,7 +1831,9 @@ PrimaryLogPG::PrimaryLogPG(OSDService *o, OSDMapRef curmap,
   pgbackend(
     PGBackend::build_pg_backend(
       _pool.info, ec_profile, this, coll_t(p), ch, o->store, cct)),
-  object_contexts(o->cct, o->cct->_conf->osd_pg_object_context_cache_count),
+  object_contexts(o->cct, o->cct->_conf->osd_pg_object_context_cache_count,
+		  o->cct->_conf.get_val<uint64_t>(
+		    "osd_pg_object_context_cache_shards")),
   new_backfill(false),
   temp_seq(0),
   snap_trimmer_machine(this)
@@ -2033,7 +2119,8 @@ void PrimaryLogPG::do_op(OpRequestRef& op)
   }
 
   if ((m->get_flags() & (CEPH_OSD_FLAG_BALANCE_READS |
-			 CEPH_OSD_FLAG_LOCALIZE_READS)) &&
+			 CEPH_OSD_FLAG_LOCALIZE_READS |
+			 CEPH_OSD_FLAG_EC_SHARD_READ)) &&
       op->may_read() &&
       !(op->may_write() || op->may_cache())) {
     // balanced reads; any replica will do
@@ -2180,6 +2267,11 @@ void PrimaryLogPG::do_op(OpRequestRef& op)
     auto do_op_span = jaeger_tracing::child_span(__func__, op->osd_parent_span);
   }
 #endif
+  if (m->has_flag(CEPH_OSD_FLAG_EC_SHARD_READ)) {
+    do_ec_shard_read(op);
+    return;
+  }
+
   // missing object?
   if (is_unreadable_object(head)) {
     if (!is_primary()) {
@@ -4384,6 +4476,8 @@ void PrimaryLogPG::log_op_stats(const OpRequest& op,
   osd->logger->inc(l_osd_op_inb, inb);
   osd->logger->tinc(l_osd_op_lat, latency);
   osd->logger->tinc(l_osd_op_process_lat, process_latency);
+  osd->logger->hinc(l_osd_op_lat_scrub_hist, latency.to_nsec(),
+		    osd->get_scrub_services().get_active_scrubs());
 
   if (op.may_read() && op.may_write()) {
     osd->logger->inc(l_osd_op_rw);
@@ -4933,6 +5027,15 @@ void PrimaryLogPG::snap_trimmer(epoch_t queued)
   return;
 }
 
+void PrimaryLogPG::flush_repop_batch(epoch_t queued)
+{
+  if (pg_has_reset_since(queued)) {
+    // on_change() already dropped the batch this flush was queued for
+    return;
+  }
+  pgbackend->flush_repop_batch();
+}
+
 namespace {
 
 template<typename U, typename V>
@@ -11531,6 +11634,7 @@ void PrimaryLogPG::submit_log_entries(
 	recovery_state.get_min_last_complete_ondisk());
 
       set<pg_shard_t> waiting_on;
+      pgbackend->flush_repop_batch();
       for (set<pg_shard_t>::const_iterator i = get_acting_recovery_backfill().begin();
 	   i != get_acting_recovery_backfill().end();
 	   ++i) {
@@ -13860,6 +13964,7 @@ uint64_t PrimaryLogPG::recover_backfill(
 	  MOSDPGScan::OP_SCAN_GET_DIGEST, pg_whoami, e, get_last_peering_reset(),
 	  spg_t(info.pgid.pgid, bt.shard),
 	  pbi.end, hobject_t());
+	pgbackend->flush_repop_batch();
 	osd->send_message_osd_cluster(bt.osd, m, get_osdmap_epoch());
 	ceph_assert(waiting_on_backfill.find(bt) == waiting_on_backfill.end());
 	waiting_on_backfill.insert(bt);
@@ -14033,6 +14138,7 @@ uint64_t PrimaryLogPG::recover_backfill(
     if (oid <= last_backfill_started)
       pending_backfill_updates[oid]; // add empty stat!
   }
+  pgbackend->flush_repop_batch();
   for (auto p : reqs) {
     osd->send_message_osd_cluster(p.first.osd, p.second,
 				  get_osdmap_epoch());
@@ -14111,6 +14217,7 @@ uint64_t PrimaryLogPG::recover_backfill(
       }
       m->last_backfill = pinfo.last_backfill;
       m->stats = pinfo.stats;
+      pgbackend->flush_repop_batch();
       osd->send_message_osd_cluster(bt.osd, m, get_osdmap_epoch());
       dout(10) << " peer " << bt
 	       << " num_objects now " << pinfo.stats.stats.sum.num_objects
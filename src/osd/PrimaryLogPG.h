@@ -353,6 +353,7 @@ public:
     GenContext<ThreadPool::TPHandle&> *c) override;
 
   void send_message(int to_osd, Message *m) override {
+    pgbackend->flush_repop_batch();
     osd->send_message_osd_cluster(to_osd, m, get_osdmap_epoch());
   }
   void queue_transaction(ObjectStore::Transaction&& t,
@@ -546,6 +547,10 @@ public:
 
   void schedule_recovery_work(
     GenContext<ThreadPool::TPHandle&> *c) override;
+  void schedule_repop_batch_flush(ceph::timespan delay) override;
+  void record_store_op_cost(uint64_t bytes, ceph::timespan latency) override {
+    osd->op_cost_model.add_sample(bytes, latency);
+  }
 
   pg_shard_t whoami_shard() const override {
     return pg_whoami;
@@ -564,18 +569,22 @@ public:
   }
   void send_message_osd_cluster(
     int peer, Message *m, epoch_t from_epoch) override {
+    pgbackend->flush_repop_batch();
     osd->send_message_osd_cluster(peer, m, from_epoch);
   }
   void send_message_osd_cluster(
     std::vector<std::pair<int, Message*>>& messages, epoch_t from_epoch) override {
+    pgbackend->flush_repop_batch();
     osd->send_message_osd_cluster(messages, from_epoch);
   }
   void send_message_osd_cluster(
     MessageRef m, Connection *con) override {
+    pgbackend->flush_repop_batch();
     osd->send_message_osd_cluster(m, con);
   }
   void send_message_osd_cluster(
     Message *m, const ConnectionRef& con) override {
+    pgbackend->flush_repop_batch();
     osd->send_message_osd_cluster(m, con);
   }
   ConnectionRef get_con_osd_cluster(int peer, epoch_t from_epoch) override;
@@ -997,7 +1006,7 @@ protected:
   bool already_complete(eversion_t v);
 
   // projected object info
-  SharedLRU<hobject_t, ObjectContext> object_contexts;
+  SharedIntrusiveLRU<hobject_t, ObjectContext> object_contexts;
   // std::map from oid.snapdir() to SnapSetContext *
   std::map<hobject_t, SnapSetContext*> snapset_contexts;
   ceph::mutex snapset_contexts_lock =
@@ -1498,6 +1507,7 @@ public:
 			  MOSDOpReply *orig_reply, int r,
 			  OpContext *ctx_for_op_returns=nullptr);
   void do_pg_op(OpRequestRef op);
+  void do_ec_shard_read(OpRequestRef op);
   void do_scan(
     OpRequestRef op,
     ThreadPool::TPHandle &handle);
@@ -1509,6 +1519,7 @@ public:
   int trim_object(bool first, const hobject_t &coid, snapid_t snap_to_trim,
 		  OpContextUPtr *ctxp);
   void snap_trimmer(epoch_t e) override;
+  void flush_repop_batch(epoch_t e) override;
   void kick_snap_trim() override;
   void snap_trimmer_scrub_complete() override;
   int do_osd_ops(OpContext *ctx, std::vector<OSDOp>& ops);
@@ -16,6 +16,7 @@
 #include "messages/MOSDOp.h"
 #include "messages/MOSDRepOp.h"
 #include "messages/MOSDRepOpReply.h"
+#include "messages/MOSDRepOpBatch.h"
 #include "messages/MOSDPGPush.h"
 #include "messages/MOSDPGPull.h"
 #include "messages/MOSDPGPushReply.h"
@@ -257,6 +258,11 @@ void ReplicatedBackend::on_change()
     op.second->on_commit = nullptr;
   }
   in_progress_ops.clear();
+  // the ops these belong to were just dropped as well
+  repop_batch.clear();
+  repop_batch_ops = 0;
+  repop_batch_flush_queued = false;
+  repop_batch_peers.clear();
   clear_recovery_state();
 }
 
@@ -540,6 +546,9 @@ void ReplicatedBackend::submit_transaction(
     parent->bless_context(
       new C_OSD_OnOpCommit(this, &op)));
 
+  op.bytes = op_t.get_num_bytes();
+  op.submitted = ceph::mono_clock::now();
+
   vector<ObjectStore::Transaction> tls;
   tls.push_back(std::move(op_t));
 
@@ -564,6 +573,8 @@ void ReplicatedBackend::op_commit(const ceph::ref_t<InProgressOp>& op)
     op->op->pg_trace.event("op commit");
   }
 
+  get_parent()->record_store_op_cost(
+    op->bytes, ceph::mono_clock::now() - op->submitted);
   op->waiting_for_commit.erase(get_parent()->whoami_shard());
 
   if (op->waiting_for_commit.empty()) {
@@ -1016,6 +1027,7 @@ void ReplicatedBackend::issue_op(
     bufferlist logs;
     encode(log_entries, logs);
 
+    bool batch = should_batch_repops();
     for (const auto& shard : get_parent()->get_acting_recovery_backfill_shards()) {
       if (shard == parent->whoami_shard()) continue;
       const pg_info_t &pinfo = parent->get_shard_info().find(shard)->second;
@@ -1037,9 +1049,83 @@ void ReplicatedBackend::issue_op(
 	  pinfo);
       if (op->op && op->op->pg_trace)
 	wr->trace.init("replicated op", nullptr, &op->op->pg_trace);
-      get_parent()->send_message_osd_cluster(
+      if (batch && can_batch_repops_to(shard)) {
+	repop_batch[shard].push_back(MessageRef(wr, false));
+      } else {
+	get_parent()->send_message_osd_cluster(
 	  shard.osd, wr, get_osdmap_epoch());
+      }
+    }
+
+    if (batch) {
+      ++repop_batch_ops;
+      if (repop_batch_ops >=
+	  cct->_conf.get_val<uint64_t>("osd_repop_batch_max_ops")) {
+	flush_repop_batch();
+      } else if (!repop_batch_flush_queued) {
+	repop_batch_flush_queued = true;
+	get_parent()->schedule_repop_batch_flush(
+	  ceph::make_timespan(
+	    cct->_conf.get_val<double>("osd_repop_batch_window")));
+      }
+    }
+  }
+}
+
+bool ReplicatedBackend::should_batch_repops() const
+{
+  return cct->_conf.get_val<uint64_t>("osd_repop_batch_max_ops") > 1;
+}
+
+bool ReplicatedBackend::can_batch_repops_to(pg_shard_t shard)
+{
+  // a peer that does not know MOSDRepOpBatch drops it, and the writes
+  // in it would never be acked.  A peer's features only change when it
+  // restarts, which starts a new interval, so look each one up once.
+  auto p = repop_batch_peers.find(shard);
+  if (p == repop_batch_peers.end()) {
+    bool can_batch = HAVE_FEATURE(
+      get_osdmap()->get_xinfo(shard.osd).features, OSD_REPOP_BATCH);
+    p = repop_batch_peers.emplace(shard, can_batch).first;
+  }
+  return p->second;
+}
+
+void ReplicatedBackend::flush_repop_batch()
+{
+  repop_batch_flush_queued = false;
+  if (repop_batch.empty()) {
+    return;
+  }
+  // sending goes back through the listener, which flushes us again
+  auto batch = std::move(repop_batch);
+  repop_batch.clear();
+  dout(20) << __func__ << " " << repop_batch_ops << " ops to "
+	   << batch.size() << " peers" << dendl;
+  repop_batch_ops = 0;
+
+  auto logger = get_parent()->get_logger();
+  for (auto& [shard, msgs] : batch) {
+    Message *m;
+    if (msgs.size() == 1) {
+      m = msgs.front().detach();
+    } else {
+      std::vector<ceph::ref_t<MOSDRepOp>> repops;
+      repops.reserve(msgs.size());
+      for (auto& msg : msgs) {
+	repops.push_back(boost::static_pointer_cast<MOSDRepOp>(msg));
+      }
+      m = new MOSDRepOpBatch(
+	spg_t(get_info().pgid.pgid, shard.shard),
+	get_osdmap_epoch(),
+	parent->get_last_peering_reset_epoch(),
+	std::move(repops));
+      m->set_priority(msgs.front()->get_priority());
     }
+    logger->inc(l_osd_repop_batch);
+    logger->inc(l_osd_repop_batch_size, msgs.size());
+    get_parent()->send_message_osd_cluster(
+      shard.osd, m, get_osdmap_epoch());
   }
 }
 
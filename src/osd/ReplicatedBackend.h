@@ -339,6 +339,8 @@ private:
     Context *on_commit;
     OpRequestRef op;
     eversion_t v;
+    ceph::mono_time submitted;  ///< when the local transaction was queued
+    uint64_t bytes = 0;         ///< size of the local transaction
     bool done() const {
       return waiting_for_commit.empty();
     }
@@ -350,9 +352,20 @@ private:
 	op(op), v(v) {}
   };
   std::map<ceph_tid_t, ceph::ref_t<InProgressOp>> in_progress_ops;
+
+  /// rep ops held back for each peer, to be sent as one MOSDRepOpBatch
+  std::map<pg_shard_t, std::vector<MessageRef>> repop_batch;
+  unsigned repop_batch_ops = 0;  ///< client ops in repop_batch
+  bool repop_batch_flush_queued = false;
+  /// whether each peer takes MOSDRepOpBatch, cached for this interval
+  std::map<pg_shard_t, bool> repop_batch_peers;
+  bool should_batch_repops() const;
+  bool can_batch_repops_to(pg_shard_t shard);
 public:
   friend class C_OSD_OnOpCommit;
 
+  void flush_repop_batch() override;
+
   void call_write_ordered(std::function<void(void)> &&cb) override {
     // ReplicatedBackend submits writes inline in submit_transaction, so
     // we can just call the callback.
@@ -4,6 +4,7 @@
 #ifndef CEPH_OSD_INTERNAL_TYPES_H
 #define CEPH_OSD_INTERNAL_TYPES_H
 
+#include "common/shared_intrusive_lru.h"
 #include "osd_types.h"
 #include "OpRequest.h"
 #include "object_state.h"
@@ -28,7 +29,7 @@ struct SnapSetContext {
 struct ObjectContext;
 typedef std::shared_ptr<ObjectContext> ObjectContextRef;
 
-struct ObjectContext {
+struct ObjectContext : public SharedIntrusiveLRUItem<hobject_t, ObjectContext> {
   ObjectState obs;
 
   SnapSetContext *ssc;  // may be null
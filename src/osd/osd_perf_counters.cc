@@ -148,6 +148,13 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_time_avg(
     l_osd_sop_push_lat, "subop_push_latency", "Suboperations push latency");
 
+  osd_plb.add_u64_counter(
+    l_osd_repop_batch, "repop_batch",
+    "Replicated write batches sent to replicas");
+  osd_plb.add_u64_avg(
+    l_osd_repop_batch_size, "repop_batch_size",
+    "Replicated writes per batch sent to a replica");
+
   osd_plb.add_u64_counter(l_osd_pull, "pull", "Pull requests sent");
   osd_plb.add_u64_counter(l_osd_push, "push", "Push messages sent");
   osd_plb.add_u64_counter(l_osd_push_outb, "push_out_bytes", "Pushed size", NULL, 0, unit_t(UNIT_BYTES));
@@ -161,6 +168,49 @@ PerfCounters *build_osd_logger(CephContext *cct) {
    l_osd_rbytes, "recovery_bytes",
    "recovery bytes",
    "rbt", PerfCountersBuilder::PRIO_INTERESTING);
+  osd_plb.add_u64(
+    l_osd_rbytes_rate, "recovery_bytes_per_sec",
+    "Recovery bytes per second over the last tick", NULL, 0,
+    unit_t(UNIT_BYTES));
+  osd_plb.add_u64(
+    l_osd_recovery_active_limit, "recovery_active_limit",
+    "Recovery operations allowed at once");
+  osd_plb.add_u64_counter(
+    l_osd_ec_recovery_read_bytes, "ec_recovery_read_bytes",
+    "Bytes read from helper shards to rebuild erasure coded shards",
+    NULL, 0, unit_t(UNIT_BYTES));
+  osd_plb.add_u64_counter(
+    l_osd_ec_recovery_rebuilt_bytes, "ec_recovery_rebuilt_bytes",
+    "Bytes of erasure coded shards rebuilt by recovery",
+    NULL, 0, unit_t(UNIT_BYTES));
+  osd_plb.add_u64_counter(
+    l_osd_ec_recovery_subchunk_reads, "ec_recovery_subchunk_reads",
+    "Shard reads for recovery that only fetched some sub-chunks");
+
+  osd_plb.add_time_avg(
+    l_osd_scrub_lat, "scrub_latency",
+    "Time to complete a shallow scrub of a PG");
+  osd_plb.add_time_avg(
+    l_osd_deep_scrub_lat, "deep_scrub_latency",
+    "Time to complete a deep scrub of a PG");
+  osd_plb.add_u64(
+    l_osd_scrub_device_util, "scrub_device_util",
+    "Busiest device utilization over the last tick (percent)");
+  osd_plb.add_u64(
+    l_osd_scrub_pace, "scrub_pace",
+    "Scrub chunk size as a percentage of osd_scrub_chunk_max");
+  // Scrubs in progress axis configuration for the op latency histogram
+  PerfHistogramCommon::axis_config_d scrubs_hist_y_axis_config{
+    "Scrubs in progress",
+    PerfHistogramCommon::SCALE_LINEAR,
+    0,
+    1,
+    8,
+  };
+  osd_plb.add_u64_counter_histogram(
+    l_osd_op_lat_scrub_hist, "op_latency_scrubs_histogram",
+    op_hist_x_axis_config, scrubs_hist_y_axis_config,
+    "Histogram of client operation latency vs. scrubs in progress");
 
   osd_plb.add_u64(l_osd_loadavg, "loadavg", "CPU load");
   osd_plb.add_u64(
@@ -195,6 +245,9 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_u64_counter(
     l_osd_waiting_for_map, "messages_delayed_for_map",
     "Operations waiting for OSD map");
+  osd_plb.add_u64_counter(
+    l_osd_op_wq_steal, "op_wq_steal",
+    "Work items taken from another shard's queue by an idle shard thread");
 
   osd_plb.add_u64_counter(
     l_osd_map_cache_hit, "osd_map_cache_hit", "osdmap cache hit");
@@ -212,6 +265,12 @@ PerfCounters *build_osd_logger(CephContext *cct) {
   osd_plb.add_u64_counter(
     l_osd_map_bl_cache_miss, "osd_map_bl_cache_miss",
     "OSDMap buffer cache misses");
+  osd_plb.add_u64_counter(
+    l_osd_map_inc_shared, "osd_map_inc_shared",
+    "Incremental OSDMaps applied to the cached previous map");
+  osd_plb.add_time_avg(
+    l_osd_map_apply_lat, "osd_map_apply_lat",
+    "Latency of building a full OSDMap from an incremental");
 
   osd_plb.add_u64(
     l_osd_stat_bytes, "stat_bytes", "OSD size", "size",
@@ -317,5 +376,27 @@ PerfCounters *build_recoverystate_perf(CephContext *cct) {
   rs_perf.add_time_avg(rs_waitupthru_latency, "waitupthru_latency", "Waitupthru recovery state latency");
   rs_perf.add_time_avg(rs_notrecovering_latency, "notrecovering_latency", "Notrecovering recovery state latency");
 
+  PerfHistogramCommon::axis_config_d peering_hist_x_axis_config{
+    "Latency (usec)",
+    PerfHistogramCommon::SCALE_LOG2,
+    0,
+    1000000,                         ///< Quantization unit is 1ms
+    32,
+  };
+  PerfHistogramCommon::axis_config_d peering_hist_y_axis_config{
+    "Log queries",
+    PerfHistogramCommon::SCALE_LINEAR,
+    0,
+    1,
+    16,
+  };
+  rs_perf.add_u64_counter_histogram(
+    rs_peering_latency_hist, "peering_latency_histogram",
+    peering_hist_x_axis_config, peering_hist_y_axis_config,
+    "Histogram of peering latency vs. log/missing queries sent to peers");
+  rs_perf.add_u64_counter(
+    rs_getmissing_inferred, "getmissing_inferred",
+    "Peers whose missing set was inferred from our log instead of queried");
+
   return rs_perf.create_perf_counters();
 }
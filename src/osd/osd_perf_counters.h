@@ -51,12 +51,26 @@ enum {
   l_osd_sop_push_inb,
   l_osd_sop_push_lat,
 
+  l_osd_repop_batch,
+  l_osd_repop_batch_size,
+
   l_osd_pull,
   l_osd_push,
   l_osd_push_outb,
 
   l_osd_rop,
   l_osd_rbytes,
+  l_osd_rbytes_rate,
+  l_osd_recovery_active_limit,
+  l_osd_ec_recovery_read_bytes,
+  l_osd_ec_recovery_rebuilt_bytes,
+  l_osd_ec_recovery_subchunk_reads,
+
+  l_osd_scrub_lat,
+  l_osd_deep_scrub_lat,
+  l_osd_scrub_device_util,
+  l_osd_scrub_pace,
+  l_osd_op_lat_scrub_hist,
 
   l_osd_loadavg,
   l_osd_cached_crc,
@@ -74,6 +88,7 @@ enum {
   l_osd_mape_dup,
 
   l_osd_waiting_for_map,
+  l_osd_op_wq_steal,
 
   l_osd_map_cache_hit,
   l_osd_map_cache_miss,
@@ -81,6 +96,8 @@ enum {
   l_osd_map_cache_miss_low_avg,
   l_osd_map_bl_cache_hit,
   l_osd_map_bl_cache_miss,
+  l_osd_map_inc_shared,
+  l_osd_map_apply_lat,
 
   l_osd_stat_bytes,
   l_osd_stat_bytes_used,
@@ -157,6 +174,8 @@ enum {
   rs_getmissing_latency,
   rs_waitupthru_latency,
   rs_notrecovering_latency,
+  rs_peering_latency_hist,
+  rs_getmissing_inferred,
   rs_last,
 };
 
@@ -93,6 +93,7 @@ const char *ceph_osd_flag_name(unsigned flag)
   case CEPH_OSD_FLAG_IGNORE_REDIRECT: return "ignore_redirect";
   case CEPH_OSD_FLAG_RETURNVEC: return "returnvec";
   case CEPH_OSD_FLAG_SUPPORTSPOOLEIO: return "supports_pool_eio";
+  case CEPH_OSD_FLAG_EC_SHARD_READ: return "ec_shard_read";
   default: return "???";
   }
 }
@@ -1778,6 +1779,31 @@ uint32_t pg_pool_t::hash_key(const string& key, const string& ns) const
   return ceph_str_hash(object_hash, &buf[0], len);
 }
 
+void pg_pool_t::hash_keys(const vector<string>& keys, const string& ns,
+			  vector<uint32_t> *hashes) const
+{
+  vector<string> prefixed;
+  if (!ns.empty()) {
+    prefixed.reserve(keys.size());
+    for (auto& key : keys) {
+      prefixed.push_back(ns + '\037' + key);
+    }
+  }
+  const auto& strs = ns.empty() ? keys : prefixed;
+  vector<const char*> ptrs;
+  vector<unsigned> lens;
+  ptrs.reserve(strs.size());
+  lens.reserve(strs.size());
+  for (auto& s : strs) {
+    ptrs.push_back(s.data());
+    lens.push_back(s.length());
+  }
+  hashes->resize(strs.size());
+  static_assert(sizeof(unsigned) == sizeof(uint32_t));
+  ceph_str_hash_multi(object_hash, ptrs.data(), lens.data(), strs.size(),
+		      reinterpret_cast<unsigned*>(hashes->data()));
+}
+
 uint32_t pg_pool_t::raw_hash_to_pg(uint32_t v) const
 {
   return ceph_stable_mod(v, pg_num, pg_num_mask);
@@ -3320,7 +3346,7 @@ void pool_stat_t::generate_test_instances(list<pool_stat_t*>& o)
 
 void pg_history_t::encode(ceph::buffer::list &bl) const
 {
-  ENCODE_START(10, 4, bl);
+  ENCODE_START(11, 4, bl);
   encode(epoch_created, bl);
   encode(last_epoch_started, bl);
   encode(last_epoch_clean, bl);
@@ -3338,12 +3364,15 @@ void pg_history_t::encode(ceph::buffer::list &bl) const
   encode(last_interval_clean, bl);
   encode(epoch_pool_created, bl);
   encode(prior_readable_until_ub, bl);
+  encode(last_deep_scrub_begin, bl);
+  encode(last_deep_scrub_begin_epoch, bl);
+  encode(last_full_deep_scrub_stamp, bl);
   ENCODE_FINISH(bl);
 }
 
 void pg_history_t::decode(ceph::buffer::list::const_iterator &bl)
 {
-  DECODE_START_LEGACY_COMPAT_LEN(10, 4, 4, bl);
+  DECODE_START_LEGACY_COMPAT_LEN(11, 4, 4, bl);
   decode(epoch_created, bl);
   decode(last_epoch_started, bl);
   if (struct_v >= 3)
@@ -3391,6 +3420,16 @@ void pg_history_t::decode(ceph::buffer::list::const_iterator &bl)
   if (struct_v >= 10) {
     decode(prior_readable_until_ub, bl);
   }
+  if (struct_v >= 11) {
+    decode(last_deep_scrub_begin, bl);
+    decode(last_deep_scrub_begin_epoch, bl);
+    decode(last_full_deep_scrub_stamp, bl);
+  } else {
+    // every deep scrub was a full one
+    last_deep_scrub_begin = eversion_t();
+    last_deep_scrub_begin_epoch = 0;
+    last_full_deep_scrub_stamp = last_deep_scrub_stamp;
+  }
   DECODE_FINISH(bl);
 }
 
@@ -3412,6 +3451,9 @@ void pg_history_t::dump(Formatter *f) const
   f->dump_stream("last_deep_scrub") << last_deep_scrub;
   f->dump_stream("last_deep_scrub_stamp") << last_deep_scrub_stamp;
   f->dump_stream("last_clean_scrub_stamp") << last_clean_scrub_stamp;
+  f->dump_stream("last_deep_scrub_begin") << last_deep_scrub_begin;
+  f->dump_int("last_deep_scrub_begin_epoch", last_deep_scrub_begin_epoch);
+  f->dump_stream("last_full_deep_scrub_stamp") << last_full_deep_scrub_stamp;
   f->dump_float(
     "prior_readable_until_ub",
     std::chrono::duration<double>(prior_readable_until_ub).count());
@@ -3438,6 +3480,9 @@ void pg_history_t::generate_test_instances(list<pg_history_t*>& o)
   o.back()->last_deep_scrub_stamp = utime_t(14, 15);
   o.back()->last_clean_scrub_stamp = utime_t(16, 17);
   o.back()->last_epoch_marked_full = 18;
+  o.back()->last_deep_scrub_begin = eversion_t(19, 20);
+  o.back()->last_deep_scrub_begin_epoch = 21;
+  o.back()->last_full_deep_scrub_stamp = utime_t(22, 23);
 }
 
 
@@ -4708,6 +4753,23 @@ string pg_log_entry_t::get_key_name() const
   return version.get_key_name();
 }
 
+size_t pg_log_entry_t::get_approx_mem_usage() const
+{
+  // list node pointers, then whatever the members keep on the heap
+  size_t r = sizeof(*this) + 2 * sizeof(void*);
+  r += mod_desc.bl.length() + snaps.length();
+  r += soid.oid.name.capacity() + soid.get_key().capacity() +
+    soid.nspace.capacity();
+  r += extra_reqids.capacity() * sizeof(extra_reqids[0]);
+  r += extra_reqid_return_codes.size() * (sizeof(uint32_t) + sizeof(int) +
+					   4 * sizeof(void*));
+  r += op_returns.capacity() * sizeof(pg_log_op_return_item_t);
+  for (auto& i : op_returns) {
+    r += i.bl.length();
+  }
+  return r;
+}
+
 void pg_log_entry_t::encode_with_checksum(ceph::buffer::list& bl) const
 {
   using ceph::encode;
@@ -5091,6 +5153,19 @@ void pg_log_t::decode(ceph::buffer::list::const_iterator &bl, int64_t pool)
   }
 }
 
+uint64_t pg_log_t::get_approx_mem_usage() const
+{
+  uint64_t r = 0;
+  for (auto& i : log) {
+    r += i.get_approx_mem_usage();
+  }
+  for (auto& i : dups) {
+    r += sizeof(i) + 2 * sizeof(void*) +
+      i.op_returns.capacity() * sizeof(pg_log_op_return_item_t);
+  }
+  return r;
+}
+
 void pg_log_t::dump(Formatter *f) const
 {
   f->dump_stream("head") << head;
@@ -1835,6 +1835,9 @@ public:
 
   /// hash a object name+namespace key to a hash position
   uint32_t hash_key(const std::string& key, const std::string& ns) const;
+  /// hash_key() of each of @keys, all in namespace @ns
+  void hash_keys(const std::vector<std::string>& keys, const std::string& ns,
+		 std::vector<uint32_t> *hashes) const;
 
   /// round a hash position down to a pg num
   uint32_t raw_hash_to_pg(uint32_t v) const;
@@ -2792,6 +2795,14 @@ struct pg_history_t {
   utime_t last_deep_scrub_stamp;
   utime_t last_clean_scrub_stamp;
 
+  /// last_update when the last deep scrub began; objects at newer versions
+  /// have not been deep scrubbed since they were last written
+  eversion_t last_deep_scrub_begin;
+  /// the osdmap epoch when the last deep scrub began
+  epoch_t last_deep_scrub_begin_epoch = 0;
+  /// when the last deep scrub that read every object finished
+  utime_t last_full_deep_scrub_stamp;
+
   /// upper bound on how long prior interval readable (relative to encode time)
   ceph::timespan prior_readable_until_ub = ceph::timespan::zero();
 
@@ -2813,6 +2824,9 @@ struct pg_history_t {
       l.last_scrub_stamp == r.last_scrub_stamp &&
       l.last_deep_scrub_stamp == r.last_deep_scrub_stamp &&
       l.last_clean_scrub_stamp == r.last_clean_scrub_stamp &&
+      l.last_deep_scrub_begin == r.last_deep_scrub_begin &&
+      l.last_deep_scrub_begin_epoch == r.last_deep_scrub_begin_epoch &&
+      l.last_full_deep_scrub_stamp == r.last_full_deep_scrub_stamp &&
       l.prior_readable_until_ub == r.prior_readable_until_ub;
   }
 
@@ -2825,7 +2839,8 @@ struct pg_history_t {
       same_primary_since(created),
       last_scrub_stamp(stamp),
       last_deep_scrub_stamp(stamp),
-      last_clean_scrub_stamp(stamp) {}
+      last_clean_scrub_stamp(stamp),
+      last_full_deep_scrub_stamp(stamp) {}
   
   bool merge(const pg_history_t &other) {
     // Here, we only update the fields which cannot be calculated from the OSDmap.
@@ -2893,6 +2908,18 @@ struct pg_history_t {
       last_clean_scrub_stamp = other.last_clean_scrub_stamp;
       modified = true;
     }
+    if (other.last_deep_scrub_begin > last_deep_scrub_begin) {
+      last_deep_scrub_begin = other.last_deep_scrub_begin;
+      modified = true;
+    }
+    if (other.last_deep_scrub_begin_epoch > last_deep_scrub_begin_epoch) {
+      last_deep_scrub_begin_epoch = other.last_deep_scrub_begin_epoch;
+      modified = true;
+    }
+    if (other.last_full_deep_scrub_stamp > last_full_deep_scrub_stamp) {
+      last_full_deep_scrub_stamp = other.last_full_deep_scrub_stamp;
+      modified = true;
+    }
     return modified;
   }
 
@@ -4343,6 +4370,9 @@ struct pg_log_entry_t {
     }
   }
 
+  /// approximate bytes held by this entry, including the list node
+  size_t get_approx_mem_usage() const;
+
   std::string get_key_name() const;
   void encode_with_checksum(ceph::buffer::list& bl) const;
   void decode_with_checksum(ceph::buffer::list::const_iterator& p);
@@ -4580,6 +4610,9 @@ public:
     return head.version - tail.version;
   }
 
+  /// approximate bytes held by the log and dup entries
+  uint64_t get_approx_mem_usage() const;
+
   static void filter_log(spg_t import_pgid, const OSDMap &curmap,
     const std::string &hit_set_namespace, const pg_log_t &in,
     pg_log_t &out, pg_log_t &reject);
@@ -6151,6 +6184,8 @@ WRITE_CLASS_ENCODER(ScrubMap)
 
 struct ScrubMapBuilder {
   bool deep = false;
+  /// if set, only deep scrub objects written after this version
+  eversion_t deep_since;
   std::vector<hobject_t> ls;
   size_t pos = 0;
   int64_t data_pos = 0;
@@ -0,0 +1,88 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#include <algorithm>
+#include <mutex>
+
+#include "osd/scheduler/OpCostModel.h"
+
+namespace ceph::osd::scheduler {
+
+void OpCostModel::add_sample(uint64_t bytes, ceph::timespan latency)
+{
+  double x = bytes;
+  double y = std::chrono::duration<double>(latency).count();
+  std::lock_guard l(lock);
+  ++n;
+  sum_x += x;
+  sum_y += y;
+  sum_xx += x * x;
+  sum_xy += x * y;
+}
+
+bool OpCostModel::recalibrate(uint64_t min_samples, double alpha)
+{
+  uint64_t num;
+  double sx, sy, sxx, sxy;
+  {
+    std::lock_guard l(lock);
+    if (n == 0 || n < min_samples) {
+      return false;
+    }
+    num = n;
+    sx = sum_x;
+    sy = sum_y;
+    sxx = sum_xx;
+    sxy = sum_xy;
+    n = 0;
+    sum_x = sum_y = sum_xx = sum_xy = 0;
+  }
+
+  double mean_x = sx / num;
+  double mean_y = sy / num;
+  double var_x = sxx / num - mean_x * mean_x;
+  double per_byte;
+  if (var_x > mean_x * mean_x * 1e-6 && var_x > 0) {
+    per_byte = std::max((sxy / num - mean_x * mean_y) / var_x, 0.0);
+  } else {
+    // every op was (about) the same size; the slope is not observable,
+    // so keep the one we have and attribute the rest to the per-op cost
+    per_byte = cost_per_byte;
+  }
+  double per_io = std::max(mean_y - per_byte * mean_x, 0.0);
+
+  std::lock_guard l(lock);
+  if (have_model) {
+    cost_per_io = alpha * per_io + (1 - alpha) * cost_per_io;
+    cost_per_byte = alpha * per_byte + (1 - alpha) * cost_per_byte;
+  } else {
+    cost_per_io = per_io;
+    cost_per_byte = per_byte;
+    have_model = true;
+  }
+  total_samples += num;
+  last_samples = num;
+  return true;
+}
+
+void OpCostModel::dump(ceph::Formatter *f) const
+{
+  std::lock_guard l(lock);
+  f->dump_bool("valid", have_model);
+  f->dump_float("cost_per_io_sec", cost_per_io);
+  f->dump_float("cost_per_byte_sec", cost_per_byte);
+  f->dump_unsigned("samples_total", total_samples);
+  f->dump_unsigned("samples_last_fit", last_samples);
+  f->dump_unsigned("samples_pending", n);
+}
+
+}
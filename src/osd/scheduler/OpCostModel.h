@@ -0,0 +1,69 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+/*
+ * Ceph - scalable distributed file system
+ *
+ * This is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License version 2.1, as published by the Free Software
+ * Foundation.  See file COPYING.
+ *
+ */
+
+#pragma once
+
+#include "common/Formatter.h"
+#include "common/ceph_time.h"
+#include "include/spinlock.h"
+
+namespace ceph::osd::scheduler {
+
+/**
+ * Online estimate of what an op costs the object store.
+ *
+ * Completed store ops are recorded as (bytes, latency) samples.  Each
+ * recalibrate() fits latency = cost_per_io + cost_per_byte * bytes to the
+ * samples seen since the previous call by least squares, and folds the
+ * fit into the running model with an exponentially weighted moving
+ * average.  Costs are in seconds, like mClockScheduler's.
+ */
+class OpCostModel {
+  // samples since the last recalibrate()
+  mutable ceph::spinlock lock;
+  uint64_t n = 0;
+  double sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+
+  // the model
+  bool have_model = false;
+  double cost_per_io = 0;
+  double cost_per_byte = 0;
+  uint64_t total_samples = 0;
+  uint64_t last_samples = 0;
+
+public:
+  /// record a store op of @bytes that took @latency to complete
+  void add_sample(uint64_t bytes, ceph::timespan latency);
+
+  /**
+   * fold the samples since the last call into the model
+   *
+   * @param min_samples fewer samples than this are kept for next time
+   * @param alpha weight of the new fit against the running model
+   * @return true if the model was updated
+   */
+  bool recalibrate(uint64_t min_samples, double alpha);
+
+  bool is_valid() const {
+    return have_model;
+  }
+  double get_cost_per_io() const {
+    return cost_per_io;
+  }
+  double get_cost_per_byte() const {
+    return cost_per_byte;
+  }
+
+  void dump(ceph::Formatter *f) const;
+};
+
+}
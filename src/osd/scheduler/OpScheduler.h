@@ -53,6 +53,10 @@ public:
   // Apply config changes to the scheduler (if any)
   virtual void update_configuration() = 0;
 
+  // Take a measured per-op and per-byte cost (in secs); ignored by
+  // schedulers that do not cost ops
+  virtual void update_cost_model(double cost_per_io, double cost_per_byte) {}
+
   // Destructor
   virtual ~OpScheduler() {};
 };
@@ -246,6 +246,16 @@ void PGDelete::run(
   osd->dequeue_delete(sdata, pg.get(), epoch_queued, handle);
 }
 
+void PGRepOpBatchFlush::run(
+  OSD *osd,
+  OSDShard *sdata,
+  PGRef& pg,
+  ThreadPool::TPHandle &handle)
+{
+  pg->flush_repop_batch(epoch_queued);
+  pg->unlock();
+}
+
 void PGRecoveryMsg::run(
   OSD *osd,
   OSDShard *sdata,
@@ -598,6 +598,30 @@ public:
   }
 };
 
+/// send the rep ops a replicated PG has been holding back for batching
+class PGRepOpBatchFlush : public PGOpQueueable {
+  epoch_t epoch_queued;
+public:
+  PGRepOpBatchFlush(
+    spg_t pg,
+    epoch_t epoch_queued)
+    : PGOpQueueable(pg),
+      epoch_queued(epoch_queued) {}
+  op_type_t get_op_type() const final {
+    return op_type_t::client_op;
+  }
+  std::ostream &print(std::ostream &rhs) const final {
+    return rhs << "PGRepOpBatchFlush(" << get_pgid()
+	       << " e" << epoch_queued
+	       << ")";
+  }
+  void run(
+    OSD *osd, OSDShard *sdata, PGRef& pg, ThreadPool::TPHandle &handle) final;
+  op_scheduler_class get_scheduler_class() const final {
+    return op_scheduler_class::immediate;
+  }
+};
+
 class PGRecoveryMsg : public PGOpQueueable {
   OpRequestRef op;
 
@@ -13,11 +13,14 @@
  */
 
 
+#include <cstdio>
 #include <memory>
 #include <functional>
+#include <sstream>
 
 #include "osd/scheduler/mClockScheduler.h"
 #include "common/dout.h"
+#include "include/str_list.h"
 
 namespace dmc = crimson::dmclock;
 using namespace std::placeholders;
@@ -73,14 +76,121 @@ void mClockScheduler::ClientRegistry::update_from_config(const ConfigProxy &conf
     conf.get_val<uint64_t>("osd_mclock_scheduler_background_best_effort_lim"));
 }
 
+void mClockScheduler::ClientRegistry::update_external_clients(
+  const std::map<client_profile_id_t, dmc::ClientInfo> &infos)
+{
+  for (auto& [id, c] : external_client_infos) {
+    c.configured = false;
+  }
+  for (auto& [id, info] : infos) {
+    auto [i, inserted] = external_client_infos.try_emplace(
+      id, ExternalClient{info, true});
+    if (!inserted) {
+      i->second.info.update(info.reservation, info.weight, info.limit);
+      i->second.configured = true;
+    }
+  }
+  num_configured = infos.size();
+}
+
+client_profile_id_t mClockScheduler::ClientRegistry::get_external_client_id(
+  client_id_t client, int64_t pool) const
+{
+  if (num_configured == 0 ||
+      is_configured(client_profile_id_t{client, 0})) {
+    return client_profile_id_t{client, 0};
+  }
+  if (pool >= 0 &&
+      is_configured(client_profile_id_t{0, profile_id_t(pool) + 1})) {
+    return client_profile_id_t{0, profile_id_t(pool) + 1};
+  }
+  return client_profile_id_t{client, 0};
+}
+
 const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_external_client(
   const client_profile_id_t &client) const
 {
   auto ret = external_client_infos.find(client);
-  if (ret == external_client_infos.end())
+  if (ret == external_client_infos.end() || !ret->second.configured)
     return &default_external_client_info;
   else
-    return &(ret->second);
+    return &(ret->second.info);
+}
+
+void mClockScheduler::ClientRegistry::dump(ceph::Formatter &f) const
+{
+  f.open_array_section("client_qos");
+  for (auto& [id, c] : external_client_infos) {
+    if (!c.configured) {
+      continue;
+    }
+    f.open_object_section("client");
+    if (id.client_id) {
+      f.dump_unsigned("client", id.client_id);
+    } else {
+      f.dump_unsigned("pool", id.profile_id - 1);
+    }
+    f.dump_float("res", c.info.reservation);
+    f.dump_float("wgt", c.info.weight);
+    f.dump_float("lim", c.info.limit);
+    f.close_section();
+  }
+  f.close_section();
+}
+
+bool mClockScheduler::parse_client_qos(
+  const std::string &s,
+  std::map<client_profile_id_t, dmc::ClientInfo> *infos,
+  std::ostream *err)
+{
+  bool ok = true;
+  std::list<std::string> entries;
+  get_str_list(s, ",; \t\n", entries);
+  for (auto& entry : entries) {
+    client_profile_id_t id{0, 0};
+    char kind[8];
+    unsigned long long num;
+    double res, wgt, lim;
+    int used = 0;
+    if (sscanf(entry.c_str(), "%7[a-z].%llu=%lf/%lf/%lf%n",
+	       kind, &num, &res, &wgt, &lim, &used) != 5 ||
+	used != (int)entry.size() ||
+	res < 0 || wgt <= 0 || lim < 0) {
+      *err << "malformed entry '" << entry << "'; ";
+      ok = false;
+      continue;
+    }
+    if (std::string_view(kind) == "client") {
+      id.client_id = num;
+    } else if (std::string_view(kind) == "pool") {
+      id.profile_id = num + 1;
+    } else {
+      *err << "entry '" << entry << "' is not for a client or a pool; ";
+      ok = false;
+      continue;
+    }
+    infos->insert_or_assign(id, dmc::ClientInfo(res, wgt, lim));
+  }
+  return ok;
+}
+
+void mClockScheduler::update_client_qos()
+{
+  std::map<client_profile_id_t, dmc::ClientInfo> infos;
+  std::ostringstream err;
+  if (!parse_client_qos(
+	cct->_conf.get_val<std::string>("osd_mclock_scheduler_client_qos"),
+	&infos, &err)) {
+    derr << __func__ << " osd_mclock_scheduler_client_qos: " << err.str()
+	 << dendl;
+  }
+  client_registry.update_external_clients(infos);
+  // dmclock keeps the ClientInfo it first looked up for each client:
+  // have it look them all up again, so that clients added to or removed
+  // from the option pick up their new allocation
+  scheduler.update_client_infos();
+  dout(10) << __func__ << " " << infos.size() << " client/pool allocations"
+	   << dendl;
 }
 
 const dmc::ClientInfo *mClockScheduler::ClientRegistry::get_info(
@@ -371,9 +481,23 @@ void mClockScheduler::set_profile_config()
 
 int mClockScheduler::calc_scaled_cost(int item_cost)
 {
-  // Calculate total scaled cost in secs
-  int scaled_cost =
-    std::round(osd_mclock_cost_per_io + (osd_mclock_cost_per_byte * item_cost));
+  double cost;
+  if (cost_model_calibrated) {
+    // The measured costs are seconds of store time, which round to 0 for
+    // any op. The dmclock allocations are in IOPS of small random IOs (see
+    // osd_mclock_max_capacity_iops_*), so count the item in multiples of
+    // what a 4 KiB op costs.
+    constexpr double unit_bytes = 4096;
+    double unit = osd_mclock_cost_per_io + osd_mclock_cost_per_byte * unit_bytes;
+    if (unit <= 0) {
+      return 1;
+    }
+    cost = (osd_mclock_cost_per_io + osd_mclock_cost_per_byte * item_cost) / unit;
+  } else {
+    // Calculate total scaled cost in secs
+    cost = osd_mclock_cost_per_io + (osd_mclock_cost_per_byte * item_cost);
+  }
+  int scaled_cost = std::round(cost);
   return std::max(scaled_cost, 1);
 }
 
@@ -385,12 +509,36 @@ void mClockScheduler::update_configuration()
   cct->_conf.apply_changes(nullptr);
 }
 
+void mClockScheduler::update_cost_model(double cost_per_io,
+					double cost_per_byte)
+{
+  if (!cct->_conf.get_val<bool>("osd_mclock_cost_calibration")) {
+    return;
+  }
+  dout(20) << __func__ << " cost_per_io " << osd_mclock_cost_per_io
+	   << " -> " << cost_per_io << ", cost_per_byte "
+	   << osd_mclock_cost_per_byte << " -> " << cost_per_byte << dendl;
+  osd_mclock_cost_per_io = cost_per_io;
+  osd_mclock_cost_per_byte = cost_per_byte;
+  cost_model_calibrated = true;
+}
+
 void mClockScheduler::dump(ceph::Formatter &f) const
 {
+  f.open_object_section("cost_model");
+  f.dump_bool("calibrated", cost_model_calibrated);
+  f.dump_float("cost_per_io_sec", osd_mclock_cost_per_io);
+  f.dump_float("cost_per_byte_sec", osd_mclock_cost_per_byte);
+  f.dump_float("max_osd_capacity_per_shard_iops", max_osd_capacity);
+  f.close_section();
+  client_registry.dump(f);
 }
 
 void mClockScheduler::enqueue(OpSchedulerItem&& item)
 {
+  if (client_qos_changed.exchange(false)) {
+    update_client_qos();
+  }
   auto id = get_scheduler_id(item);
 
   // TODO: move this check into OpSchedulerItem, handle backwards compat
@@ -454,9 +602,11 @@ const char** mClockScheduler::get_tracked_conf_keys() const
     "osd_mclock_cost_per_byte_usec",
     "osd_mclock_cost_per_byte_usec_hdd",
     "osd_mclock_cost_per_byte_usec_ssd",
+    "osd_mclock_cost_calibration",
     "osd_mclock_max_capacity_iops_hdd",
     "osd_mclock_max_capacity_iops_ssd",
     "osd_mclock_profile",
+    "osd_mclock_scheduler_client_qos",
     NULL
   };
   return KEYS;
@@ -476,6 +626,14 @@ void mClockScheduler::handle_conf_change(
       changed.count("osd_mclock_cost_per_byte_usec_ssd")) {
     set_osd_mclock_cost_per_byte();
   }
+  if (changed.count("osd_mclock_cost_calibration") &&
+      !conf.get_val<bool>("osd_mclock_cost_calibration") &&
+      cost_model_calibrated) {
+    // back to the configured costs
+    set_osd_mclock_cost_per_io();
+    set_osd_mclock_cost_per_byte();
+    cost_model_calibrated = false;
+  }
   if (changed.count("osd_mclock_max_capacity_iops_hdd") ||
       changed.count("osd_mclock_max_capacity_iops_ssd")) {
     set_max_osd_capacity();
@@ -504,6 +662,9 @@ void mClockScheduler::handle_conf_change(
       client_registry.update_from_config(conf);
     }
   }
+  if (changed.count("osd_mclock_scheduler_client_qos")) {
+    client_qos_changed = true;
+  }
 }
 
 mClockScheduler::~mClockScheduler()
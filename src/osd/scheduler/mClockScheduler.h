@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <ostream>
 #include <map>
 #include <vector>
@@ -69,6 +70,8 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
   double max_osd_capacity;
   double osd_mclock_cost_per_io;
   double osd_mclock_cost_per_byte;
+  bool cost_model_calibrated = false;  ///< costs above come from the OSD's
+				       ///< OpCostModel rather than config
   std::string mclock_profile = "high_client_ops";
   struct ClientAllocs {
     uint64_t res;
@@ -106,16 +109,41 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
     };
 
     crimson::dmclock::ClientInfo default_external_client_info = {1, 1, 1};
-    std::map<client_profile_id_t,
-	     crimson::dmclock::ClientInfo> external_client_infos;
+
+    // Per-client and per-pool allocations from osd_mclock_scheduler_client_qos,
+    // keyed by {client, 0} and {0, pool + 1} respectively.  dmclock holds on
+    // to the ClientInfo pointers we hand out until update_client_infos(), so
+    // entries are updated in place, and those dropped from the config are
+    // only marked unconfigured, never erased.
+    struct ExternalClient {
+      crimson::dmclock::ClientInfo info;
+      bool configured;
+    };
+    std::map<client_profile_id_t, ExternalClient> external_client_infos;
+    unsigned num_configured = 0;
     const crimson::dmclock::ClientInfo *get_external_client(
       const client_profile_id_t &client) const;
+    bool is_configured(const client_profile_id_t &client) const {
+      auto i = external_client_infos.find(client);
+      return i != external_client_infos.end() && i->second.configured;
+    }
   public:
     void update_from_config(const ConfigProxy &conf);
+    void update_external_clients(
+      const std::map<client_profile_id_t,
+                     crimson::dmclock::ClientInfo> &infos);
+    client_profile_id_t get_external_client_id(
+      client_id_t client, int64_t pool) const;
     const crimson::dmclock::ClientInfo *get_info(
       const scheduler_id_t &id) const;
+    void dump(ceph::Formatter &f) const;
   } client_registry;
 
+  // set by the config observer, applied by the shard thread on its next
+  // enqueue so that the registry is only ever touched under the shard lock
+  std::atomic<bool> client_qos_changed = true;
+  void update_client_qos();
+
   using mclock_queue_t = crimson::dmclock::PullPriorityQueue<
     scheduler_id_t,
     OpSchedulerItem,
@@ -125,13 +153,17 @@ class mClockScheduler : public OpScheduler, md_config_obs_t {
   mclock_queue_t scheduler;
   std::list<OpSchedulerItem> immediate;
 
-  static scheduler_id_t get_scheduler_id(const OpSchedulerItem &item) {
+  scheduler_id_t get_scheduler_id(const OpSchedulerItem &item) const {
+    if (item.get_scheduler_class() != op_scheduler_class::client) {
+      return scheduler_id_t{
+	item.get_scheduler_class(),
+	client_profile_id_t{item.get_owner(), 0}
+      };
+    }
     return scheduler_id_t{
-      item.get_scheduler_class(),
-	client_profile_id_t{
-	item.get_owner(),
-	  0
-	  }
+      op_scheduler_class::client,
+      client_registry.get_external_client_id(
+	item.get_owner(), item.get_ordering_token().pool())
     };
   }
 
@@ -172,6 +204,21 @@ public:
   // Calculate scale cost per item
   int calc_scaled_cost(int cost);
 
+  /**
+   * Parse osd_mclock_scheduler_client_qos
+   *
+   * The value is a list of "client.<id>=<res>/<wgt>/<lim>" and
+   * "pool.<id>=<res>/<wgt>/<lim>" entries.  Ops of a listed client are
+   * scheduled with that client's allocation.  Ops of other clients in a
+   * listed pool share the pool's allocation.
+   *
+   * @return false if any entry is malformed; the others are still parsed
+   */
+  static bool parse_client_qos(
+    const std::string &s,
+    std::map<client_profile_id_t, crimson::dmclock::ClientInfo> *infos,
+    std::ostream *err);
+
   // Enqueue op in the back of the regular queue
   void enqueue(OpSchedulerItem &&item) final;
 
@@ -196,6 +243,9 @@ public:
   // Update data associated with the modified mclock config key(s)
   void update_configuration() final;
 
+  // Use the costs measured by the OSD, if osd_mclock_cost_calibration is on
+  void update_cost_model(double cost_per_io, double cost_per_byte) final;
+
   const char** get_tracked_conf_keys() const final;
   void handle_conf_change(const ConfigProxy& conf,
 			  const std::set<std::string> &changed) final;
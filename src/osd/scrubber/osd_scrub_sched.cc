@@ -493,7 +493,15 @@ double ScrubQueue::scrub_sleep_time(bool must_scrub) const
 {
   double regular_sleep_period = cct->_conf->osd_scrub_sleep;
 
-  if (must_scrub || scrub_time_permit(ceph_clock_now())) {
+  if (must_scrub) {
+    return regular_sleep_period;
+  }
+
+  // back off further while the devices are busy (see update_device_load())
+  regular_sleep_period += (1.0 - scrub_pace) *
+    cct->_conf.get_val<double>("osd_scrub_adaptive_sleep_max");
+
+  if (scrub_time_permit(ceph_clock_now())) {
     return regular_sleep_period;
   }
 
@@ -504,6 +512,34 @@ double ScrubQueue::scrub_sleep_time(bool must_scrub) const
   return std::max(extended_sleep, regular_sleep_period);
 }
 
+void ScrubQueue::update_device_load(double util)
+{
+  double target = cct->_conf.get_val<double>("osd_scrub_device_util_target");
+  double pace = scrub_pace;
+  if (target <= 0) {
+    pace = 1.0;
+  } else if (util > target) {
+    pace = std::max(pace / 2, min_scrub_pace);
+  } else if (util < target * 0.8) {
+    pace = std::min(pace + min_scrub_pace, 1.0);
+  }
+  if (pace != scrub_pace) {
+    dout(15) << "device utilization " << util << " (target " << target
+	     << "): scrub pace " << scrub_pace << " -> " << pace << dendl;
+    scrub_pace = pace;
+  }
+}
+
+double ScrubQueue::scrub_chunk_factor(bool must_scrub) const
+{
+  return must_scrub ? 1.0 : scrub_pace.load();
+}
+
+int64_t ScrubQueue::scrub_chunk_max(int64_t chunk_max, bool must_scrub) const
+{
+  return static_cast<int64_t>(chunk_max * scrub_chunk_factor(must_scrub));
+}
+
 bool ScrubQueue::scrub_load_below_threshold() const
 {
   double loadavgs[3];
@@ -664,6 +700,7 @@ bool ScrubQueue::inc_scrubs_local()
 
   if (scrubs_local + scrubs_remote < cct->_conf->osd_max_scrubs) {
     ++scrubs_local;
+    ++active_scrubs;
     return true;
   }
 
@@ -680,6 +717,7 @@ void ScrubQueue::dec_scrubs_local()
 	   << dendl;
 
   --scrubs_local;
+  --active_scrubs;
   ceph_assert(scrubs_local >= 0);
 }
 
@@ -692,6 +730,7 @@ bool ScrubQueue::inc_scrubs_remote()
 	     << cct->_conf->osd_max_scrubs << ", local " << scrubs_local << ")"
 	     << dendl;
     ++scrubs_remote;
+    ++active_scrubs;
     return true;
   }
 
@@ -707,6 +746,7 @@ void ScrubQueue::dec_scrubs_remote()
 	   << cct->_conf->osd_max_scrubs << ", local " << scrubs_local << ")"
 	   << dendl;
   --scrubs_remote;
+  --active_scrubs;
   ceph_assert(scrubs_remote >= 0);
 }
 
@@ -247,6 +247,27 @@ class ScrubQueue {
   double scrub_sleep_time(
     bool must_scrub) const;  /// \todo (future) return milliseconds
 
+  /**
+   * Adapt the scrub pace to the load on the OSD's devices
+   *
+   * Called every tick with the utilization (0..1) of the busiest device
+   * over the last tick.  Above osd_scrub_device_util_target the pace is
+   * halved; well below it, the pace creeps back up to 1.  Scrubs that are
+   * not required run with their chunks shrunk by the pace (see
+   * scrub_chunk_factor()) and their sleeps stretched by up to
+   * osd_scrub_adaptive_sleep_max (see scrub_sleep_time()).
+   */
+  void update_device_load(double util);
+
+  /// the fraction of osd_scrub_chunk_max to scrub per chunk
+  double scrub_chunk_factor(bool must_scrub) const;
+
+  /// 'chunk_max' (objects per chunk) scaled by scrub_chunk_factor()
+  int64_t scrub_chunk_max(int64_t chunk_max, bool must_scrub) const;
+
+  /// scrubs (as primary or replica) holding a scrub resource on this OSD
+  int get_active_scrubs() const { return active_scrubs; }
+
   /**
    *  called every heartbeat to update the "daily" load average
    *
@@ -313,6 +334,11 @@ class ScrubQueue {
   // the counters used to manage scrub activity parallelism:
   int scrubs_local{0};
   int scrubs_remote{0};
+  /// scrubs_local + scrubs_remote, for readers not holding resource_lock
+  std::atomic_int active_scrubs{0};
+
+  static constexpr double min_scrub_pace = 1.0 / 16;
+  std::atomic<double> scrub_pace{1.0};
 
   std::atomic_bool a_pg_is_reserving{false};
 
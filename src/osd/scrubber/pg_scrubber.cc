@@ -416,9 +416,51 @@ void PgScrubber::reset_epoch(epoch_t epoch_queued)
   m_epoch_start = epoch_queued;
   m_needs_sleep = true;
   m_is_deep = state_test(PG_STATE_DEEP_SCRUB);
+  m_deep_scrub_begin = m_pg->info.last_update;
+  m_deep_scrub_begin_epoch = get_osdmap_epoch();
+  m_deep_since = m_is_deep ? incremental_deep_scrub_since() : eversion_t{};
   update_op_mode_text();
 }
 
+eversion_t PgScrubber::deep_scrub_since(const pg_history_t& history,
+				       bool required,
+				       bool repair,
+				       int64_t scrub_errors,
+				       double full_interval,
+				       utime_t now)
+{
+  if (full_interval <= 0 || required || repair || scrub_errors ||
+      history.last_deep_scrub_begin == eversion_t()) {
+    return eversion_t{};
+  }
+  // the acting set changed, or the PG recovered (and became clean again),
+  // after the last deep scrub began
+  if (history.same_interval_since > history.last_deep_scrub_begin_epoch ||
+      history.last_epoch_clean > history.last_deep_scrub_begin_epoch) {
+    return eversion_t{};
+  }
+  if (now > history.last_full_deep_scrub_stamp + full_interval) {
+    return eversion_t{};
+  }
+  return history.last_deep_scrub_begin;
+}
+
+eversion_t PgScrubber::incremental_deep_scrub_since() const
+{
+  const auto& history = m_pg->info.history;
+  eversion_t since = deep_scrub_since(
+    history, m_flags.required, m_is_repair,
+    m_pg->info.stats.stats.sum.num_scrub_errors,
+    get_pg_cct()->_conf.get_val<double>("osd_deep_scrub_full_interval"),
+    ceph_clock_now());
+  if (since != eversion_t()) {
+    dout(10) << __func__ << " only objects written since " << since
+	     << "; last full deep scrub "
+	     << history.last_full_deep_scrub_stamp << dendl;
+  }
+  return since;
+}
+
 unsigned int PgScrubber::scrub_requeue_priority(Scrub::scrub_prio_t with_priority) const
 {
   unsigned int qu_priority = m_flags.priority;
@@ -663,8 +705,11 @@ bool PgScrubber::select_range()
   int min_idx = static_cast<int>(std::max<int64_t>(
     3, m_pg->get_cct()->_conf->osd_scrub_chunk_min / (int)preemption_data.chunk_divisor()));
 
-  int max_idx = static_cast<int>(std::max<int64_t>(min_idx, m_pg->get_cct()->_conf->osd_scrub_chunk_max /
-    (int)preemption_data.chunk_divisor()));
+  int max_idx = static_cast<int>(std::max<int64_t>(min_idx,
+    m_osds->get_scrub_services().scrub_chunk_max(
+      m_pg->get_cct()->_conf->osd_scrub_chunk_max /
+	(int)preemption_data.chunk_divisor(),
+      m_flags.required)));
 
   dout(10) << __func__ << " Min: " << min_idx << " Max: " << max_idx
 	   << " Div: " << preemption_data.chunk_divisor() << dendl;
@@ -934,6 +979,9 @@ void PgScrubber::_request_scrub_map(pg_shard_t replica,
     new MOSDRepScrub(spg_t(m_pg->info.pgid.pgid, replica.shard), version,
 		     get_osdmap_epoch(), m_pg->get_last_peering_reset(), start, end, deep,
 		     allow_preemption, m_flags.priority, m_pg->ops_blocked_by_scrub());
+  if (deep) {
+    repscrubop->deep_since = m_deep_since;
+  }
 
   // default priority. We want the replica-scrub processed prior to any recovery
   // or client io messages (we are holding a lock!)
@@ -1162,6 +1210,7 @@ int PgScrubber::build_scrub_map_chunk(
   while (pos.empty()) {
 
     pos.deep = deep;
+    pos.deep_since = deep ? m_deep_since : eversion_t{};
     map.valid_through = m_pg->info.last_update;
 
     // objects
@@ -1295,6 +1344,7 @@ void PgScrubber::replica_scrub_op(OpRequestRef op)
   m_end = msg->end;
   m_max_end = msg->end;
   m_is_deep = msg->deep;
+  m_deep_since = msg->deep_since;
   m_interval_start = m_pg->info.history.same_interval_since;
   m_replica_request_priority = msg->high_priority ? Scrub::scrub_prio_t::high_priority
 						  : Scrub::scrub_prio_t::low_priority;
@@ -1832,6 +1882,11 @@ void PgScrubber::scrub_finish()
 	if (m_is_deep) {
 	  history.last_deep_scrub = m_pg->recovery_state.get_info().last_update;
 	  history.last_deep_scrub_stamp = now;
+	  history.last_deep_scrub_begin = m_deep_scrub_begin;
+	  history.last_deep_scrub_begin_epoch = m_deep_scrub_begin_epoch;
+	  if (m_deep_since == eversion_t()) {
+	    history.last_full_deep_scrub_stamp = now;
+	  }
 	}
 
 	if (m_is_deep) {
@@ -1839,9 +1894,13 @@ void PgScrubber::scrub_finish()
 	    history.last_clean_scrub_stamp = now;
 	  stats.stats.sum.num_shallow_scrub_errors = m_shallow_errors;
 	  stats.stats.sum.num_deep_scrub_errors = m_deep_errors;
-	  stats.stats.sum.num_large_omap_objects = m_omap_stats.large_omap_objects;
-	  stats.stats.sum.num_omap_bytes = m_omap_stats.omap_bytes;
-	  stats.stats.sum.num_omap_keys = m_omap_stats.omap_keys;
+	  // an incremental deep scrub only counted the omaps it read
+	  if (m_deep_since == eversion_t()) {
+	    stats.stats.sum.num_large_omap_objects =
+	      m_omap_stats.large_omap_objects;
+	    stats.stats.sum.num_omap_bytes = m_omap_stats.omap_bytes;
+	    stats.stats.sum.num_omap_keys = m_omap_stats.omap_keys;
+	  }
 	  dout(25) << "scrub_finish shard " << m_pg_whoami
 		   << " num_omap_bytes = " << stats.stats.sum.num_omap_bytes
 		   << " num_omap_keys = " << stats.stats.sum.num_omap_keys << dendl;
@@ -1934,6 +1993,7 @@ void PgScrubber::dump(ceph::Formatter* f) const
     f->dump_stream("m_max_end") << m_max_end;
     f->dump_stream("subset_last_update") << m_subset_last_update;
     f->dump_bool("deep", m_is_deep);
+    f->dump_stream("deep_since") << m_deep_since;
     f->dump_bool("must_scrub", (m_pg->m_planned_scrub.must_scrub || m_flags.required));
     f->dump_bool("must_deep_scrub", m_pg->m_planned_scrub.must_deep_scrub);
     f->dump_bool("must_repair", m_pg->m_planned_scrub.must_repair);
@@ -2015,6 +2075,8 @@ void PgScrubber::set_scrub_begin_time() {
 void PgScrubber::set_scrub_duration() {
    utime_t stamp = ceph_clock_now();
    utime_t duration = stamp - scrub_begin_stamp;
+   m_osds->logger->tinc(m_is_deep ? l_osd_deep_scrub_lat : l_osd_scrub_lat,
+			duration);
    m_pg->recovery_state.update_stats(
       [=](auto &history, auto &stats) {
        stats.scrub_duration = double(duration);
@@ -451,6 +451,20 @@ class PgScrubber : public ScrubPgIF, public ScrubMachineListener {
 
   static utime_t scrub_must_stamp() { return utime_t(1, 1); }
 
+  /**
+   * The version an incremental deep scrub of a PG with this history may
+   * start from, or zero if the deep scrub must read every object.
+   * Objects recovered or backfilled onto a shard keep their old versions,
+   * so a change of interval or a recovery since the last deep scrub began
+   * forces a full deep scrub.
+   */
+  static eversion_t deep_scrub_since(const pg_history_t& history,
+				     bool required,
+				     bool repair,
+				     int64_t scrub_errors,
+				     double full_interval,
+				     utime_t now);
+
   virtual ~PgScrubber();  // must be defined separately, in the .cc file
 
   [[nodiscard]] bool is_scrub_active() const final { return m_active; }
@@ -633,6 +647,22 @@ class PgScrubber : public ScrubPgIF, public ScrubMachineListener {
    */
   bool m_is_deep{false};
 
+  /**
+   * For an incremental deep scrub: only objects written after this version
+   * are read (see osd_deep_scrub_full_interval). Zero for a full deep scrub.
+   * Set by the primary when the scrub starts and passed to the replicas.
+   */
+  eversion_t m_deep_since;
+
+  /// the PG's last_update when this scrub started (primary only)
+  eversion_t m_deep_scrub_begin;
+
+  /// the osdmap epoch when this scrub started (primary only)
+  epoch_t m_deep_scrub_begin_epoch{0};
+
+  /// the version an incremental deep scrub may start from, if any
+  eversion_t incremental_deep_scrub_since() const;
+
   /**
    * If set: affects the backend & scrubber-backend functions called after all
    * scrub maps are available.
@@ -57,6 +57,7 @@
 #include "common/EventTrace.h"
 #include "common/async/waiter.h"
 #include "error_code.h"
+#include "erasure-code/ErasureCodePlugin.h"
 
 
 using std::list;
@@ -1100,6 +1101,10 @@ void Objecter::_scan_requests(
 	break;
       // -- fall-thru --
     case RECALC_OP_TARGET_NEED_RESEND:
+      if (op->target.ec_shard >= 0) {
+	_fail_ec_shard_op(op, &sl);
+	break;
+      }
       _session_op_remove(op->session, op);
       need_resend[op->tid] = op;
       _op_cancel_map_check(op);
@@ -1611,6 +1616,36 @@ void Objecter::_check_op_pool_eio(Op *op, std::unique_lock<std::shared_mutex> *s
   }
 }
 
+void Objecter::_fail_ec_shard_op(Op *op,
+				 std::unique_lock<std::shared_mutex> *sl)
+{
+  // rwlock is locked
+
+  // the shard is gone or moved; the reader falls back to the primary
+  ldout(cct, 10) << __func__ << " tid " << op->tid
+		 << " shard " << op->target.ec_shard
+		 << " no longer readable directly" << dendl;
+  if (op->has_completion()) {
+    num_in_flight--;
+    op->complete(osdcode(-EAGAIN), -EAGAIN);
+  }
+
+  OSDSession *s = op->session;
+  if (s) {
+    ceph_assert(sl->mutex() == &s->lock);
+    bool session_locked = sl->owns_lock();
+    if (!session_locked) {
+      sl->lock();
+    }
+    _finish_op(op, 0);
+    if (!session_locked) {
+      sl->unlock();
+    }
+  } else {
+    _finish_op(op, 0);	// no session
+  }
+}
+
 void Objecter::_send_op_map_check(Op *op)
 {
   // rwlock is locked unique
@@ -2392,6 +2427,12 @@ void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_t
     return;
   }
 
+  if (op->target.ec_shard >= 0 && op->target.osd < 0) {
+    _send_op_account(op);
+    _fail_ec_shard_op(op, nullptr);
+    return;
+  }
+
   // Try to get a session, including a retry if we need to take write lock
   r = _get_session(op->target.osd, &s, sul);
   if (r == -EAGAIN ||
@@ -2472,6 +2513,286 @@ void Objecter::_op_submit(Op *op, shunique_lock<ceph::shared_mutex>& sul, ceph_t
   ldout(cct, 5) << num_in_flight << " in flight" << dendl;
 }
 
+// EC direct reads ------------------------------
+
+bool Objecter::wants_ec_direct_read(int64_t pool, uint64_t len)
+{
+  if (!cct->_conf.get_val<bool>("rados_ec_direct_reads") ||
+      len < cct->_conf.get_val<Option::size_t>(
+	"rados_ec_direct_read_min_size")) {
+    return false;
+  }
+  shared_lock rl(rwlock);
+  const pg_pool_t *pi = osdmap->get_pg_pool(pool);
+  // older osds don't know how to serve a shard read; read_ec_direct()
+  // checks the osds it targets again, in case some are down now
+  return pi && pi->is_erasure() &&
+    HAVE_FEATURE(osdmap->get_up_osd_features(), OSD_EC_SHARD_READ);
+}
+
+std::shared_ptr<ceph::ErasureCodeInterface> Objecter::get_ec_impl(
+  const std::string& name,
+  const std::map<std::string, std::string>& profile)
+{
+  std::lock_guard l(ec_impl_lock);
+  auto p = ec_impls.find(name);
+  if (p != ec_impls.end()) {
+    return p->second;
+  }
+  auto plugin = profile.find("plugin");
+  if (plugin == profile.end()) {
+    return nullptr;
+  }
+  ceph::ErasureCodeProfile ec_profile = profile;
+  ceph::ErasureCodeInterfaceRef ec_impl;
+  ostringstream ss;
+  int r = ceph::ErasureCodePluginRegistry::instance().factory(
+    plugin->second,
+    cct->_conf.get_val<std::string>("erasure_code_dir"),
+    ec_profile,
+    &ec_impl,
+    &ss);
+  if (r < 0) {
+    ldout(cct, 1) << __func__ << " cannot load erasure code profile "
+		  << name << ": " << ss.str() << dendl;
+    ec_impl.reset();
+  }
+  // remember failures too, so they are only logged once
+  ec_impls[name] = ec_impl;
+  return ec_impl;
+}
+
+struct Objecter::ECDirectRead {
+  struct ShardRead {
+    bufferlist bl;
+    uint64_t size = 0;
+    version_t version = 0;
+    int r = 0;
+  };
+
+  Objecter *objecter;
+  object_t oid;
+  object_locator_t oloc;
+  uint64_t off, len;
+  bufferlist *pbl;
+  int flags;
+  Context *onfinish;
+  version_t *objver;
+
+  std::shared_ptr<ceph::ErasureCodeInterface> ec_impl;
+  uint64_t chunk_size = 0;
+  uint64_t stripe_off = 0;  ///< logical offset of the first stripe read
+  std::set<int> want;	    ///< the data shards
+
+  ceph::mutex lock = ceph::make_mutex("Objecter::ECDirectRead::lock");
+  std::map<int, ShardRead> reads;
+  unsigned pending = 0;
+
+  ECDirectRead(Objecter *objecter, const object_t& oid,
+	       const object_locator_t& oloc, uint64_t off, uint64_t len,
+	       bufferlist *pbl, int flags, Context *onfinish,
+	       version_t *objver)
+    : objecter(objecter), oid(oid), oloc(oloc), off(off), len(len),
+      pbl(pbl), flags(flags), onfinish(onfinish), objver(objver) {}
+
+  struct C_ShardRead : public Context {
+    ECDirectRead *rd;
+    int shard;
+    C_ShardRead(ECDirectRead *rd, int shard) : rd(rd), shard(shard) {}
+    void finish(int r) override {
+      rd->shard_read_finish(shard, r);
+    }
+  };
+
+  void shard_read_finish(int shard, int r) {
+    std::unique_lock l(lock);
+    reads.at(shard).r = r;
+    if (--pending) {
+      return;
+    }
+    l.unlock();
+    // a shard op may complete with the objecter locked
+    boost::asio::post(objecter->service, [this] { finish(); });
+  }
+
+  void fall_back() {
+    lgeneric_subdout(objecter->cct, objecter, 10)
+      << "ec direct read " << oid << " falling back to the primary"
+      << dendl;
+    objecter->read(oid, oloc, off, len, CEPH_NOSNAP, pbl, flags, onfinish,
+		   objver);
+    delete this;
+  }
+
+  void finish() {
+    auto cct = objecter->cct;
+    int inject_error =
+      cct->_conf.get_val<int64_t>("rados_ec_direct_read_inject_error");
+    if (inject_error) {
+      reads.begin()->second.r = inject_error;
+    }
+    if (reads.size() > 1 &&
+	cct->_conf.get_val<bool>(
+	  "rados_ec_direct_read_inject_version_mismatch")) {
+      ++reads.rbegin()->second.version;
+    }
+
+    const ShardRead *first = nullptr;
+    for (auto& [shard, read] : reads) {
+      if (read.r < 0) {
+	lgeneric_subdout(cct, objecter, 10)
+	  << "ec direct read " << oid << " shard " << shard
+	  << " returned " << read.r << dendl;
+	return fall_back();
+      }
+      // the shards must agree on what they returned
+      if (first && (read.version != first->version ||
+		    read.size != first->size)) {
+	lgeneric_subdout(cct, objecter, 10)
+	  << "ec direct read " << oid << " shards disagree" << dendl;
+	return fall_back();
+      }
+      first = &read;
+    }
+    ceph_assert(first);
+
+    uint64_t size = first->size;
+    bufferlist result;
+    if (off < size) {
+      uint64_t end = std::min(off + len, size);
+      uint64_t stripe_width = chunk_size * want.size();
+      uint64_t stripes = (end - stripe_off + stripe_width - 1) / stripe_width;
+      for (auto& [shard, read] : reads) {
+	if (read.bl.length() < stripes * chunk_size) {
+	  lgeneric_subdout(cct, objecter, 10)
+	    << "ec direct read " << oid << " shard " << shard
+	    << " is short" << dendl;
+	  return fall_back();
+	}
+      }
+      bufferlist stripes_bl;
+      for (uint64_t i = 0; i < stripes; ++i) {
+	std::map<int, bufferlist> chunks;
+	for (auto& [shard, read] : reads) {
+	  chunks[shard].substr_of(read.bl, i * chunk_size, chunk_size);
+	}
+	std::map<int, bufferlist> decoded;
+	int r = ec_impl->decode(want, chunks, &decoded, chunk_size);
+	if (r < 0) {
+	  lgeneric_subdout(cct, objecter, 1)
+	    << "ec direct read " << oid << " decode failed: " << r << dendl;
+	  return fall_back();
+	}
+	for (int shard : want) {
+	  stripes_bl.claim_append(decoded[shard]);
+	}
+      }
+      result.substr_of(stripes_bl, off - stripe_off, end - off);
+    }
+
+    if (objver) {
+      *objver = first->version;
+    }
+    if (pbl) {
+      pbl->claim_append(result);
+    }
+    onfinish->complete(0);
+    delete this;
+  }
+};
+
+void Objecter::read_ec_direct(const object_t& oid,
+			      const object_locator_t& oloc,
+			      uint64_t off, uint64_t len, bufferlist *pbl,
+			      int flags, Context *onfinish, version_t *objver)
+{
+  auto rd = new ECDirectRead(this, oid, oloc, off, len, pbl, flags,
+			     onfinish, objver);
+  std::set<int> shards;
+  {
+    shared_lock rl(rwlock);
+    const pg_pool_t *pi = osdmap->get_pg_pool(oloc.pool);
+    if (pi && pi->is_erasure() && len) {
+      rd->ec_impl = get_ec_impl(
+	pi->erasure_code_profile,
+	osdmap->get_erasure_code_profile(pi->erasure_code_profile));
+    }
+    if (rd->ec_impl && rd->ec_impl->get_chunk_mapping().empty()) {
+      unsigned k = rd->ec_impl->get_data_chunk_count();
+      rd->chunk_size = pi->get_stripe_width() / k;
+      for (unsigned i = 0; i < k; ++i) {
+	rd->want.insert(i);
+      }
+
+      // the shards that are up now; degraded pgs decode from the
+      // coding shards, as long as there are enough of them
+      pg_t pgid;
+      vector<int> acting;
+      std::set<int> available;
+      int down_shard = cct->_conf.get_val<int64_t>(
+	"rados_ec_direct_read_inject_down_shard");
+      if (osdmap->object_locator_to_pg(oid, oloc, pgid) == 0) {
+	osdmap->pg_to_acting_osds(osdmap->raw_pg_to_pg(pgid), acting);
+	for (unsigned i = 0; i < acting.size(); ++i) {
+	  if (acting[i] != CRUSH_ITEM_NONE && osdmap->is_up(acting[i]) &&
+	      (int)i != down_shard) {
+	    available.insert(i);
+	  }
+	}
+      }
+      std::map<int, std::vector<std::pair<int, int>>> minimum;
+      if (rd->chunk_size &&
+	  rd->ec_impl->minimum_to_decode(rd->want, available, &minimum) == 0) {
+	for (auto& i : minimum) {
+	  // an osd without shard reads would serve the op as a read of
+	  // the whole object (if it is the primary) or never answer it
+	  if (!HAVE_FEATURE(osdmap->get_xinfo(acting[i.first]).features,
+			    OSD_EC_SHARD_READ)) {
+	    ldout(cct, 10) << __func__ << " osd." << acting[i.first]
+			   << " can't serve shard reads" << dendl;
+	    shards.clear();
+	    break;
+	  }
+	  shards.insert(i.first);
+	}
+      }
+    }
+  }
+  if (shards.empty()) {
+    return rd->fall_back();
+  }
+
+  uint64_t stripe_width = rd->chunk_size * rd->want.size();
+  rd->stripe_off = off - off % stripe_width;
+  uint64_t stripe_end = off + len + stripe_width - 1;
+  stripe_end -= stripe_end % stripe_width;
+  uint64_t chunk_off = rd->stripe_off / stripe_width * rd->chunk_size;
+  uint64_t chunk_len = (stripe_end - rd->stripe_off) / stripe_width *
+    rd->chunk_size;
+  ldout(cct, 10) << __func__ << " " << oid << " " << off << "~" << len
+		 << " from shards " << shards << " chunks " << chunk_off
+		 << "~" << chunk_len << dendl;
+
+  // rd may be gone as soon as the last op is submitted
+  vector<Op*> ops;
+  rd->pending = shards.size();
+  for (int shard : shards) {
+    auto& read = rd->reads[shard];
+    ObjectOperation op;
+    op.stat(&read.size, nullptr, nullptr);
+    op.read(chunk_off, chunk_len, &read.bl, nullptr, nullptr);
+    Op *o = prepare_read_op(oid, oloc, op, CEPH_NOSNAP, nullptr,
+			    flags | CEPH_OSD_FLAG_EC_SHARD_READ,
+			    new ECDirectRead::C_ShardRead(rd, shard),
+			    &read.version);
+    o->target.ec_shard = shard;
+    ops.push_back(o);
+  }
+  for (auto o : ops) {
+    op_submit(o);
+  }
+}
+
 int Objecter::op_cancel(OSDSession *s, ceph_tid_t tid, int r)
 {
   ceph_assert(initialized);
@@ -2923,7 +3244,9 @@ int Objecter::_calc_target(op_target_t *t, Connection *con, bool any_change)
     t->pg_num_mask = pg_num_mask;
     t->pg_num_pending = pg_num_pending;
     spg_t spgid(actual_pgid);
-    if (pi->is_erasure()) {
+    if (pi->is_erasure() && t->ec_shard >= 0) {
+      spgid.reset_shard(shard_id_t(t->ec_shard));
+    } else if (pi->is_erasure()) {
       for (uint8_t i = 0; i < t->acting.size(); ++i) {
         if (t->acting[i] == acting_primary) {
           spgid.reset_shard(shard_id_t(i));
@@ -2943,9 +3266,23 @@ int Objecter::_calc_target(op_target_t *t, Connection *con, bool any_change)
 		   << " acting " << t->acting
 		   << " primary " << acting_primary << dendl;
     t->used_replica = false;
-    if ((t->flags & (CEPH_OSD_FLAG_BALANCE_READS |
-                     CEPH_OSD_FLAG_LOCALIZE_READS)) &&
-        !is_write && pi->is_replicated() && t->acting.size() > 1) {
+    if (t->ec_shard >= 0) {
+      // whichever osd holds the shard now, if any; any change to the
+      // acting set sends the op back to its reader
+      ceph_assert(is_read && !is_write);
+      t->used_replica = true;
+      if ((unsigned)t->ec_shard < t->acting.size() &&
+	  t->acting[t->ec_shard] != CRUSH_ITEM_NONE &&
+	  osdmap->is_up(t->acting[t->ec_shard])) {
+	t->osd = t->acting[t->ec_shard];
+      } else {
+	t->osd = -1;
+      }
+      ldout(cct, 10) << " ec shard " << t->ec_shard << " on osd." << t->osd
+		     << dendl;
+    } else if ((t->flags & (CEPH_OSD_FLAG_BALANCE_READS |
+			    CEPH_OSD_FLAG_LOCALIZE_READS)) &&
+	       !is_write && pi->is_replicated() && t->acting.size() > 1) {
       int osd;
       ceph_assert(is_read && t->acting[0] == acting_primary);
       if (t->flags & CEPH_OSD_FLAG_BALANCE_READS) {
@@ -3454,7 +3791,7 @@ void Objecter::handle_osd_op_reply(MOSDOpReply *m)
     return;
   }
 
-  if (rc == -EAGAIN) {
+  if (rc == -EAGAIN && op->target.ec_shard < 0) {
     ldout(cct, 7) << " got -EAGAIN, resubmitting" << dendl;
     if (op->has_completion())
       num_in_flight--;
@@ -4492,6 +4829,9 @@ void Objecter::op_target_t::dump(Formatter *f) const
   f->dump_int("paused", (int)paused);
   f->dump_int("used_replica", (int)used_replica);
   f->dump_int("precalc_pgid", (int)precalc_pgid);
+  if (ec_shard >= 0) {
+    f->dump_int("ec_shard", ec_shard);
+  }
 }
 
 void Objecter::_dump_active(OSDSession *s)
@@ -58,6 +58,10 @@
 
 #include "osd/OSDMap.h"
 
+namespace ceph {
+  class ErasureCodeInterface;
+}
+
 class Context;
 class Messenger;
 class MonClient;
@@ -1796,6 +1800,8 @@ public:
     bool used_replica = false;
     bool paused = false;
 
+    int ec_shard = -1; ///< EC shard to read directly, if any
+
     int osd = -1;      ///< the final target osd, or -1
 
     epoch_t last_force_resend = 0;
@@ -2519,6 +2525,7 @@ public:
 private:
   void _check_op_pool_dne(Op *op, std::unique_lock<std::shared_mutex> *sl);
   void _check_op_pool_eio(Op *op, std::unique_lock<std::shared_mutex> *sl);
+  void _fail_ec_shard_op(Op *op, std::unique_lock<std::shared_mutex> *sl);
   void _send_op_map_check(Op *op);
   void _op_cancel_map_check(Op *op);
   void _check_linger_pool_dne(LingerOp *op, bool *need_unregister);
@@ -3343,6 +3350,27 @@ public:
 		CEPH_OSD_FLAG_READ, onfinish, objver, extra_ops);
   }
 
+  /// whether read_ec_direct() should be used for a read of len bytes
+  bool wants_ec_direct_read(int64_t pool, uint64_t len);
+  /**
+   * Read an extent of the head of an object in an erasure coded pool
+   * straight from the OSDs holding its shards, and put it together here
+   * instead of on the primary.  Falls back to a normal read through the
+   * primary whenever a shard can't serve it.
+   */
+  void read_ec_direct(const object_t& oid, const object_locator_t& oloc,
+		      uint64_t off, uint64_t len, ceph::buffer::list *pbl,
+		      int flags, Context *onfinish, version_t *objver = nullptr);
+private:
+  struct ECDirectRead;
+  ceph::mutex ec_impl_lock = ceph::make_mutex("Objecter::ec_impl_lock");
+  /// by profile name; a profile can't change while a pool uses it
+  std::map<std::string, std::shared_ptr<ceph::ErasureCodeInterface>> ec_impls;
+  std::shared_ptr<ceph::ErasureCodeInterface> get_ec_impl(
+    const std::string& name,
+    const std::map<std::string, std::string>& profile);
+public:
+
 
   // writes
   ceph_tid_t _modify(const object_t& oid, const object_locator_t& oloc,
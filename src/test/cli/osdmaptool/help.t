@@ -22,6 +22,8 @@
      --test-random           do random placements
      --test-map-pg <pgid>    map a pgid to osds
      --test-map-object <objectname> [--pool <poolid>] map an object to osds
+     --test-map-objects <file> [--pool <poolid>] map the objects named in <file>,
+                             one per line, to osds [- for stdin]
      --upmap-cleanup <file>  clean up pg_upmap[_items] entries, writing
                              commands to <file> [default: - for stdout]
      --upmap <file>          calculate pg upmap entries to balance pg layout
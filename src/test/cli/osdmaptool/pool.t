@@ -28,6 +28,19 @@
   osdmaptool: assuming pool 1 (use --pool to override)
    object 'foo' \-\> 1\..* (re)
 
+#
+# --test-map-objects / --pool
+#
+  $ printf 'foo\nbar\n' > objects
+  $ osdmaptool myosdmap --test-map-objects objects --pool 123
+  osdmaptool: osdmap file 'myosdmap'
+  There is no pool 123
+  [1]
+
+  $ osdmaptool myosdmap --test-map-objects objects --pool 1 > batch
+  $ (osdmaptool myosdmap --test-map-object foo --pool 1; osdmaptool myosdmap --test-map-object bar --pool 1) | grep object > single
+  $ grep object batch | diff - single
+
 #
 # --test-map-pgs / --pool
 #
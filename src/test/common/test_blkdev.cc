@@ -100,6 +100,39 @@ TEST(blkdev, _decode_model_enc)
   }
 }
 
+TEST(blkdev, _parse_device_io_ticks)
+{
+  uint64_t ms = 0;
+  // a 4.18+ kernel (with discard and flush fields)
+  ASSERT_EQ(0, _parse_device_io_ticks(
+    "  183622     3651 11594198   101338   194585   216003 18030616   553893"
+    "        0   198452   655231        0        0        0        0"
+    "    12345     9876\n", &ms));
+  ASSERT_EQ(198452u, ms);
+  // a pre-4.18 kernel only has the first 11 fields
+  ASSERT_EQ(0, _parse_device_io_ticks(
+    "1 2 3 4 5 6 7 8 9 10 11\n", &ms));
+  ASSERT_EQ(10u, ms);
+  // counters are unsigned long on the kernel side
+  ASSERT_EQ(0, _parse_device_io_ticks(
+    "0 0 0 0 0 0 0 0 0 18446744073709551615 0\n", &ms));
+  ASSERT_EQ(18446744073709551615ull, ms);
+
+  ms = 7;
+  ASSERT_EQ(-EINVAL, _parse_device_io_ticks("", &ms));
+  ASSERT_EQ(-EINVAL, _parse_device_io_ticks("1 2 3 4 5 6 7 8 9\n", &ms));
+  ASSERT_EQ(-EINVAL, _parse_device_io_ticks("1 2 3 4 x 6 7 8 9 10 11\n", &ms));
+  ASSERT_EQ(7u, ms);
+}
+
+TEST_F(BlockDevTest, device_io_ticks)
+{
+  uint64_t ms = 0;
+  ASSERT_EQ(0, get_device_io_ticks("sda", &ms, root->c_str()));
+  ASSERT_EQ(198452u, ms);
+  ASSERT_EQ(-ENOENT, get_device_io_ticks("nosuchdev", &ms, root->c_str()));
+}
+
 TEST(blkdev, get_device_id)
 {
   // this doesn't really test anything; it's just a way to exercise the
@@ -0,0 +1,107 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#include "common/shared_intrusive_lru.h"
+#include "global/global_context.h"
+
+struct TestItem : SharedIntrusiveLRUItem<unsigned, TestItem> {
+  unsigned value = 0;
+};
+
+using TestLRU = SharedIntrusiveLRU<unsigned, TestItem>;
+
+TEST(SharedIntrusiveLRU, lookup_or_create) {
+  TestLRU cache(g_ceph_context, 10, 2);
+  auto a = cache.lookup_or_create(1);
+  a->value = 1;
+  ASSERT_EQ(a, cache.lookup_or_create(1));
+  ASSERT_EQ(a, cache.lookup(1));
+  ASSERT_EQ(1, cache.get_count());
+  ASSERT_FALSE(cache.lookup(2));
+}
+
+TEST(SharedIntrusiveLRU, trim) {
+  TestLRU cache(g_ceph_context, 4, 1);
+  for (unsigned i = 0; i < 10; ++i) {
+    cache.lookup_or_create(i);
+  }
+  ASSERT_EQ(4, cache.get_count());
+  // the oldest values had no other refs and are gone
+  ASSERT_FALSE(cache.lookup(0));
+  ASSERT_TRUE(cache.lookup(9));
+  cache.set_size(1);
+  ASSERT_EQ(1, cache.get_count());
+  cache.clear();
+  ASSERT_EQ(0, cache.get_count());
+  ASSERT_TRUE(cache.empty());
+}
+
+TEST(SharedIntrusiveLRU, referenced_values_outlive_lru) {
+  TestLRU cache(g_ceph_context, 1, 1);
+  auto pinned = cache.lookup_or_create(1);
+  pinned->value = 42;
+  cache.lookup_or_create(2);
+  cache.lookup_or_create(3);
+  auto again = cache.lookup(1);
+  ASSERT_EQ(pinned, again);
+  ASSERT_EQ(42u, again->value);
+  pinned.reset();
+  again.reset();
+  cache.clear();
+  ASSERT_TRUE(cache.empty());
+}
+
+TEST(SharedIntrusiveLRU, get_next) {
+  TestLRU cache(g_ceph_context, 100, 4);
+  std::vector<std::shared_ptr<TestItem>> refs;
+  for (unsigned i = 10; i < 20; i += 2) {
+    refs.push_back(cache.lookup_or_create(i));
+  }
+  std::pair<unsigned, std::shared_ptr<TestItem>> next{0, nullptr};
+  std::vector<unsigned> seen;
+  while (cache.get_next(next.first, &next)) {
+    seen.push_back(next.first);
+  }
+  ASSERT_EQ(std::vector<unsigned>({10, 12, 14, 16, 18}), seen);
+  ASSERT_TRUE(cache.get_next(13, &next));
+  ASSERT_EQ(14u, next.first);
+  ASSERT_FALSE(cache.get_next(18, nullptr));
+}
+
+TEST(SharedIntrusiveLRU, clear_range) {
+  TestLRU cache(g_ceph_context, 100, 4);
+  for (unsigned i = 0; i < 10; ++i) {
+    cache.lookup_or_create(i);
+  }
+  auto pinned = cache.lookup(5);
+  cache.clear_range(3, 6);
+  ASSERT_EQ(6, cache.get_count());
+  ASSERT_FALSE(cache.lookup(3));
+  ASSERT_FALSE(cache.lookup(6));
+  ASSERT_TRUE(cache.lookup(7));
+  ASSERT_EQ(pinned, cache.lookup(5));
+}
+
+TEST(SharedIntrusiveLRU, concurrent) {
+  TestLRU cache(g_ceph_context, 16, 4);
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < 4; ++t) {
+    threads.emplace_back([&cache] {
+      for (unsigned i = 0; i < 10000; ++i) {
+	auto v = cache.lookup_or_create(i % 64);
+	ASSERT_EQ(v, cache.lookup(i % 64));
+	if (i % 100 == 0) {
+	  cache.clear_range(0, 32);
+	}
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  cache.clear();
+  ASSERT_TRUE(cache.empty());
+}
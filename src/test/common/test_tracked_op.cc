@@ -0,0 +1,124 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "gtest/gtest.h"
+
+#include "common/Formatter.h"
+#include "common/TrackedOp.h"
+#include "global/global_context.h"
+
+using namespace std;
+
+class TestOp : public TrackedOp {
+public:
+  typedef boost::intrusive_ptr<TestOp> Ref;
+
+  explicit TestOp(OpTracker *tracker)
+    : TrackedOp(tracker, utime_t(100, 0)) {}
+
+  using TrackedOp::get_events;
+
+  // the names of the events recorded so far
+  vector<string> get_event_names() const {
+    vector<string> names;
+    for (auto& e : get_events()) {
+      names.push_back(e.str);
+    }
+    return names;
+  }
+
+private:
+  void _dump(ceph::Formatter *f) const override {
+    f->open_array_section("events");
+    for (auto& e : get_events()) {
+      f->open_object_section("event");
+      e.dump(f);
+      f->close_section();
+    }
+    f->close_section();
+  }
+  void _dump_op_descriptor_unlocked(ostream& stream) const override {
+    stream << "test_op";
+  }
+};
+
+class TrackedOpTest : public ::testing::Test {
+protected:
+  OpTracker tracker{g_ceph_context, true, 1};
+
+  TestOp::Ref create_op() {
+    TestOp::Ref op(new TestOp(&tracker));
+    op->tracking_start();
+    return op;
+  }
+
+  void TearDown() override {
+    tracker.on_shutdown();
+  }
+};
+
+TEST_F(TrackedOpTest, slots)
+{
+  auto op = create_op();
+  ASSERT_EQ(vector<string>{"initiated"}, op->get_event_names());
+  ASSERT_EQ("initiated", op->state_string());
+
+  op->mark_event("queued_for_pg", utime_t(101, 0));
+  op->mark_event("reached_pg", utime_t(102, 0));
+  ASSERT_EQ((vector<string>{"initiated", "queued_for_pg", "reached_pg"}),
+	    op->get_event_names());
+  ASSERT_EQ("reached_pg", op->state_string());
+  auto events = op->get_events();
+  ASSERT_EQ(utime_t(100, 0), events[0].stamp);
+  ASSERT_EQ(utime_t(102, 0), events[2].stamp);
+
+  op->mark_event("done", utime_t(103, 500000000));
+  ASSERT_EQ("done", op->state_string());
+  ASSERT_DOUBLE_EQ(3.5, op->get_duration());
+}
+
+TEST_F(TrackedOpTest, spill)
+{
+  auto op = create_op();
+  vector<string> expected{"initiated"};
+  // an event too long for a slot goes to the spill list, but keeps its place
+  string long_event(OPTRACKER_EVENT_LEN, 'x');
+  op->mark_event(long_event);
+  expected.push_back(long_event);
+  ASSERT_EQ(long_event, op->state_string());
+  // more events than there are slots
+  for (unsigned i = 0; i < OPTRACKER_PREALLOC_EVENTS + 5; ++i) {
+    string event = "event " + std::to_string(i);
+    op->mark_event(event);
+    expected.push_back(event);
+    ASSERT_EQ(event, op->state_string());
+  }
+  ASSERT_EQ(expected, op->get_event_names());
+}
+
+TEST_F(TrackedOpTest, dump)
+{
+  auto op = create_op();
+  op->mark_event("queued_for_pg");
+  for (unsigned i = 0; i < OPTRACKER_PREALLOC_EVENTS; ++i) {
+    op->mark_event("spilled " + std::to_string(i));
+  }
+
+  ceph::JSONFormatter f;
+  ASSERT_TRUE(tracker.dump_ops_in_flight(&f));
+  ostringstream out;
+  f.flush(out);
+  string dump = out.str();
+  ASSERT_NE(string::npos, dump.find("\"description\":\"test_op\""));
+  // in the order they were marked
+  auto initiated = dump.find("\"event\":\"initiated\"");
+  auto queued = dump.find("\"event\":\"queued_for_pg\"");
+  auto last = dump.find("\"event\":\"spilled " +
+			std::to_string(OPTRACKER_PREALLOC_EVENTS - 1) + "\"");
+  ASSERT_NE(string::npos, initiated);
+  ASSERT_NE(string::npos, queued);
+  ASSERT_NE(string::npos, last);
+  ASSERT_LT(initiated, queued);
+  ASSERT_LT(queued, last);
+  ASSERT_NE(string::npos, dump.find("\"num_ops\":1"));
+}
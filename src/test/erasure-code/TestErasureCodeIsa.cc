@@ -368,6 +368,135 @@ TEST_F(IsaErasureCodeTest, encode)
   }
 }
 
+TEST_F(IsaErasureCodeTest, apply_delta)
+{
+  for (const char *m : { "1", "2" }) {
+    ErasureCodeIsaDefault Isa(tcache);
+    ErasureCodeProfile profile;
+    profile["k"] = "3";
+    profile["m"] = m;
+    Isa.init(profile, &cerr);
+    int k = Isa.get_data_chunk_count();
+    int n = Isa.get_chunk_count();
+
+    unsigned object_size = Isa.get_chunk_size(4096) * k;
+    bufferlist in;
+    for (unsigned i = 0; i < object_size; i++)
+      in.append((char)(i * 13 + 5));
+    set<int> want_to_encode;
+    for (int i = 0; i < n; i++)
+      want_to_encode.insert(i);
+    map<int, bufferlist> encoded;
+    EXPECT_EQ(0, Isa.encode(want_to_encode, in, &encoded));
+    unsigned length = encoded[0].length();
+
+    // the coding chunks updated with the delta of one data chunk
+    // must match a full encode of the new data
+    for (int chunk = 0; chunk < k; chunk++) {
+      bufferlist new_data;
+      new_data.append(string(length, 'a' + chunk));
+      bufferlist delta;
+      EXPECT_EQ(0, Isa.encode_delta(encoded[chunk], new_data, &delta));
+      map<int, bufferlist> coding;
+      for (int i = k; i < n; i++)
+	coding[i].append(encoded[i].c_str(), length);
+      EXPECT_EQ(0, Isa.apply_delta(chunk, delta, &coding));
+
+      bufferlist updated;
+      for (int i = 0; i < k; i++)
+	updated.append(i == chunk ? new_data : encoded[i]);
+      map<int, bufferlist> reencoded;
+      EXPECT_EQ(0, Isa.encode(want_to_encode, updated, &reencoded));
+      for (int i = k; i < n; i++)
+	EXPECT_TRUE(coding[i].contents_equal(reencoded[i]));
+    }
+  }
+}
+
+TEST_F(IsaErasureCodeTest, encode_decode_fragmented)
+{
+  for (const char *m : { "1", "2" }) {
+    ErasureCodeIsaDefault Isa(tcache);
+    ErasureCodeProfile profile;
+    profile["k"] = "3";
+    profile["m"] = m;
+    Isa.init(profile, &cerr);
+    int k = Isa.get_data_chunk_count();
+    int n = Isa.get_chunk_count();
+    unsigned alignment = Isa.get_segment_alignment();
+
+    unsigned object_size = Isa.get_chunk_size(4096) * k;
+    bufferlist in, fragmented;
+    for (unsigned off = 0; off < object_size; off += alignment) {
+      bufferptr buf(buffer::create_aligned(alignment, EC_ISA_ADDRESS_ALIGNMENT));
+      for (unsigned i = 0; i < alignment; i++)
+	buf.c_str()[i] = (char)((off + i) * 13 + 5);
+      fragmented.append(buf);
+      in.append(buf.c_str(), alignment);
+    }
+
+    set<int> want_to_encode;
+    for (int i = 0; i < n; i++)
+      want_to_encode.insert(i);
+    map<int, bufferlist> encoded, fragmented_encoded;
+    EXPECT_EQ(0, Isa.encode(want_to_encode, in, &encoded));
+    EXPECT_EQ(0, Isa.encode(want_to_encode, fragmented, &fragmented_encoded));
+    EXPECT_FALSE(fragmented_encoded[0].is_contiguous());
+    for (int i = 0; i < n; i++)
+      EXPECT_TRUE(encoded[i].contents_equal(fragmented_encoded[i]));
+
+    map<int, bufferlist> chunks = fragmented_encoded;
+    chunks.erase(1);
+    set<int> want_to_decode = { 1 };
+    map<int, bufferlist> decoded;
+    EXPECT_EQ(0, Isa._decode(want_to_decode, chunks, &decoded));
+    EXPECT_TRUE(encoded[1].contents_equal(decoded[1]));
+  }
+}
+
+TEST_F(IsaErasureCodeTest, encode_decode_stripes)
+{
+  ErasureCodeIsaDefault Isa(tcache);
+  ErasureCodeProfile profile;
+  profile["k"] = "4";
+  profile["m"] = "2";
+  Isa.init(profile, &cerr);
+  int k = Isa.get_data_chunk_count();
+  int n = Isa.get_chunk_count();
+  unsigned chunk_size = Isa.get_chunk_size(k * 64);
+  unsigned stripes = 7;
+
+  bufferlist in;
+  for (unsigned i = 0; i < stripes * chunk_size * k; i++)
+    in.append((char)(i * 3 + 1));
+  set<int> want_to_encode;
+  for (int i = 0; i < n; i++)
+    want_to_encode.insert(i);
+  map<int, bufferlist> encoded;
+  EXPECT_EQ(0, Isa.encode_stripes(want_to_encode, in, chunk_size, &encoded));
+  map<int, bufferlist> expected;
+  for (unsigned s = 0; s < stripes; s++) {
+    bufferlist stripe;
+    stripe.substr_of(in, s * chunk_size * k, chunk_size * k);
+    map<int, bufferlist> chunks;
+    EXPECT_EQ(0, Isa.encode(want_to_encode, stripe, &chunks));
+    for (auto &[i, chunk] : chunks)
+      expected[i].claim_append(chunk);
+  }
+  for (int i = 0; i < n; i++)
+    EXPECT_TRUE(expected[i].contents_equal(encoded[i]));
+
+  map<int, bufferlist> chunks = encoded;
+  chunks.erase(1);
+  chunks.erase(4);
+  set<int> want_to_decode = { 1, 4 };
+  map<int, bufferlist> decoded;
+  EXPECT_EQ(0, Isa.decode_stripes(want_to_decode, chunks, chunk_size,
+				  &decoded));
+  EXPECT_TRUE(expected[1].contents_equal(decoded[1]));
+  EXPECT_TRUE(expected[4].contents_equal(decoded[4]));
+}
+
 TEST_F(IsaErasureCodeTest, sanity_check_k)
 {
   ErasureCodeIsaDefault Isa(tcache);
@@ -20,6 +20,7 @@
 
 #include "crush/CrushWrapper.h"
 #include "include/stringify.h"
+#include "erasure-code/ErasureCodeDecodeCache.h"
 #include "erasure-code/jerasure/ErasureCodeJerasure.h"
 #include "global/global_context.h"
 #include "common/config.h"
@@ -130,6 +131,214 @@ TYPED_TEST(ErasureCodeTest, encode_decode)
   }
 }
 
+TYPED_TEST(ErasureCodeTest, apply_delta)
+{
+  TypeParam jerasure;
+  ErasureCodeProfile profile;
+  profile["k"] = "2";
+  profile["m"] = "2";
+  profile["packetsize"] = "8";
+  jerasure.init(profile, &cerr);
+  EXPECT_EQ((uint64_t)ErasureCodeInterface::FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION,
+	    jerasure.get_supported_optimizations());
+
+  unsigned object_size = jerasure.get_chunk_size(4096) * 2;
+  bufferlist in;
+  for (unsigned i = 0; i < object_size; i++)
+    in.append((char)(i * 7 + 3));
+  set<int> want_to_encode = { 0, 1, 2, 3 };
+  map<int, bufferlist> encoded;
+  EXPECT_EQ(0, jerasure.encode(want_to_encode, in, &encoded));
+  unsigned length = encoded[0].length();
+
+  // overwrite each data chunk in turn and update the coding chunks
+  // with the delta: they must match a full encode of the new data
+  for (int chunk = 0; chunk < 2; chunk++) {
+    bufferlist new_data;
+    new_data.append(string(length, 'A' + chunk));
+    bufferlist delta;
+    EXPECT_EQ(0, jerasure.encode_delta(encoded[chunk], new_data, &delta));
+    EXPECT_EQ(length, delta.length());
+    map<int, bufferlist> coding;
+    coding[2].append(encoded[2].c_str(), length);
+    coding[3].append(encoded[3].c_str(), length);
+    EXPECT_EQ(0, jerasure.apply_delta(chunk, delta, &coding));
+
+    bufferlist updated;
+    for (int i = 0; i < 2; i++)
+      updated.append(i == chunk ? new_data : encoded[i]);
+    map<int, bufferlist> reencoded;
+    EXPECT_EQ(0, jerasure.encode(want_to_encode, updated, &reencoded));
+    EXPECT_TRUE(coding[2].contents_equal(reencoded[2]));
+    EXPECT_TRUE(coding[3].contents_equal(reencoded[3]));
+  }
+
+  bufferlist short_data;
+  short_data.append(string(length - 1, 'X'));
+  bufferlist delta;
+  EXPECT_EQ(-EINVAL, jerasure.encode_delta(encoded[0], short_data, &delta));
+  map<int, bufferlist> coding;
+  coding[2] = encoded[2];
+  EXPECT_EQ(-EINVAL, jerasure.apply_delta(0, encoded[0], &coding));
+}
+
+TYPED_TEST(ErasureCodeTest, encode_decode_fragmented)
+{
+  TypeParam jerasure;
+  ErasureCodeProfile profile;
+  profile["k"] = "2";
+  profile["m"] = "2";
+  profile["packetsize"] = "8";
+  jerasure.init(profile, &cerr);
+  unsigned alignment = jerasure.get_segment_alignment();
+  ASSERT_NE(0u, alignment);
+
+  unsigned object_size = jerasure.get_chunk_size(alignment * 8) * 2;
+  ASSERT_EQ(0u, object_size / 2 % alignment);
+  bufferlist in, fragmented;
+  for (unsigned off = 0; off < object_size; off += alignment) {
+    bufferptr buf(buffer::create_aligned(alignment, ErasureCode::SIMD_ALIGN));
+    for (unsigned i = 0; i < alignment; i++)
+      buf.c_str()[i] = (char)((off + i) * 11 + 1);
+    fragmented.append(buf);
+    in.append(buf.c_str(), alignment);
+  }
+  in.rebuild_aligned(ErasureCode::SIMD_ALIGN);
+
+  // the data chunks are encoded where they are, without being copied
+  set<int> want_to_encode = { 0, 1, 2, 3 };
+  map<int, bufferlist> encoded, fragmented_encoded;
+  EXPECT_EQ(0, jerasure.encode(want_to_encode, in, &encoded));
+  EXPECT_EQ(0, jerasure.encode(want_to_encode, fragmented,
+			       &fragmented_encoded));
+  EXPECT_FALSE(fragmented_encoded[0].is_contiguous());
+  EXPECT_EQ(fragmented.front().c_str(), fragmented_encoded[0].front().c_str());
+  for (int i = 0; i < 4; i++)
+    EXPECT_TRUE(encoded[i].contents_equal(fragmented_encoded[i]));
+
+  // and decoded from there too
+  map<int, bufferlist> chunks = fragmented_encoded;
+  chunks.erase(0);
+  chunks.erase(2);
+  set<int> want_to_decode = { 0, 2 };
+  map<int, bufferlist> decoded;
+  EXPECT_EQ(0, jerasure._decode(want_to_decode, chunks, &decoded));
+  EXPECT_TRUE(encoded[0].contents_equal(decoded[0]));
+  EXPECT_TRUE(encoded[2].contents_equal(decoded[2]));
+}
+
+TYPED_TEST(ErasureCodeTest, encode_decode_stripes)
+{
+  TypeParam jerasure;
+  ErasureCodeProfile profile;
+  profile["k"] = "2";
+  profile["m"] = "2";
+  profile["packetsize"] = "8";
+  jerasure.init(profile, &cerr);
+  unsigned chunk_size =
+    jerasure.get_chunk_size(jerasure.get_segment_alignment() * 2);
+  unsigned stripes = 5;
+
+  bufferlist in;
+  for (unsigned i = 0; i < stripes * chunk_size * 2; i++)
+    in.append((char)(i * 5 + 7));
+
+  // all the stripes at once encode to what one stripe at a time does
+  set<int> want_to_encode = { 0, 1, 2, 3 };
+  map<int, bufferlist> encoded;
+  EXPECT_EQ(0, jerasure.encode_stripes(want_to_encode, in, chunk_size,
+				       &encoded));
+  map<int, bufferlist> expected;
+  for (unsigned s = 0; s < stripes; s++) {
+    bufferlist stripe;
+    stripe.substr_of(in, s * chunk_size * 2, chunk_size * 2);
+    map<int, bufferlist> chunks;
+    EXPECT_EQ(0, jerasure.encode(want_to_encode, stripe, &chunks));
+    for (auto &[i, chunk] : chunks)
+      expected[i].claim_append(chunk);
+  }
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(stripes * chunk_size, encoded[i].length());
+    EXPECT_TRUE(expected[i].contents_equal(encoded[i]));
+  }
+
+  map<int, bufferlist> chunks = encoded;
+  chunks.erase(0);
+  chunks.erase(3);
+  set<int> want_to_decode = { 0, 3 };
+  map<int, bufferlist> decoded;
+  EXPECT_EQ(0, jerasure.decode_stripes(want_to_decode, chunks, chunk_size,
+				       &decoded));
+  EXPECT_TRUE(expected[0].contents_equal(decoded[0]));
+  EXPECT_TRUE(expected[3].contents_equal(decoded[3]));
+
+  EXPECT_EQ(-EINVAL, jerasure.encode_stripes(want_to_encode, in,
+					     chunk_size + 1, &encoded));
+}
+
+TYPED_TEST(ErasureCodeTest, decode_plan_cache)
+{
+  TypeParam jerasure;
+  ErasureCodeProfile profile;
+  profile["k"] = "3";
+  profile["m"] = "2";
+  profile["packetsize"] = "8";
+  jerasure.init(profile, &cerr);
+  ErasureCodeDecodeCache &cache = ErasureCodeDecodeCache::instance();
+  cache.clear();
+
+  bufferlist in;
+  for (unsigned i = 0; i < 3 * 1024; i++)
+    in.append((char)(i * 3 + 1));
+  set<int> want_to_encode = { 0, 1, 2, 3, 4 };
+  map<int, bufferlist> encoded;
+  EXPECT_EQ(0, jerasure.encode(want_to_encode, in, &encoded));
+
+  // each set of erasures gets its plan once, and decodes the same with
+  // it as without it
+  vector<set<int>> erasures_list = {
+    { 0 }, { 4 }, { 0, 1 }, { 1, 3 }, { 3, 4 }
+  };
+  for (int round = 0; round < 2; round++) {
+    for (auto &erasures : erasures_list) {
+      map<int, bufferlist> chunks = encoded;
+      for (int i : erasures)
+	chunks.erase(i);
+      map<int, bufferlist> decoded;
+      EXPECT_EQ(0, jerasure._decode(erasures, chunks, &decoded));
+      for (int i : erasures)
+	EXPECT_TRUE(encoded[i].contents_equal(decoded[i]));
+    }
+    EXPECT_EQ(erasures_list.size(), cache.size());
+  }
+  cache.clear();
+}
+
+TEST(ErasureCodeDecodeCache, lru)
+{
+  struct Plan : public ErasureCodeDecodeCache::Plan {
+    int n;
+    explicit Plan(int n) : n(n) {}
+  };
+  ErasureCodeDecodeCache cache(2);
+  auto make = [](int n) {
+    return [n] { return std::make_shared<const Plan>(n); };
+  };
+  EXPECT_EQ(1, cache.lookup<Plan>("a", make(1))->n);
+  EXPECT_EQ(2, cache.lookup<Plan>("b", make(2))->n);
+  // a known plan is not computed again
+  EXPECT_EQ(1, cache.lookup<Plan>("a", make(10))->n);
+  // and the least recently used one is evicted
+  EXPECT_EQ(3, cache.lookup<Plan>("c", make(3))->n);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(nullptr, cache.get("b"));
+  EXPECT_NE(nullptr, cache.get("a"));
+  // nothing is remembered when there is no plan
+  EXPECT_EQ(nullptr, cache.lookup<Plan>("d", [] {
+    return std::shared_ptr<const Plan>(); }));
+  EXPECT_EQ(2u, cache.size());
+}
+
 TYPED_TEST(ErasureCodeTest, minimum_to_decode)
 {
   TypeParam jerasure;
@@ -45,6 +45,14 @@ int ErasureCodeBench::setup(int argc, char** argv) {
     ("verbose,v", "explain what happens")
     ("size,s", po::value<int>()->default_value(1024 * 1024),
      "size of the buffer to be encoded")
+    ("fragment-size,f", po::value<int>()->default_value(0),
+     "split the buffer to be encoded into SIMD aligned buffers of this size, "
+     "the way it would arrive from the network (0 for a single buffer)")
+    ("stripe-unit,u", po::value<int>()->default_value(0),
+     "encode the buffer as stripes of k chunks of this size, in a single "
+     "encode_stripes() call (0 for a single stripe of the whole buffer)")
+    ("per-stripe", "with --stripe-unit, call encode() or decode() once per "
+     "stripe instead")
     ("iterations,i", po::value<int>()->default_value(1),
      "number of encode/decode runs")
     ("plugin,p", po::value<string>()->default_value("jerasure"),
@@ -110,6 +118,9 @@ int ErasureCodeBench::setup(int argc, char** argv) {
   }
 
   in_size = vm["size"].as<int>();
+  fragment_size = vm["fragment-size"].as<int>();
+  stripe_unit = vm["stripe-unit"].as<int>();
+  per_stripe = vm.count("per-stripe") > 0;
   max_iterations = vm["iterations"].as<int>();
   plugin = vm["plugin"].as<string>();
   workload = vm["workload"].as<string>();
@@ -137,6 +148,16 @@ int ErasureCodeBench::setup(int argc, char** argv) {
     cout << "parameter m is " << m << ". But m needs to be >= 0." << endl;
     return -EINVAL;
   } 
+  if (stripe_unit < 0 || (stripe_unit && in_size % (k * stripe_unit))) {
+    cout << "stripe unit is " << stripe_unit << ". But it needs to be >= 0 "
+	 << "and size needs to be a multiple of k * stripe unit." << endl;
+    return -EINVAL;
+  }
+  if (fragment_size < 0) {
+    cout << "fragment size is " << fragment_size
+	 << ". But it needs to be >= 0." << endl;
+    return -EINVAL;
+  }
 
   verbose = vm.count("verbose") > 0 ? true : false;
 
@@ -153,6 +174,72 @@ int ErasureCodeBench::run() {
     return decode();
 }
 
+bufferlist ErasureCodeBench::make_input() const
+{
+  bufferlist in;
+  if (fragment_size == 0) {
+    in.append(string(in_size, 'X'));
+    in.rebuild_aligned(ErasureCode::SIMD_ALIGN);
+    return in;
+  }
+  for (int off = 0; off < in_size; off += fragment_size) {
+    int len = std::min(fragment_size, in_size - off);
+    bufferptr buf(buffer::create_aligned(len, ErasureCode::SIMD_ALIGN));
+    memset(buf.c_str(), 'X', len);
+    in.push_back(std::move(buf));
+  }
+  return in;
+}
+
+int ErasureCodeBench::encode_buffer(ErasureCodeInterfaceRef erasure_code,
+				    const set<int> &want_to_encode,
+				    const bufferlist &in,
+				    map<int,bufferlist> *encoded)
+{
+  if (stripe_unit == 0)
+    return erasure_code->encode(want_to_encode, in, encoded);
+  if (!per_stripe)
+    return erasure_code->encode_stripes(want_to_encode, in, stripe_unit,
+					encoded);
+  unsigned stripe_width = k * stripe_unit;
+  for (unsigned off = 0; off < in.length(); off += stripe_width) {
+    bufferlist stripe;
+    stripe.substr_of(in, off, stripe_width);
+    map<int,bufferlist> chunks;
+    int code = erasure_code->encode(want_to_encode, stripe, &chunks);
+    if (code)
+      return code;
+    for (auto& [i, chunk] : chunks)
+      (*encoded)[i].claim_append(chunk);
+  }
+  return 0;
+}
+
+int ErasureCodeBench::decode_buffer(ErasureCodeInterfaceRef erasure_code,
+				    const set<int> &want_to_read,
+				    const map<int,bufferlist> &chunks,
+				    map<int,bufferlist> *decoded)
+{
+  if (stripe_unit == 0)
+    return erasure_code->decode(want_to_read, chunks, decoded, 0);
+  if (!per_stripe)
+    return erasure_code->decode_stripes(want_to_read, chunks, stripe_unit,
+					decoded);
+  unsigned length = chunks.begin()->second.length();
+  for (unsigned off = 0; off < length; off += stripe_unit) {
+    map<int,bufferlist> stripe;
+    for (auto& [i, chunk] : chunks)
+      stripe[i].substr_of(chunk, off, stripe_unit);
+    map<int,bufferlist> out;
+    int code = erasure_code->decode(want_to_read, stripe, &out, stripe_unit);
+    if (code)
+      return code;
+    for (int i : want_to_read)
+      (*decoded)[i].claim_append(out[i]);
+  }
+  return 0;
+}
+
 int ErasureCodeBench::encode()
 {
   ErasureCodePluginRegistry &instance = ErasureCodePluginRegistry::instance();
@@ -166,9 +253,7 @@ int ErasureCodeBench::encode()
     return code;
   }
 
-  bufferlist in;
-  in.append(string(in_size, 'X'));
-  in.rebuild_aligned(ErasureCode::SIMD_ALIGN);
+  bufferlist in = make_input();
   set<int> want_to_encode;
   for (int i = 0; i < k + m; i++) {
     want_to_encode.insert(i);
@@ -176,7 +261,7 @@ int ErasureCodeBench::encode()
   utime_t begin_time = ceph_clock_now();
   for (int i = 0; i < max_iterations; i++) {
     map<int,bufferlist> encoded;
-    code = erasure_code->encode(want_to_encode, in, &encoded);
+    code = encode_buffer(erasure_code, want_to_encode, in, &encoded);
     if (code)
       return code;
   }
@@ -216,7 +301,7 @@ int ErasureCodeBench::decode_erasures(const map<int,bufferlist> &all_chunks,
 	want_to_read.insert(chunk);
 
     map<int,bufferlist> decoded;
-    code = erasure_code->decode(want_to_read, chunks, &decoded, 0);
+    code = decode_buffer(erasure_code, want_to_read, chunks, &decoded);
     if (code)
       return code;
     for (set<int>::iterator chunk = want_to_read.begin();
@@ -261,9 +346,7 @@ int ErasureCodeBench::decode()
     return code;
   }
 
-  bufferlist in;
-  in.append(string(in_size, 'X'));
-  in.rebuild_aligned(ErasureCode::SIMD_ALIGN);
+  bufferlist in = make_input();
 
   set<int> want_to_encode;
   for (int i = 0; i < k + m; i++) {
@@ -271,7 +354,7 @@ int ErasureCodeBench::decode()
   }
 
   map<int,bufferlist> encoded;
-  code = erasure_code->encode(want_to_encode, in, &encoded);
+  code = encode_buffer(erasure_code, want_to_encode, in, &encoded);
   if (code)
     return code;
 
@@ -293,7 +376,7 @@ int ErasureCodeBench::decode()
 	return code;
     } else if (erased.size() > 0) {
       map<int,bufferlist> decoded;
-      code = erasure_code->decode(want_to_read, encoded, &decoded, 0);
+      code = decode_buffer(erasure_code, want_to_read, encoded, &decoded);
       if (code)
 	return code;
     } else {
@@ -306,7 +389,7 @@ int ErasureCodeBench::decode()
 	chunks.erase(erasure);
       }
       map<int,bufferlist> decoded;
-      code = erasure_code->decode(want_to_read, chunks, &decoded, 0);
+      code = decode_buffer(erasure_code, want_to_read, chunks, &decoded);
       if (code)
 	return code;
     }
@@ -24,6 +24,9 @@ using namespace std;
 
 class ErasureCodeBench {
   int in_size;
+  int fragment_size;
+  int stripe_unit;
+  bool per_stripe;
   int max_iterations;
   int erasures;
   int k;
@@ -47,6 +50,15 @@ public:
 		      unsigned i,
 		      unsigned want_erasures,
 		      ErasureCodeInterfaceRef erasure_code);
+  bufferlist make_input() const;
+  int encode_buffer(ErasureCodeInterfaceRef erasure_code,
+		    const set<int> &want_to_encode,
+		    const bufferlist &in,
+		    map<int,bufferlist> *encoded);
+  int decode_buffer(ErasureCodeInterfaceRef erasure_code,
+		    const set<int> &want_to_read,
+		    const map<int,bufferlist> &chunks,
+		    map<int,bufferlist> *decoded);
   int decode();
   int encode();
 };
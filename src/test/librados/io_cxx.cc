@@ -952,3 +952,109 @@ TEST_F(LibRadosIoECPP, CmpExtMismatchPP) {
   ASSERT_EQ(0, ioctx.operate("foo", &read, &bl));
   ASSERT_EQ(0, memcmp(bl.c_str(), "ceph", 4));
 }
+
+static void direct_shard_read_check(IoCtx& ioctx, const bufferlist& bl,
+				    uint64_t off, uint64_t len)
+{
+  std::unique_ptr<AioCompletion> c{Rados::aio_create_completion()};
+  bufferlist out;
+  ASSERT_EQ(0, ioctx.aio_read("foo", c.get(), &out, len, off));
+  ASSERT_EQ(0, c->wait_for_complete());
+  uint64_t expected = off < bl.length() ?
+    std::min<uint64_t>(len, bl.length() - off) : 0;
+  ASSERT_EQ((int)expected, c->get_return_value());
+  ASSERT_EQ(expected, out.length());
+  bufferlist want;
+  if (expected) {
+    want.substr_of(bl, off, expected);
+  }
+  ASSERT_TRUE(want.contents_equal(out));
+}
+
+// a few stripes and a partial one
+static bufferlist direct_shard_read_object(unsigned alignment)
+{
+  bufferlist bl;
+  for (unsigned i = 0; i < alignment * 3 + 100; ++i) {
+    bl.append((char)(i * 31 + 7));
+  }
+  return bl;
+}
+
+TEST_F(LibRadosIoECPP, DirectShardReadPP) {
+  ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_reads", "true"));
+  ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_read_min_size", "0"));
+  auto sg = make_scope_guard([&] {
+    cluster.conf_set("rados_ec_direct_reads", "false");
+    cluster.conf_set("rados_ec_direct_read_min_size", "1M");
+  });
+
+  bufferlist bl = direct_shard_read_object(alignment);
+  ASSERT_EQ(0, ioctx.write_full("foo", bl));
+
+  direct_shard_read_check(ioctx, bl, 0, bl.length());
+  direct_shard_read_check(ioctx, bl, alignment - 10, alignment + 20);
+  direct_shard_read_check(ioctx, bl, alignment * 2 + 50, alignment);
+  direct_shard_read_check(ioctx, bl, bl.length() + 10, 100);
+}
+
+TEST_F(LibRadosIoECPP, DirectShardReadDegradedPP) {
+  ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_reads", "true"));
+  ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_read_min_size", "0"));
+  auto sg = make_scope_guard([&] {
+    cluster.conf_set("rados_ec_direct_reads", "false");
+    cluster.conf_set("rados_ec_direct_read_min_size", "1M");
+    cluster.conf_set("rados_ec_direct_read_inject_down_shard", "-1");
+  });
+
+  bufferlist bl = direct_shard_read_object(alignment);
+  ASSERT_EQ(0, ioctx.write_full("foo", bl));
+
+  // without a data shard, the extent is decoded from the coding shards
+  for (const char *shard : {"0", "1"}) {
+    ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_read_inject_down_shard",
+				  shard));
+    direct_shard_read_check(ioctx, bl, 0, bl.length());
+    direct_shard_read_check(ioctx, bl, alignment - 10, alignment + 20);
+  }
+}
+
+TEST_F(LibRadosIoECPP, DirectShardReadErrorPP) {
+  ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_reads", "true"));
+  ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_read_min_size", "0"));
+  auto sg = make_scope_guard([&] {
+    cluster.conf_set("rados_ec_direct_reads", "false");
+    cluster.conf_set("rados_ec_direct_read_min_size", "1M");
+    cluster.conf_set("rados_ec_direct_read_inject_error", "0");
+  });
+
+  bufferlist bl = direct_shard_read_object(alignment);
+  ASSERT_EQ(0, ioctx.write_full("foo", bl));
+
+  // a shard that can't serve the read sends it back to the primary
+  for (int err : {-EAGAIN, -EIO, -ENOENT}) {
+    ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_read_inject_error",
+				  std::to_string(err).c_str()));
+    direct_shard_read_check(ioctx, bl, 0, bl.length());
+    direct_shard_read_check(ioctx, bl, alignment * 2 + 50, alignment);
+  }
+}
+
+TEST_F(LibRadosIoECPP, DirectShardReadVersionMismatchPP) {
+  ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_reads", "true"));
+  ASSERT_EQ(0, cluster.conf_set("rados_ec_direct_read_min_size", "0"));
+  auto sg = make_scope_guard([&] {
+    cluster.conf_set("rados_ec_direct_reads", "false");
+    cluster.conf_set("rados_ec_direct_read_min_size", "1M");
+    cluster.conf_set("rados_ec_direct_read_inject_version_mismatch", "false");
+  });
+
+  bufferlist bl = direct_shard_read_object(alignment);
+  ASSERT_EQ(0, ioctx.write_full("foo", bl));
+
+  // shards that disagree are not combined
+  ASSERT_EQ(0, cluster.conf_set(
+    "rados_ec_direct_read_inject_version_mismatch", "true"));
+  direct_shard_read_check(ioctx, bl, 0, bl.length());
+  direct_shard_read_check(ioctx, bl, alignment - 10, alignment + 20);
+}
@@ -0,0 +1,147 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+/*
+ * Simulate N OSDs reporting their primary PGs' stats to the mgr, either
+ * sending every PG on every report or only the PGs whose stats changed
+ * (see OSD::collect_pg_stats()), and measure the bytes on the wire and
+ * the time the mgr spends decoding them and applying them to its PGMap.
+ */
+
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "common/Clock.h"
+#include "common/ceph_argparse.h"
+#include "global/global_init.h"
+#include "global/global_context.h"
+#include "messages/MPGStats.h"
+#include "mon/PGMap.h"
+
+using namespace std;
+
+struct SimOSD {
+  map<pg_t, pg_stat_t> stats;
+  map<pg_t, pair<epoch_t, version_t>> last_sent;
+};
+
+struct Result {
+  uint64_t bytes = 0;
+  uint64_t pgs = 0;
+  double secs = 0;
+};
+
+static Result run(vector<SimOSD> osds, unsigned rounds, unsigned change_pct,
+		  unsigned full_interval, bool delta)
+{
+  Result r;
+  PGMap pg_map;
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<unsigned> pct(0, 99);
+  for (unsigned round = 0; round < rounds; ++round) {
+    bool full = !delta || round % full_interval == 0;
+    // OSD side: some pgs change, then each osd composes its report
+    vector<ceph::bufferlist> reports;
+    for (auto& osd : osds) {
+      auto m = ceph::make_message<MPGStats>(uuid_d(), round + 1);
+      decltype(osd.last_sent) sent;
+      for (auto& [pgid, s] : osd.stats) {
+	if (round && pct(rng) < change_pct) {
+	  s.reported_epoch = round + 1;
+	  ++s.reported_seq;
+	  s.stats.sum.num_objects += 1;
+	  s.stats.sum.num_bytes += 4096;
+	}
+	auto version = s.get_version_pair();
+	auto p = osd.last_sent.find(pgid);
+	if (full || p == osd.last_sent.end() || p->second != version) {
+	  m->pg_stat[pgid] = s;
+	}
+	sent.emplace(pgid, version);
+      }
+      osd.last_sent.swap(sent);
+      m->encode_payload(CEPH_FEATURES_ALL);
+      r.bytes += m->get_payload().length();
+      r.pgs += m->pg_stat.size();
+      reports.push_back(m->get_payload());
+    }
+
+    // mgr side: what ClusterState::ingest_pgstats() and
+    // update_delta_stats() do with them
+    utime_t start = ceph_clock_now();
+    PGMap::Incremental pending_inc;
+    int from = 0;
+    for (auto& bl : reports) {
+      auto m = ceph::make_message<MPGStats>();
+      m->set_payload(bl);
+      m->decode_payload();
+      pending_inc.update_stat(from++, std::move(m->osd_stat));
+      for (const auto& p : m->pg_stat) {
+	pending_inc.pg_stat_updates[p.first] = p.second;
+      }
+    }
+    pending_inc.version = pg_map.version + 1;
+    pg_map.apply_incremental(g_ceph_context, pending_inc);
+    r.secs += (double)(ceph_clock_now() - start);
+  }
+  return r;
+}
+
+static void usage(const char *name)
+{
+  cout << name << " <osds> <pgs_per_osd> <rounds> [change_percent]\n"
+       << "\t osds: the number of reporting OSDs.\n"
+       << "\t pgs_per_osd: the number of PGs each OSD is primary for.\n"
+       << "\t rounds: the number of reports each OSD sends.\n"
+       << "\t change_percent: the percentage of PGs whose stats change "
+       << "between reports (default 5).\n";
+}
+
+int main(int argc, const char **argv)
+{
+  if (argc < 4) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto args = argv_to_vec(argc, argv);
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+
+  unsigned num_osds = atoi(argv[1]);
+  unsigned pgs_per_osd = atoi(argv[2]);
+  unsigned rounds = atoi(argv[3]);
+  unsigned change_pct = argc > 4 ? atoi(argv[4]) : 5;
+  unsigned full_interval = std::max<uint64_t>(
+    g_conf().get_val<uint64_t>("osd_pg_stats_full_report_interval"), 1);
+
+  vector<SimOSD> osds(num_osds);
+  for (unsigned o = 0; o < num_osds; ++o) {
+    for (unsigned i = 0; i < pgs_per_osd; ++i) {
+      pg_t pgid(o * pgs_per_osd + i, 1);
+      pg_stat_t& s = osds[o].stats[pgid];
+      s.reported_epoch = 1;
+      s.reported_seq = 1;
+      s.state = PG_STATE_ACTIVE | PG_STATE_CLEAN;
+      s.up = s.acting = {(int)o, (int)((o + 1) % num_osds),
+			 (int)((o + 2) % num_osds)};
+      s.up_primary = s.acting_primary = o;
+    }
+  }
+
+  cout << num_osds << " osds, " << pgs_per_osd << " pgs per osd, "
+       << rounds << " rounds, " << change_pct << "% of pgs changing per round"
+       << std::endl;
+  for (bool delta : {false, true}) {
+    auto r = run(osds, rounds, change_pct, full_interval, delta);
+    cout << (delta ? "changed pgs only" : "every pg")
+	 << (delta ? " (full every " + to_string(full_interval) + ")" : "")
+	 << ": " << r.pgs / rounds << " pgs, "
+	 << byte_u_t(r.bytes / rounds) << " and "
+	 << r.secs * 1000 / rounds << " ms in the mgr per round" << std::endl;
+  }
+  return 0;
+}
@@ -47,8 +47,9 @@ public:
   struct MockDmclockItem : public PGOpQueueable {
     op_scheduler_class scheduler_class;
 
-    MockDmclockItem(op_scheduler_class _scheduler_class) :
-      PGOpQueueable(spg_t()),
+    MockDmclockItem(op_scheduler_class _scheduler_class,
+		    spg_t pgid = spg_t()) :
+      PGOpQueueable(pgid),
       scheduler_class(_scheduler_class) {}
 
     MockDmclockItem()
@@ -169,3 +170,129 @@ TEST_F(mClockSchedulerTest, TestMultiClientOrderedEnqueueDequeue) {
   }
   ASSERT_TRUE(q.empty());
 }
+
+TEST_F(mClockSchedulerTest, TestClientQosLimit) {
+  g_ceph_context->_conf.set_val_or_die(
+    "osd_mclock_scheduler_client_qos",
+    "client.1001=0/1/1, pool.7=0/1/1");
+  q.update_configuration();
+
+  // client1 is limited to one op per second wherever it goes
+  q.enqueue(create_item(100, client1, op_scheduler_class::client));
+  q.enqueue(create_item(101, client1, op_scheduler_class::client));
+  ASSERT_EQ(100u, get_item(q.dequeue()).get_map_epoch());
+  ASSERT_TRUE(std::holds_alternative<double>(q.dequeue()));
+  // others are not
+  q.enqueue(create_item(102, client2, op_scheduler_class::client));
+  ASSERT_EQ(102u, get_item(q.dequeue()).get_map_epoch());
+
+  // clients in pool 7 share its limit
+  spg_t pool7(pg_t(0, 7));
+  q.enqueue(create_item(103, client2, op_scheduler_class::client, pool7));
+  q.enqueue(create_item(104, client3, op_scheduler_class::client, pool7));
+  ASSERT_EQ(103u, get_item(q.dequeue()).get_map_epoch());
+  ASSERT_TRUE(std::holds_alternative<double>(q.dequeue()));
+
+  g_ceph_context->_conf.set_val_or_die("osd_mclock_scheduler_client_qos", "");
+  q.update_configuration();
+}
+
+TEST_F(mClockSchedulerTest, TestClientQosUpdate) {
+  // client2 gets a limit after it has been scheduled with the default
+  q.enqueue(create_item(100, client2, op_scheduler_class::client));
+  ASSERT_EQ(100u, get_item(q.dequeue()).get_map_epoch());
+  // and client3 is limited before it loses the limit
+  g_ceph_context->_conf.set_val_or_die(
+    "osd_mclock_scheduler_client_qos", "client.100000001=0/1/1");
+  q.update_configuration();
+  q.enqueue(create_item(101, client3, op_scheduler_class::client));
+  ASSERT_EQ(101u, get_item(q.dequeue()).get_map_epoch());
+
+  g_ceph_context->_conf.set_val_or_die(
+    "osd_mclock_scheduler_client_qos", "client.9999=0/1/1");
+  q.update_configuration();
+  q.enqueue(create_item(102, client3, op_scheduler_class::client));
+  q.enqueue(create_item(103, client3, op_scheduler_class::client));
+  ASSERT_EQ(102u, get_item(q.dequeue()).get_map_epoch());
+  ASSERT_EQ(103u, get_item(q.dequeue()).get_map_epoch());
+  q.enqueue(create_item(104, client2, op_scheduler_class::client));
+  q.enqueue(create_item(105, client2, op_scheduler_class::client));
+  ASSERT_EQ(104u, get_item(q.dequeue()).get_map_epoch());
+  ASSERT_TRUE(std::holds_alternative<double>(q.dequeue()));
+
+  g_ceph_context->_conf.set_val_or_die("osd_mclock_scheduler_client_qos", "");
+  q.update_configuration();
+}
+
+TEST_F(mClockSchedulerTest, TestCalibratedCost) {
+  const int small = 4096, medium = 65536, large = 4 << 20;
+  int configured_small = q.calc_scaled_cost(small);
+  int configured_large = q.calc_scaled_cost(large);
+
+  // the measured costs are ignored unless calibration is on
+  q.update_cost_model(0.0001, 1e-8);
+  ASSERT_EQ(configured_small, q.calc_scaled_cost(small));
+  ASSERT_EQ(configured_large, q.calc_scaled_cost(large));
+
+  g_ceph_context->_conf.set_val_or_die("osd_mclock_cost_calibration", "true");
+  q.update_configuration();
+  // 100us per io plus 0.01us per byte: a 4 KiB op costs ~141us
+  q.update_cost_model(0.0001, 1e-8);
+  ASSERT_EQ(1, q.calc_scaled_cost(small));
+  ASSERT_EQ(5, q.calc_scaled_cost(medium));
+  ASSERT_EQ(298, q.calc_scaled_cost(large));
+  ASSERT_LT(q.calc_scaled_cost(small), q.calc_scaled_cost(large));
+  // nothing measured yet
+  q.update_cost_model(0, 0);
+  ASSERT_EQ(1, q.calc_scaled_cost(large));
+  // all of it per byte
+  q.update_cost_model(0, 1e-8);
+  ASSERT_EQ(1024, q.calc_scaled_cost(large));
+
+  g_ceph_context->_conf.set_val_or_die("osd_mclock_cost_calibration", "false");
+  q.update_configuration();
+  ASSERT_EQ(configured_small, q.calc_scaled_cost(small));
+  ASSERT_EQ(configured_large, q.calc_scaled_cost(large));
+}
+
+TEST(mClockSchedulerParseTest, TestParseClientQos) {
+  std::map<client_profile_id_t, crimson::dmclock::ClientInfo> infos;
+  std::ostringstream err;
+  ASSERT_TRUE(mClockScheduler::parse_client_qos(
+    "client.4151=10/2/100 pool.3=0/1/50", &infos, &err));
+  ASSERT_EQ(2u, infos.size());
+  ASSERT_EQ(10, (infos.at(client_profile_id_t{4151, 0}).reservation));
+  ASSERT_EQ(50, (infos.at(client_profile_id_t{0, 4}).limit));
+
+  infos.clear();
+  ASSERT_FALSE(mClockScheduler::parse_client_qos(
+    "pool.3=0/1/50,osd.1=1/1/1;client.1=1/0/1 client.2=1/1", &infos, &err));
+  ASSERT_EQ(1u, infos.size());
+}
+
+TEST(OpCostModelTest, TestRecalibrate) {
+  OpCostModel model;
+  ASSERT_FALSE(model.is_valid());
+  ASSERT_FALSE(model.recalibrate(1, 0.5));
+
+  // latency = 100us + 0.01us per byte
+  auto add = [&model](uint64_t bytes) {
+    model.add_sample(bytes, std::chrono::nanoseconds(100000 + bytes * 10));
+  };
+  for (uint64_t bytes : {4096, 16384, 65536, 1 << 20}) {
+    add(bytes);
+  }
+  ASSERT_FALSE(model.recalibrate(10, 0.5));
+  ASSERT_TRUE(model.recalibrate(4, 0.5));
+  ASSERT_TRUE(model.is_valid());
+  ASSERT_NEAR(0.0001, model.get_cost_per_io(), 1e-9);
+  ASSERT_NEAR(1e-8, model.get_cost_per_byte(), 1e-12);
+
+  // same sized ops: the per-byte cost is kept, the rest moves per-op
+  for (int i = 0; i < 10; ++i) {
+    model.add_sample(4096, std::chrono::nanoseconds(300000 + 40960));
+  }
+  ASSERT_TRUE(model.recalibrate(10, 0.5));
+  ASSERT_NEAR(1e-8, model.get_cost_per_byte(), 1e-12);
+  ASSERT_NEAR(0.0002, model.get_cost_per_io(), 1e-9);
+}
@@ -0,0 +1,123 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+#include "gtest/gtest.h"
+
+#include "common/Throttle.h"
+#include "global/global_context.h"
+#include "messages/MOSDRepOpBatch.h"
+
+static ceph::ref_t<MOSDRepOp> make_repop(ceph_tid_t tid, unsigned len)
+{
+  spg_t pgid(pg_t(7, 1), shard_id_t::NO_SHARD);
+  hobject_t poid(object_t("obj" + std::to_string(tid)), "", CEPH_NOSNAP,
+		 tid, 1, "");
+  auto op = ceph::make_message<MOSDRepOp>(
+    osd_reqid_t(entity_name_t::CLIENT(4100), 0, tid),
+    pg_shard_t(0, shard_id_t::NO_SHARD), pgid, poid,
+    CEPH_OSD_FLAG_ACK | CEPH_OSD_FLAG_ONDISK, 30, 28, tid,
+    eversion_t(30, tid));
+  op->logbl.append("log entries");
+  op->pg_trim_to = eversion_t(29, 1);
+  op->min_last_complete_ondisk = eversion_t(29, 2);
+  bufferlist data;
+  data.append(std::string(len, 'a' + tid % 26));
+  op->set_data(data);
+  op->set_priority(CEPH_MSG_PRIO_HIGH);
+  return op;
+}
+
+// what the messenger hands to fast dispatch
+static ceph::ref_t<MOSDRepOpBatch> receive(MOSDRepOpBatch *sent)
+{
+  sent->encode_payload(CEPH_FEATURES_ALL);
+  auto m = ceph::make_message<MOSDRepOpBatch>();
+  m->set_header(sent->get_header());
+  m->set_payload(sent->get_payload());
+  m->set_data(sent->get_data());
+  m->decode_payload();
+  return m;
+}
+
+TEST(MOSDRepOpBatch, encode_decode)
+{
+  std::vector<ceph::ref_t<MOSDRepOp>> ops;
+  for (ceph_tid_t tid : {11, 12, 13}) {
+    ops.push_back(make_repop(tid, tid * 100));
+  }
+  auto sent = ceph::make_message<MOSDRepOpBatch>(
+    spg_t(pg_t(7, 1), shard_id_t::NO_SHARD), 30, 28,
+    std::vector<ceph::ref_t<MOSDRepOp>>(ops));
+  auto m = receive(sent.get());
+
+  ASSERT_EQ(30u, m->map_epoch);
+  ASSERT_EQ(28u, m->min_epoch);
+  ASSERT_EQ(spg_t(pg_t(7, 1), shard_id_t::NO_SHARD), m->pgid);
+  ASSERT_EQ(ops.size(), m->ops.size());
+  for (unsigned i = 0; i < ops.size(); ++i) {
+    auto& a = ops[i];
+    auto& b = m->ops[i];
+    b->finish_decode();
+    ASSERT_EQ(a->get_tid(), b->get_tid());
+    ASSERT_EQ(a->get_priority(), b->get_priority());
+    ASSERT_EQ(a->get_header().version, b->get_header().version);
+    ASSERT_EQ(a->map_epoch, b->map_epoch);
+    ASSERT_EQ(a->min_epoch, b->min_epoch);
+    ASSERT_EQ(a->reqid, b->reqid);
+    ASSERT_EQ(a->pgid, b->pgid);
+    ASSERT_EQ(a->from, b->from);
+    ASSERT_EQ(a->poid, b->poid);
+    ASSERT_EQ(a->acks_wanted, b->acks_wanted);
+    ASSERT_EQ(a->version, b->version);
+    ASSERT_EQ(a->pg_trim_to, b->pg_trim_to);
+    ASSERT_EQ(a->min_last_complete_ondisk, b->min_last_complete_ondisk);
+    ASSERT_TRUE(a->logbl.contents_equal(b->logbl));
+    ASSERT_TRUE(a->get_data().contents_equal(b->get_data()));
+  }
+}
+
+TEST(MOSDRepOpBatch, split)
+{
+  // these must outlive the messages charged to them
+  Throttle bytes(g_ceph_context, "repop_batch_bytes", 1 << 30, false);
+  Throttle msgs(g_ceph_context, "repop_batch_msgs", 1000, false);
+
+  std::vector<ceph::ref_t<MOSDRepOp>> ops;
+  for (ceph_tid_t tid : {21, 22, 23}) {
+    ops.push_back(make_repop(tid, 4096));
+  }
+  auto sent = ceph::make_message<MOSDRepOpBatch>(
+    spg_t(pg_t(7, 1), shard_id_t::NO_SHARD), 30, 28, std::move(ops));
+  auto m = receive(sent.get());
+  sent.reset();
+
+  // charge the batch to the throttles, as the messenger does on receipt
+  bytes.take(m->get_payload().length() + m->get_data().length());
+  m->set_byte_throttler(&bytes);
+  msgs.take(1);
+  m->set_message_throttler(&msgs);
+  utime_t stamp(100, 1);
+  m->set_recv_stamp(stamp);
+
+  auto split = m->split();
+  ASSERT_EQ(3u, split.size());
+  ASSERT_TRUE(m->ops.empty());
+  int64_t op_bytes = 0;
+  for (auto& op : split) {
+    ASSERT_EQ(stamp, op->get_recv_stamp());
+    op_bytes += op->get_payload().length() + op->get_data().length();
+  }
+  ASSERT_GE(op_bytes, 3 * 4096);
+
+  // the batch is done with once it is split, but its ops are still
+  // queued: they keep their share of the throttles
+  m.reset();
+  ASSERT_EQ(op_bytes, bytes.get_current());
+  ASSERT_EQ(3, msgs.get_current());
+
+  split.pop_back();
+  ASSERT_EQ(2, msgs.get_current());
+  split.clear();
+  ASSERT_EQ(0, bytes.get_current());
+  ASSERT_EQ(0, msgs.get_current());
+}
@@ -272,6 +272,29 @@ TEST_F(OSDMapTest, MapPG) {
   ASSERT_EQ(osdmap.get_pg_pool(my_rep_pool)->get_size(), up_osds.size());
 }
 
+TEST_F(OSDMapTest, MapToPgsMatchesMapToPg) {
+  set_up_map();
+
+  // enough names of assorted lengths to fill several hashing lanes and
+  // leave a ragged remainder
+  vector<string> names;
+  for (unsigned i = 0; i < 103; ++i) {
+    names.push_back("obj_" + string(i % 37, 'x') + to_string(i));
+  }
+  for (const string nspace : {"", "ns"}) {
+    vector<pg_t> pgs;
+    ASSERT_EQ(0, osdmap.map_to_pgs(my_rep_pool, names, nspace, &pgs));
+    ASSERT_EQ(names.size(), pgs.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+      pg_t pg;
+      ASSERT_EQ(0, osdmap.map_to_pg(my_rep_pool, names[i], "", nspace, &pg));
+      ASSERT_EQ(pg, pgs[i]);
+    }
+  }
+  vector<pg_t> pgs;
+  ASSERT_EQ(-ENOENT, osdmap.map_to_pgs(12345, names, "", &pgs));
+}
+
 TEST_F(OSDMapTest, MapFunctionsMatch) {
   // TODO: make sure pg_to_up_acting_osds and pg_to_acting_osds match
   set_up_map();
@@ -364,6 +387,49 @@ TEST_F(OSDMapTest, PrimaryTempRespected) {
   EXPECT_EQ(acting_primary, acting_osds[1]);
 }
 
+TEST_F(OSDMapTest, ShallowCopyApplyIncremental) {
+  set_up_map();
+
+  pg_t rawpg(0, my_rep_pool);
+  pg_t pgid = osdmap.raw_pg_to_pg(rawpg);
+  vector<int> up_osds, acting_osds;
+  int up_primary, acting_primary;
+  osdmap.pg_to_up_acting_osds(pgid, &up_osds, &up_primary,
+                              &acting_osds, &acting_primary);
+
+  OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+  vector<int> new_acting_osds(acting_osds.rbegin(), acting_osds.rend());
+  inc.new_pg_temp[pgid] = mempool::osdmap::vector<int>(
+    new_acting_osds.begin(), new_acting_osds.end());
+  inc.new_primary_temp[pgid] = new_acting_osds[1];
+  inc.new_primary_affinity[0] = 0;
+
+  OSDMap deep, shallow;
+  deep.deepish_copy_from(osdmap);
+  deep.apply_incremental(inc);
+  shallow.shallow_copy_from(osdmap);
+  shallow.apply_incremental(inc);
+
+  // the source map is untouched
+  vector<int> old_acting_osds;
+  int old_acting_primary;
+  osdmap.pg_to_up_acting_osds(pgid, &up_osds, &up_primary,
+                              &old_acting_osds, &old_acting_primary);
+  EXPECT_EQ(acting_osds, old_acting_osds);
+  EXPECT_EQ(acting_primary, old_acting_primary);
+  EXPECT_EQ(CEPH_OSD_DEFAULT_PRIMARY_AFFINITY, osdmap.get_primary_affinity(0));
+
+  // and the copy matches one built the old way
+  shallow.pg_to_up_acting_osds(pgid, &up_osds, &up_primary,
+                               &acting_osds, &acting_primary);
+  EXPECT_EQ(new_acting_osds, acting_osds);
+  EXPECT_EQ(new_acting_osds[1], acting_primary);
+  bufferlist dbl, sbl;
+  deep.encode(dbl, CEPH_FEATURES_SUPPORTED_DEFAULT | CEPH_FEATURE_RESERVED);
+  shallow.encode(sbl, CEPH_FEATURES_SUPPORTED_DEFAULT | CEPH_FEATURE_RESERVED);
+  EXPECT_TRUE(dbl.contents_equal(sbl));
+}
+
 TEST_F(OSDMapTest, CleanTemps) {
   set_up_map();
 
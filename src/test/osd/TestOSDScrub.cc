@@ -24,6 +24,8 @@
 #include <gtest/gtest.h>
 #include "common/async/context_pool.h"
 #include "osd/OSD.h"
+#include "osd/scrubber/pg_scrubber.h"
+#include "messages/MOSDRepScrub.h"
 #include "os/ObjectStore.h"
 #include "mon/MonClient.h"
 #include "common/ceph_argparse.h"
@@ -54,10 +56,15 @@ public:
   bool scrub_time_permit(utime_t now) {
     return service.get_scrub_services().scrub_time_permit(now);
   }
+
+  ScrubQueue& scrub_queue() {
+    return service.get_scrub_services();
+  }
 };
 
-TEST(TestOSDScrub, scrub_time_permit) {
-  ceph::async::io_context_pool icp(1);
+static TestOSDScrub* create_test_osd(ceph::async::io_context_pool& icp,
+				     MonClient& mc)
+{
   std::unique_ptr<ObjectStore> store = ObjectStore::create(g_ceph_context,
              g_conf()->osd_objectstore,
              g_conf()->osd_data,
@@ -69,9 +76,14 @@ TEST(TestOSDScrub, scrub_time_permit) {
   ms->set_cluster_protocol(CEPH_OSD_PROTOCOL);
   ms->set_default_policy(Messenger::Policy::stateless_server(0));
   ms->bind(g_conf()->public_addr);
-  MonClient mc(g_ceph_context, icp);
   mc.build_initial_monmap();
-  TestOSDScrub* osd = new TestOSDScrub(g_ceph_context, std::move(store), 0, ms, ms, ms, ms, ms, ms, ms, &mc, "", "", icp);
+  return new TestOSDScrub(g_ceph_context, std::move(store), 0, ms, ms, ms, ms, ms, ms, ms, &mc, "", "", icp);
+}
+
+TEST(TestOSDScrub, scrub_time_permit) {
+  ceph::async::io_context_pool icp(1);
+  MonClient mc(g_ceph_context, icp);
+  TestOSDScrub* osd = create_test_osd(icp, mc);
 
   // These are now invalid
   int err = g_ceph_context->_conf.set_val("osd_scrub_begin_hour", "24");
@@ -198,6 +210,229 @@ TEST(TestOSDScrub, scrub_time_permit) {
   ASSERT_FALSE(ret);
 }
 
+TEST(TestOSDScrub, update_device_load) {
+  ceph::async::io_context_pool icp(1);
+  MonClient mc(g_ceph_context, icp);
+  TestOSDScrub* osd = create_test_osd(icp, mc);
+  ScrubQueue& sq = osd->scrub_queue();
+
+  // scrubbing is permitted at all times, so the sleeps are not extended
+  g_ceph_context->_conf.set_val("osd_scrub_begin_hour", "0");
+  g_ceph_context->_conf.set_val("osd_scrub_end_hour", "0");
+  g_ceph_context->_conf.set_val("osd_scrub_begin_week_day", "0");
+  g_ceph_context->_conf.set_val("osd_scrub_end_week_day", "0");
+  g_ceph_context->_conf.set_val("osd_scrub_sleep", "0.1");
+  g_ceph_context->_conf.set_val("osd_scrub_adaptive_sleep_max", "1");
+  g_ceph_context->_conf.set_val("osd_scrub_device_util_target", "0");
+  g_ceph_context->_conf.apply_changes(nullptr);
+
+  // no target: never slow down
+  sq.update_device_load(1.0);
+  ASSERT_DOUBLE_EQ(1.0, sq.scrub_chunk_factor(false));
+  ASSERT_EQ(25, sq.scrub_chunk_max(25, false));
+  ASSERT_DOUBLE_EQ(0.1, sq.scrub_sleep_time(false));
+
+  g_ceph_context->_conf.set_val("osd_scrub_device_util_target", "0.5");
+  g_ceph_context->_conf.apply_changes(nullptr);
+
+  // below the target (and between 80% of it and the target) nothing changes
+  sq.update_device_load(0.3);
+  ASSERT_DOUBLE_EQ(1.0, sq.scrub_chunk_factor(false));
+  sq.update_device_load(0.45);
+  ASSERT_DOUBLE_EQ(1.0, sq.scrub_chunk_factor(false));
+
+  // above the target the pace halves
+  sq.update_device_load(0.9);
+  ASSERT_DOUBLE_EQ(0.5, sq.scrub_chunk_factor(false));
+  ASSERT_EQ(12, sq.scrub_chunk_max(25, false));
+  ASSERT_DOUBLE_EQ(0.1 + 0.5, sq.scrub_sleep_time(false));
+  // required scrubs are not slowed down
+  ASSERT_DOUBLE_EQ(1.0, sq.scrub_chunk_factor(true));
+  ASSERT_EQ(25, sq.scrub_chunk_max(25, true));
+  ASSERT_DOUBLE_EQ(0.1, sq.scrub_sleep_time(true));
+
+  // ... down to 1/16
+  sq.update_device_load(0.9);
+  ASSERT_DOUBLE_EQ(0.25, sq.scrub_chunk_factor(false));
+  sq.update_device_load(0.9);
+  ASSERT_DOUBLE_EQ(0.125, sq.scrub_chunk_factor(false));
+  sq.update_device_load(0.9);
+  ASSERT_DOUBLE_EQ(0.0625, sq.scrub_chunk_factor(false));
+  sq.update_device_load(1.0);
+  ASSERT_DOUBLE_EQ(0.0625, sq.scrub_chunk_factor(false));
+  ASSERT_EQ(1, sq.scrub_chunk_max(25, false));
+  ASSERT_EQ(0, sq.scrub_chunk_max(5, false));
+  ASSERT_DOUBLE_EQ(0.1 + 0.9375, sq.scrub_sleep_time(false));
+
+  // within 80% of the target the pace holds
+  sq.update_device_load(0.45);
+  ASSERT_DOUBLE_EQ(0.0625, sq.scrub_chunk_factor(false));
+
+  // well below it, the pace recovers by 1/16 per sample, up to 1
+  sq.update_device_load(0.1);
+  ASSERT_DOUBLE_EQ(0.125, sq.scrub_chunk_factor(false));
+  for (int i = 0; i < 13; ++i) {
+    sq.update_device_load(0.1);
+  }
+  ASSERT_DOUBLE_EQ(0.9375, sq.scrub_chunk_factor(false));
+  sq.update_device_load(0.1);
+  ASSERT_DOUBLE_EQ(1.0, sq.scrub_chunk_factor(false));
+  sq.update_device_load(0.1);
+  ASSERT_DOUBLE_EQ(1.0, sq.scrub_chunk_factor(false));
+  ASSERT_DOUBLE_EQ(0.1, sq.scrub_sleep_time(false));
+
+  // a busy device, then the adaptation is switched off
+  sq.update_device_load(0.9);
+  ASSERT_DOUBLE_EQ(0.5, sq.scrub_chunk_factor(false));
+  g_ceph_context->_conf.set_val("osd_scrub_device_util_target", "0");
+  g_ceph_context->_conf.apply_changes(nullptr);
+  sq.update_device_load(0.9);
+  ASSERT_DOUBLE_EQ(1.0, sq.scrub_chunk_factor(false));
+  ASSERT_DOUBLE_EQ(0.1, sq.scrub_sleep_time(false));
+}
+
+TEST(TestOSDScrub, deep_scrub_since) {
+  // a deep scrub began at 20'100, in epoch 20; the PG has been clean
+  // since epoch 12
+  pg_history_t history;
+  history.same_interval_since = 10;
+  history.last_epoch_clean = 12;
+  history.last_deep_scrub_begin = eversion_t(20, 100);
+  history.last_deep_scrub_begin_epoch = 20;
+  history.last_full_deep_scrub_stamp = utime_t(1000, 0);
+  const double full_interval = 500;
+  const utime_t now(1200, 0);
+
+  ASSERT_EQ(eversion_t(20, 100),
+	    PgScrubber::deep_scrub_since(history, false, false, 0,
+					 full_interval, now));
+
+  // disabled
+  ASSERT_EQ(eversion_t(),
+	    PgScrubber::deep_scrub_since(history, false, false, 0, 0, now));
+  // explicitly requested
+  ASSERT_EQ(eversion_t(),
+	    PgScrubber::deep_scrub_since(history, true, false, 0,
+					 full_interval, now));
+  // repair
+  ASSERT_EQ(eversion_t(),
+	    PgScrubber::deep_scrub_since(history, false, true, 0,
+					 full_interval, now));
+  // scrub errors
+  ASSERT_EQ(eversion_t(),
+	    PgScrubber::deep_scrub_since(history, false, false, 1,
+					 full_interval, now));
+  // the last full deep scrub is too old
+  ASSERT_EQ(eversion_t(20, 100),
+	    PgScrubber::deep_scrub_since(history, false, false, 0,
+					 full_interval, utime_t(1500, 0)));
+  ASSERT_EQ(eversion_t(),
+	    PgScrubber::deep_scrub_since(history, false, false, 0,
+					 full_interval, utime_t(1500, 1)));
+
+  // no record of when the last deep scrub began (e.g. decoded from an
+  // older pg_history_t)
+  {
+    pg_history_t h = history;
+    h.last_deep_scrub_begin = eversion_t();
+    h.last_deep_scrub_begin_epoch = 0;
+    ASSERT_EQ(eversion_t(),
+	      PgScrubber::deep_scrub_since(h, false, false, 0,
+					   full_interval, now));
+  }
+
+  // the interval changed after the deep scrub began: the new members of
+  // the acting set hold recovered or backfilled copies
+  {
+    pg_history_t h = history;
+    h.same_interval_since = 20;
+    ASSERT_EQ(eversion_t(20, 100),
+	      PgScrubber::deep_scrub_since(h, false, false, 0,
+					   full_interval, now));
+    h.same_interval_since = 21;
+    ASSERT_EQ(eversion_t(),
+	      PgScrubber::deep_scrub_since(h, false, false, 0,
+					   full_interval, now));
+  }
+
+  // the PG recovered, and became clean again, after the deep scrub began
+  {
+    pg_history_t h = history;
+    h.last_epoch_clean = 20;
+    ASSERT_EQ(eversion_t(20, 100),
+	      PgScrubber::deep_scrub_since(h, false, false, 0,
+					   full_interval, now));
+    h.last_epoch_clean = 21;
+    ASSERT_EQ(eversion_t(),
+	      PgScrubber::deep_scrub_since(h, false, false, 0,
+					   full_interval, now));
+  }
+}
+
+TEST(TestOSDScrub, MOSDRepScrub_encode_decode) {
+  hobject_t start(object_t("a"), "", CEPH_NOSNAP, 1, 1, "");
+  hobject_t end(object_t("b"), "", CEPH_NOSNAP, 2, 1, "");
+  auto m = ceph::make_message<MOSDRepScrub>(
+    spg_t(pg_t(1, 1), shard_id_t(2)), eversion_t(20, 120), 21, 19,
+    start, end, true, true, 5, true);
+  m->deep_since = eversion_t(20, 100);
+  m->encode_payload(0);
+
+  auto d = ceph::make_message<MOSDRepScrub>();
+  d->set_payload(m->get_payload());
+  d->get_header().version = MOSDRepScrub::HEAD_VERSION;
+  d->decode_payload();
+  ASSERT_EQ(m->pgid, d->pgid);
+  ASSERT_EQ(m->scrub_to, d->scrub_to);
+  ASSERT_EQ(m->map_epoch, d->map_epoch);
+  ASSERT_EQ(m->min_epoch, d->min_epoch);
+  ASSERT_EQ(m->start, d->start);
+  ASSERT_EQ(m->end, d->end);
+  ASSERT_TRUE(d->deep);
+  ASSERT_TRUE(d->allow_preemption);
+  ASSERT_EQ(5, d->priority);
+  ASSERT_TRUE(d->high_priority);
+  ASSERT_EQ(eversion_t(20, 100), d->deep_since);
+}
+
+TEST(TestOSDScrub, MOSDRepScrub_decode_v9) {
+  // the payload of a v9 MOSDRepScrub, which has no deep_since
+  bufferlist payload;
+  {
+    using ceph::encode;
+    hobject_t start(object_t("a"), "", CEPH_NOSNAP, 1, 1, "");
+    hobject_t end(object_t("b"), "", CEPH_NOSNAP, 2, 1, "");
+    encode(pg_t(1, 1), payload);
+    encode(eversion_t(), payload);	// scrub_from
+    encode(eversion_t(20, 120), payload);	// scrub_to
+    encode((epoch_t)21, payload);	// map_epoch
+    encode(true, payload);		// chunky
+    encode(start, payload);
+    encode(end, payload);
+    encode(true, payload);		// deep
+    encode(shard_id_t(2), payload);
+    encode((uint32_t)-1, payload);	// seed
+    encode((epoch_t)19, payload);	// min_epoch
+    encode(true, payload);		// allow_preemption
+    encode((int32_t)5, payload);	// priority
+    encode(true, payload);		// high_priority
+  }
+
+  auto d = ceph::make_message<MOSDRepScrub>();
+  d->set_payload(payload);
+  d->get_header().version = 9;
+  d->decode_payload();
+  ASSERT_EQ(spg_t(pg_t(1, 1), shard_id_t(2)), d->pgid);
+  ASSERT_EQ(eversion_t(20, 120), d->scrub_to);
+  ASSERT_EQ(21u, d->map_epoch);
+  ASSERT_EQ(19u, d->min_epoch);
+  ASSERT_TRUE(d->deep);
+  ASSERT_EQ(5, d->priority);
+  ASSERT_TRUE(d->high_priority);
+  // a primary without incremental deep scrubs wants every object read
+  ASSERT_EQ(eversion_t(), d->deep_since);
+}
+
 // Local Variables:
 // compile-command: "cd ../.. ; make unittest_osdscrub ; ./unittest_osdscrub --log-to-stderr=true  --debug-osd=20 # --gtest_filter=*.* "
 // End:
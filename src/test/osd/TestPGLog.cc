@@ -2269,6 +2269,37 @@ TEST_F(PGLogTest, ErrorNotIndexedByObject) {
   EXPECT_EQ(del.reqid, entry->reqid);
 }
 
+TEST_F(PGLogTest, roll_forward_releases_rollback_info) {
+  clear();
+
+  for (unsigned i = 1; i <= 4; ++i) {
+    pg_log_entry_t e(pg_log_entry_t::MODIFY,
+		     hobject_t(object_t("obj"), "", CEPH_NOSNAP, i, 0, ""),
+		     eversion_t(1, i), eversion_t(), i,
+		     osd_reqid_t(entity_name_t::CLIENT(777), 8, i),
+		     utime_t(1, i), 0);
+    e.mod_desc.append(4096 * i);
+    add(e);
+  }
+  uint64_t before = log.get_approx_mem_usage();
+  EXPECT_GE(before, 4 * sizeof(pg_log_entry_t));
+
+  list<hobject_t> remove_snap;
+  TestHandler h(remove_snap);
+  roll_forward_to(eversion_t(1, 2), &h);
+
+  for (auto& e : log.log) {
+    if (e.version <= eversion_t(1, 2)) {
+      EXPECT_FALSE(e.can_rollback());
+      EXPECT_EQ(0u, e.mod_desc.bl.length());
+    } else {
+      EXPECT_TRUE(e.can_rollback());
+      EXPECT_LT(0u, e.mod_desc.bl.length());
+    }
+  }
+  EXPECT_LT(log.get_approx_mem_usage(), before);
+}
+
 TEST_F(PGLogTest, split_into_preserves_may_include_deletes) {
   clear();
 
@@ -0,0 +1,94 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+/*
+ * Measure what it costs mClockScheduler to enqueue and dequeue client ops
+ * as the number of distinct clients grows.
+ */
+
+#include <iostream>
+
+#include "common/Clock.h"
+#include "common/ceph_argparse.h"
+#include "common/common_init.h"
+#include "global/global_init.h"
+#include "global/global_context.h"
+#include "osd/scheduler/mClockScheduler.h"
+#include "osd/scheduler/OpSchedulerItem.h"
+
+using namespace std;
+using namespace ceph::osd::scheduler;
+
+struct ClientItem : public PGOpQueueable {
+  ClientItem() : PGOpQueueable(spg_t()) {}
+
+  op_type_t get_op_type() const final {
+    return op_type_t::client_op;
+  }
+  ostream &print(ostream &rhs) const final {
+    return rhs;
+  }
+  std::optional<OpRequestRef> maybe_get_op() const final {
+    return std::nullopt;
+  }
+  op_scheduler_class get_scheduler_class() const final {
+    return op_scheduler_class::client;
+  }
+  void run(OSD *osd, OSDShard *sdata, PGRef& pg,
+	   ThreadPool::TPHandle &handle) final {}
+};
+
+static double run(unsigned clients, unsigned ops_per_client)
+{
+  mClockScheduler q(g_ceph_context, 1, false);
+  utime_t start = ceph_clock_now();
+  for (unsigned i = 0; i < ops_per_client; ++i) {
+    for (uint64_t c = 1; c <= clients; ++c) {
+      q.enqueue(OpSchedulerItem(std::make_unique<ClientItem>(),
+				12, 12, utime_t(), c, i));
+    }
+  }
+  unsigned dequeued = 0;
+  while (!q.empty()) {
+    auto item = q.dequeue();
+    if (std::holds_alternative<OpSchedulerItem>(item)) {
+      ++dequeued;
+    }
+  }
+  double secs = (double)(ceph_clock_now() - start);
+  return secs * 1e9 / dequeued;
+}
+
+static void usage(const char *name)
+{
+  cout << name << " <clients> [ops_per_client]\n"
+       << "\t clients: the number of distinct clients sending ops.\n"
+       << "\t ops_per_client: the number of ops each client sends "
+       << "(default 10).\n";
+}
+
+int main(int argc, const char **argv)
+{
+  if (argc < 2) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  int clients = atoi(argv[1]);
+  int ops = argc > 2 ? atoi(argv[2]) : 10;
+  if (clients < 1 || ops < 1) {
+    cerr << "clients and ops_per_client must be at least 1" << std::endl;
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto args = argv_to_vec(argc, argv);
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_OSD,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+  common_init_finish(g_ceph_context);
+
+  cout << clients << " clients, " << ops << " ops per client: "
+       << run(clients, ops) << " ns per op enqueued and dequeued"
+       << std::endl;
+  return 0;
+}
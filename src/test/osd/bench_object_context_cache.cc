@@ -0,0 +1,109 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:t -*-
+// vim: ts=8 sw=2 smarttab
+
+/*
+ * Measure the object context cache access pattern of
+ * PrimaryLogPG::find_object_context() -- lookup(), and lookup_or_create()
+ * on a miss -- with SharedLRU and with SharedIntrusiveLRU.
+ */
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "common/Clock.h"
+#include "common/ceph_argparse.h"
+#include "common/shared_cache.hpp"
+#include "global/global_init.h"
+#include "global/global_context.h"
+#include "osd/osd_internal_types.h"
+
+using namespace std;
+
+static vector<hobject_t> make_oids(unsigned num)
+{
+  vector<hobject_t> oids;
+  oids.reserve(num);
+  for (unsigned i = 0; i < num; ++i) {
+    oids.emplace_back(object_t("obj_" + to_string(i)), "", CEPH_NOSNAP,
+		      i * 2654435761u, 1, "");
+  }
+  return oids;
+}
+
+template <class Cache>
+static double run(Cache& cache, const vector<hobject_t>& oids,
+		  unsigned threads, unsigned ops)
+{
+  utime_t start = ceph_clock_now();
+  vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&cache, &oids, ops, t] {
+      size_t i = t * 7919;
+      for (unsigned n = 0; n < ops; ++n, i += 31) {
+	const hobject_t& soid = oids[i % oids.size()];
+	ObjectContextRef obc = cache.lookup(soid);
+	if (!obc) {
+	  obc = cache.lookup_or_create(soid);
+	}
+      }
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  double secs = (double)(ceph_clock_now() - start);
+  return (double)threads * ops / secs;
+}
+
+static void usage(const char *name)
+{
+  cout << name << " <threads> <ops> [objects] [cache_size] [shards]\n"
+       << "\t threads: the number of threads looking up object contexts.\n"
+       << "\t ops: the number of lookups per thread.\n"
+       << "\t objects: the number of distinct objects (default 1024).\n"
+       << "\t cache_size: the cache capacity (default "
+       << "osd_pg_object_context_cache_count).\n"
+       << "\t shards: the SharedIntrusiveLRU shard count (default "
+       << "osd_pg_object_context_cache_shards).\n";
+}
+
+int main(int argc, const char **argv)
+{
+  if (argc < 3) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto args = argv_to_vec(argc, argv);
+  auto cct = global_init(NULL, args, CEPH_ENTITY_TYPE_CLIENT,
+			 CODE_ENVIRONMENT_UTILITY,
+			 CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+
+  unsigned threads = atoi(argv[1]);
+  unsigned ops = atoi(argv[2]);
+  unsigned objects = argc > 3 ? atoi(argv[3]) : 1024;
+  size_t cache_size = argc > 4 ? atoi(argv[4]) :
+    g_conf()->osd_pg_object_context_cache_count;
+  size_t shards = argc > 5 ? atoi(argv[5]) :
+    g_conf().get_val<uint64_t>("osd_pg_object_context_cache_shards");
+
+  cout << threads << " threads, " << ops << " ops per thread, "
+       << objects << " objects, cache size " << cache_size << std::endl;
+
+  auto oids = make_oids(objects);
+  {
+    SharedLRU<hobject_t, ObjectContext> cache(g_ceph_context, cache_size);
+    cout << "SharedLRU: " << run(cache, oids, threads, ops)
+	 << " lookups/s" << std::endl;
+    cache.clear();
+  }
+  {
+    SharedIntrusiveLRU<hobject_t, ObjectContext> cache(
+      g_ceph_context, cache_size, shards);
+    cout << "SharedIntrusiveLRU (" << shards << " shards): "
+	 << run(cache, oids, threads, ops) << " lookups/s" << std::endl;
+    cache.clear();
+  }
+  return 0;
+}
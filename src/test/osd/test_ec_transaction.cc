@@ -13,11 +13,16 @@
  */
 
 #include <gtest/gtest.h>
+#include "common/config_proxy.h"
+#include "erasure-code/ErasureCodePlugin.h"
 #include "osd/PGTransaction.h"
 #include "osd/ECTransaction.h"
 
 #include "test/unit.cc"
 
+using namespace std;
+using namespace ceph;
+
 struct mydpp : public DoutPrefixProvider {
   std::ostream& gen_prefix(std::ostream& out) const override { return out << "foo"; }
   CephContext *get_cct() const override { return g_ceph_context; }
@@ -122,3 +127,230 @@ TEST(ectransaction, many_writes)
   ASSERT_EQ(0u, plan.to_read.size());
   ASSERT_EQ(1u, plan.will_write.size());
 }
+
+TEST(ectransaction, parity_delta)
+{
+  hobject_t h;
+  ECUtil::stripe_info_t sinfo(4, 16384);
+  auto get_hinfo = [&](const hobject_t &i) {
+    ECUtil::HashInfoRef ref(new ECUtil::HashInfo(6));
+    ref->set_projected_total_logical_size(sinfo, 1048576);
+    return ref;
+  };
+  bufferlist a;
+  a.append_zero(512);
+
+  {
+    // a small overwrite within one data chunk
+    PGTransactionUPtr t(new PGTransaction);
+    t->write(h, 16384 + 4096 + 100, a.length(), a, 0);
+    auto plan = ECTransaction::get_write_plan(
+      sinfo, std::move(t), get_hinfo, &dpp, true);
+    ASSERT_EQ(1u, plan.delta_writes.size());
+    auto &delta = plan.delta_writes[h];
+    ASSERT_EQ(std::set<int>{1}, delta.data_chunks);
+    ASSERT_EQ(16384u, delta.stripes.range_start());
+    ASSERT_EQ(32768u, delta.stripes.range_end());
+    ASSERT_EQ(512u, delta.written.size());
+    // the full stripe read-modify-write is still planned
+    ASSERT_EQ(1u, plan.to_read.size());
+  }
+
+  {
+    // an overwrite spanning every data chunk of a stripe
+    PGTransactionUPtr t(new PGTransaction);
+    bufferlist b;
+    b.append_zero(12288 + 512);
+    t->write(h, 16384 + 100, b.length(), b, 0);
+    auto plan = ECTransaction::get_write_plan(
+      sinfo, std::move(t), get_hinfo, &dpp, true);
+    ASSERT_EQ(0u, plan.delta_writes.size());
+  }
+
+  {
+    // an append
+    PGTransactionUPtr t(new PGTransaction);
+    t->write(h, 1048576 - 100, a.length(), a, 0);
+    auto plan = ECTransaction::get_write_plan(
+      sinfo, std::move(t), get_hinfo, &dpp, true);
+    ASSERT_EQ(0u, plan.delta_writes.size());
+  }
+
+  {
+    // not asked for
+    PGTransactionUPtr t(new PGTransaction);
+    t->write(h, 16384 + 4096 + 100, a.length(), a, 0);
+    auto plan = ECTransaction::get_write_plan(
+      sinfo, std::move(t), get_hinfo, &dpp);
+    ASSERT_EQ(0u, plan.delta_writes.size());
+  }
+}
+
+// the shards once the writes of transactions are applied to them
+static void apply_writes(
+  map<shard_id_t, ObjectStore::Transaction> &transactions,
+  map<int, bufferlist> *shards)
+{
+  for (auto &&st : transactions) {
+    bufferlist &shard = (*shards)[st.first];
+    auto i = st.second.begin();
+    while (i.have_op()) {
+      auto *op = i.decode_op();
+      switch (op->op) {
+      case ObjectStore::Transaction::OP_WRITE: {
+	uint64_t off = op->off;
+	uint64_t len = op->len;
+	bufferlist bl;
+	i.decode_bl(bl);
+	ASSERT_EQ(len, bl.length());
+	ASSERT_LE(off + len, shard.length());
+	bufferlist updated;
+	updated.substr_of(shard, 0, off);
+	updated.append(bl);
+	bufferlist tail;
+	tail.substr_of(shard, off + len, shard.length() - off - len);
+	updated.append(tail);
+	shard.swap(updated);
+	break;
+      }
+      case ObjectStore::Transaction::OP_SETATTR: {
+	i.decode_string();
+	bufferlist bl;
+	i.decode_bl(bl);
+	break;
+      }
+      case ObjectStore::Transaction::OP_SETATTRS: {
+	map<string, bufferptr> aset;
+	i.decode_attrset(aset);
+	break;
+      }
+      default:
+	break;
+      }
+    }
+  }
+}
+
+TEST(ectransaction, parity_delta_matches_reencode)
+{
+  ErasureCodeProfile profile;
+  profile["technique"] = "reed_sol_van";
+  profile["k"] = "4";
+  profile["m"] = "2";
+  ErasureCodeInterfaceRef ec_impl;
+  ASSERT_EQ(0, ErasureCodePluginRegistry::instance().factory(
+    "jerasure",
+    g_conf().get_val<std::string>("erasure_code_dir"),
+    profile,
+    &ec_impl,
+    &cerr));
+  ASSERT_TRUE(ec_impl->get_supported_optimizations() &
+	      ErasureCodeInterface::FLAG_EC_PLUGIN_PARITY_DELTA_OPTIMIZATION);
+
+  const uint64_t chunk_size = 4096;
+  const uint64_t stripe_width = 4 * chunk_size;
+  ASSERT_EQ(chunk_size, ec_impl->get_chunk_size(stripe_width));
+  ECUtil::stripe_info_t sinfo(4, stripe_width);
+  const uint64_t size = 4 * stripe_width;
+  const hobject_t h = hobject_t(
+    object_t("obj"), "", CEPH_NOSNAP, 0, 1, "").make_temp_hobject("obj");
+  auto get_hinfo = [&](const hobject_t &i) {
+    ECUtil::HashInfoRef ref(new ECUtil::HashInfo(6));
+    ref->set_total_chunk_size_clear_hash(
+      sinfo.aligned_logical_offset_to_chunk_offset(size));
+    ref->set_projected_total_logical_size(sinfo, size);
+    return ref;
+  };
+
+  std::string old_str(size, 0);
+  for (uint64_t i = 0; i < size; ++i) {
+    old_str[i] = static_cast<char>(i * 7 + i / chunk_size);
+  }
+  bufferlist old_data;
+  old_data.append(old_str);
+  set<int> all = {0, 1, 2, 3, 4, 5};
+  map<int, bufferlist> old_shards;
+  ASSERT_EQ(0, ECUtil::encode(sinfo, ec_impl, old_data, all, &old_shards));
+
+  // two small overwrites: within chunk 1 of the second stripe, and across
+  // chunks 1 and 2 of the fourth
+  bufferlist a, b;
+  a.append(std::string(512, 'a'));
+  b.append(std::string(1000, 'b'));
+  const uint64_t a_off = stripe_width + chunk_size + 100;
+  const uint64_t b_off = 3 * stripe_width + 2 * chunk_size - 300;
+  auto make_transaction = [&]() {
+    PGTransactionUPtr t(new PGTransaction);
+    t->write(h, a_off, a.length(), a, 0);
+    t->write(h, b_off, b.length(), b, 0);
+    return t;
+  };
+
+  std::string new_str = old_str;
+  new_str.replace(a_off, a.length(), a.to_str());
+  new_str.replace(b_off, b.length(), b.to_str());
+  bufferlist new_data;
+  new_data.append(new_str);
+  map<int, bufferlist> expected;
+  ASSERT_EQ(0, ECUtil::encode(sinfo, ec_impl, new_data, all, &expected));
+
+  auto generate = [&](ECTransaction::WritePlan &plan,
+		      const map<hobject_t, extent_map> &partial_extents,
+		      const map<hobject_t, map<int, extent_map>> &delta_chunks) {
+    map<shard_id_t, ObjectStore::Transaction> trans;
+    for (int i : all) {
+      trans[shard_id_t(i)];
+    }
+    vector<pg_log_entry_t> entries;
+    map<hobject_t, extent_map> written;
+    set<hobject_t> temp_added, temp_removed;
+    ECTransaction::generate_transactions(
+      plan, ec_impl, pg_t(0, 1), sinfo, partial_extents, delta_chunks,
+      entries, &written, &trans, &temp_added, &temp_removed, &dpp,
+      ceph_release_t::quincy);
+    EXPECT_EQ(plan.will_write[h], written[h].get_interval_set());
+    map<int, bufferlist> shards = old_shards;
+    apply_writes(trans, &shards);
+    return shards;
+  };
+
+  // the full stripe read-modify-write
+  auto full_plan = ECTransaction::get_write_plan(
+    sinfo, make_transaction(), get_hinfo, &dpp);
+  ASSERT_EQ(0u, full_plan.delta_writes.size());
+  map<hobject_t, extent_map> partial_extents;
+  for (auto &&extent : full_plan.to_read[h]) {
+    bufferlist bl;
+    bl.substr_of(old_data, extent.first, extent.second);
+    partial_extents[h].insert(extent.first, extent.second, bl);
+  }
+  auto full = generate(full_plan, partial_extents, {});
+
+  // the same overwrite with parity deltas, planned and read the way
+  // ECBackend::try_state_to_reads() and start_delta_reads() do it
+  auto delta_plan = ECTransaction::get_write_plan(
+    sinfo, make_transaction(), get_hinfo, &dpp, true);
+  ASSERT_EQ(1u, delta_plan.delta_writes.size());
+  auto &delta = delta_plan.delta_writes[h];
+  ASSERT_EQ((std::set<int>{1, 2}), delta.data_chunks);
+  delta_plan.to_read.erase(h);
+  delta_plan.will_write[h] = delta.written;
+  set<int> want = delta.data_chunks;
+  want.insert(4);
+  want.insert(5);
+  map<hobject_t, map<int, extent_map>> delta_chunks;
+  for (auto &&extent : delta.stripes) {
+    auto chunk = sinfo.aligned_offset_len_to_chunk(extent);
+    for (int i : want) {
+      bufferlist bl;
+      bl.substr_of(old_shards[i], chunk.first, chunk.second);
+      delta_chunks[h][i].insert(chunk.first, chunk.second, bl);
+    }
+  }
+  auto delta_shards = generate(delta_plan, {}, delta_chunks);
+
+  for (int i : all) {
+    ASSERT_TRUE(expected[i].contents_equal(full[i])) << "shard " << i;
+    ASSERT_TRUE(expected[i].contents_equal(delta_shards[i])) << "shard " << i;
+  }
+}
@@ -1609,6 +1609,90 @@ TEST(pool_opts_t, deep_scrub_interval) {
   EXPECT_FALSE(opts.is_set(pool_opts_t::DEEP_SCRUB_INTERVAL));
 }
 
+static pg_history_t make_pg_history()
+{
+  pg_history_t h;
+  h.epoch_created = 1;
+  h.epoch_pool_created = 1;
+  h.last_epoch_started = 30;
+  h.last_interval_started = 29;
+  h.last_epoch_clean = 30;
+  h.last_interval_clean = 29;
+  h.last_epoch_split = 2;
+  h.same_interval_since = 29;
+  h.same_up_since = 28;
+  h.same_primary_since = 27;
+  h.last_scrub = eversion_t(25, 100);
+  h.last_scrub_stamp = utime_t(1000, 1);
+  h.last_deep_scrub = eversion_t(24, 90);
+  h.last_deep_scrub_stamp = utime_t(900, 2);
+  h.last_clean_scrub_stamp = utime_t(1000, 3);
+  h.last_epoch_marked_full = 3;
+  h.prior_readable_until_ub = ceph::make_timespan(4);
+  return h;
+}
+
+// pg_history_t::encode() as of struct_v 10, before the deep scrub
+// bookkeeping was added
+static void encode_pg_history_v10(const pg_history_t& h, bufferlist& bl)
+{
+  using ceph::encode;
+  ENCODE_START(10, 4, bl);
+  encode(h.epoch_created, bl);
+  encode(h.last_epoch_started, bl);
+  encode(h.last_epoch_clean, bl);
+  encode(h.last_epoch_split, bl);
+  encode(h.same_interval_since, bl);
+  encode(h.same_up_since, bl);
+  encode(h.same_primary_since, bl);
+  encode(h.last_scrub, bl);
+  encode(h.last_scrub_stamp, bl);
+  encode(h.last_deep_scrub, bl);
+  encode(h.last_deep_scrub_stamp, bl);
+  encode(h.last_clean_scrub_stamp, bl);
+  encode(h.last_epoch_marked_full, bl);
+  encode(h.last_interval_started, bl);
+  encode(h.last_interval_clean, bl);
+  encode(h.epoch_pool_created, bl);
+  encode(h.prior_readable_until_ub, bl);
+  ENCODE_FINISH(bl);
+}
+
+TEST(pg_history_t, encode_decode) {
+  pg_history_t h = make_pg_history();
+  h.last_deep_scrub_begin = eversion_t(24, 80);
+  h.last_deep_scrub_begin_epoch = 26;
+  h.last_full_deep_scrub_stamp = utime_t(800, 4);
+
+  bufferlist bl;
+  ceph::encode(h, bl);
+  pg_history_t d;
+  auto p = bl.cbegin();
+  ceph::decode(d, p);
+  ASSERT_TRUE(p.end());
+  ASSERT_EQ(h, d);
+}
+
+TEST(pg_history_t, decode_v10) {
+  pg_history_t h = make_pg_history();
+  bufferlist bl;
+  encode_pg_history_v10(h, bl);
+
+  pg_history_t d;
+  d.last_deep_scrub_begin = eversion_t(1, 1);
+  d.last_deep_scrub_begin_epoch = 1;
+  auto p = bl.cbegin();
+  ceph::decode(d, p);
+  ASSERT_TRUE(p.end());
+  // nothing is known about the last deep scrub's start, so the next deep
+  // scrub will be a full one; every earlier deep scrub was a full one
+  ASSERT_EQ(eversion_t(), d.last_deep_scrub_begin);
+  ASSERT_EQ(0u, d.last_deep_scrub_begin_epoch);
+  ASSERT_EQ(h.last_deep_scrub_stamp, d.last_full_deep_scrub_stamp);
+  h.last_full_deep_scrub_stamp = h.last_deep_scrub_stamp;
+  ASSERT_EQ(h, d);
+}
+
 struct RequiredPredicate : IsPGRecoverablePredicate {
   unsigned required_size;
   explicit RequiredPredicate(unsigned required_size) : required_size(required_size) {}
@@ -12,6 +12,7 @@
  * 
  */
 
+#include <fstream>
 #include <string>
 #include <sys/stat.h>
 
@@ -25,6 +26,7 @@
 
 #include "global/global_init.h"
 #include "osd/OSDMap.h"
+#include "osd/OSDMapMapping.h"
 
 using namespace std;
 
@@ -53,6 +55,8 @@ void usage()
   cout << "   --test-map-pg <pgid>    map a pgid to osds" << std::endl;
   cout << "   --test-map-object <objectname> [--pool <poolid>] map an object to osds"
        << std::endl;
+  cout << "   --test-map-objects <file> [--pool <poolid>] map the objects named in <file>," << std::endl;
+  cout << "                           one per line, to osds [- for stdin]" << std::endl;
   cout << "   --upmap-cleanup <file>  clean up pg_upmap[_items] entries, writing" << std::endl;
   cout << "                           commands to <file> [default: - for stdout]" << std::endl;
   cout << "   --upmap <file>          calculate pg upmap entries to balance pg layout" << std::endl;
@@ -134,6 +138,7 @@ int main(int argc, const char **argv)
   bool clobber = false;
   bool modified = false;
   std::string export_crush, import_crush, test_map_pg, test_map_object, adjust_crush_weight;
+  std::string test_map_objects;
   bool test_crush = false;
   int range_first = -1;
   int range_last = -1;
@@ -241,6 +246,8 @@ int main(int argc, const char **argv)
       test_map_pg = val;
     } else if (ceph_argparse_witharg(args, i, &val, "--test_map_object", (char*)NULL)) {
       test_map_object = val;
+    } else if (ceph_argparse_witharg(args, i, &val, "--test_map_objects", (char*)NULL)) {
+      test_map_objects = val;
     } else if (ceph_argparse_flag(args, i, "--test_crush", (char*)NULL)) {
       test_crush = true;
     } else if (ceph_argparse_witharg(args, i, &val, err, "--pg_num", (char*)NULL)) {
@@ -609,6 +616,42 @@ skip_upmap:
 	 << " -> " << acting
 	 << std::endl;
   }  
+  if (!test_map_objects.empty()) {
+    if (pool == -1) {
+      cout << me << ": assuming pool 1 (use --pool to override)" << std::endl;
+      pool = 1;
+    }
+    if (!osdmap.have_pg_pool(pool)) {
+      cerr << "There is no pool " << pool << std::endl;
+      exit(1);
+    }
+    ifstream fin;
+    if (test_map_objects != "-") {
+      fin.open(test_map_objects);
+      if (!fin) {
+	cerr << me << ": error opening " << test_map_objects << std::endl;
+	exit(1);
+      }
+    }
+    istream& in = test_map_objects == "-" ? cin : fin;
+    vector<string> names;
+    for (string name; getline(in, name); ) {
+      names.push_back(std::move(name));
+    }
+    vector<pg_t> raw_pgids;
+    osdmap.map_to_pgs(pool, names, "", &raw_pgids);
+    OSDMapMapping mapping;
+    mapping.update(osdmap);
+    vector<int> acting;
+    for (size_t i = 0; i < names.size(); ++i) {
+      pg_t pgid = osdmap.raw_pg_to_pg(raw_pgids[i]);
+      mapping.get(pgid, nullptr, nullptr, &acting, nullptr);
+      cout << " object '" << names[i]
+	   << "' -> " << pgid
+	   << " -> " << acting
+	   << std::endl;
+    }
+  }
   if (!test_map_pg.empty()) {
     pg_t pgid;
     if (!pgid.parse(test_map_pg.c_str())) {
@@ -787,6 +830,7 @@ skip_upmap:
   if (!print && !health && !tree && !modified &&
       export_crush.empty() && import_crush.empty() && 
       test_map_pg.empty() && test_map_object.empty() &&
+      test_map_objects.empty() &&
       !test_map_pgs && !test_map_pgs_dump && !test_map_pgs_dump_all &&
       adjust_crush_weight.empty() && !upmap && !upmap_cleanup) {
     cerr << me << ": no action specified?" << std::endl;